@@ -0,0 +1,66 @@
+#include "ActorScene.hpp"
+#include "ThreadPool.hpp"
+
+ActorScene::ActorScene()
+    :
+    m_Slots()
+{}
+
+void ActorScene::AddActor(PMDActorPtr actor)
+{
+    Slot slot;
+    slot.Actor = std::move(actor);
+    slot.PoseChanged = false;
+    m_Slots.push_back(std::move(slot));
+}
+
+void ActorScene::Clear()
+{
+    m_Slots.clear();
+}
+
+uint32_t ActorScene::ActorNum() const
+{
+    return static_cast<uint32_t>(m_Slots.size());
+}
+
+const PMDActorPtr& ActorScene::GetActor(uint32_t idx) const
+{
+    return m_Slots[idx].Actor;
+}
+
+bool ActorScene::Update(ThreadPool* pool)
+{
+    auto update = [this](uint32_t idx) {
+        Slot& slot = m_Slots[idx];
+        slot.PoseChanged = slot.Actor->MotionUpdate();
+    };
+
+    const uint32_t actor_num = ActorNum();
+    if (pool != nullptr && actor_num >= 2) {
+        pool->ParallelFor(actor_num, update);
+    }
+    else {
+        for (uint32_t i = 0; i < actor_num; ++i) {
+            update(i);
+        }
+    }
+
+    bool changed = false;
+    for (const auto& slot : m_Slots) {
+        changed |= slot.PoseChanged;
+    }
+    return changed;
+}
+
+void ActorScene::Upload()
+{
+    for (auto& slot : m_Slots) {
+        slot.Actor->UploadVertices();
+    }
+}
+
+bool ActorScene::PoseChanged(uint32_t idx) const
+{
+    return m_Slots[idx].PoseChanged;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PMDActor.hpp"
+#include "AlignedAllocator.hpp"
+
+class ThreadPool;
+
+// ̃AN^[̃[V܂Ƃ߂čXVNX
+//
+// AN^[̃[ṼTvOEFKEIKE\AXbhv[̃^XNƂēɎsA
+// SÎ1񂾂҂Ă߂BGPU ւ̏݁i_ UploadA{[s͌Ăяoj Update ̌ɍsB
+// AN^[͂ꂼLbVCEɑ{[sɏނ̂ŁAɍXVĂ݂ɊȂB
+class ActorScene
+{
+public:
+
+    ActorScene();
+
+    void AddActor(PMDActorPtr actor);
+    void Clear();
+
+    uint32_t ActorNum() const;
+    const PMDActorPtr& GetActor(uint32_t idx) const;
+
+    // @brief SAN^[̃[V݂̎ōXV
+    // @param pool AN^[̍XVɎgXbhv[inullptr ȂĂяoXbhŏɍXVj
+    // @retval pςAN^[邩
+    bool Update(ThreadPool* pool);
+
+    // @brief Update ŏ_eAN^[̒_obt@ɓ]
+    //        iGPU ̃\[XĜŁAUpdate ̌ɕ`XbhŌĂԁj
+    void Upload();
+
+    // @brief O Update Ŏpςifalse Ȃ{[s͑Ô܂܁j
+    bool PoseChanged(uint32_t idx) const;
+
+private:
+
+    // ʁX̃Xbhނ̂ŁAAN^[ɃLbVC𕪂
+    struct alignas(k_CacheLineSize) Slot
+    {
+        PMDActorPtr Actor;
+        bool        PoseChanged;
+    };
+
+    std::vector<Slot> m_Slots;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+static constexpr size_t k_CacheLineSize = 64;
+
+// 擪w肵oCgEɑĊmۂAP[^[
+//
+// Xbhɏރobt@LbVCEɑA
+// ʂ̃Xbhރf[^ƓLbVCɏȂ悤ɂitHXVFAO΍jB
+template <typename T, size_t Alignment = k_CacheLineSize>
+class AlignedAllocator
+{
+public:
+
+    static_assert(Alignment >= alignof(T), "Alignment must not be smaller than the type's alignment");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept {}
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t num)
+    {
+        return static_cast<T*>(::operator new(num * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* ptr, size_t)
+    {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+// 擪LbVCEɑ vector
+template <typename T>
+using CacheAlignedVector = std::vector<T, AlignedAllocator<T, k_CacheLineSize>>;
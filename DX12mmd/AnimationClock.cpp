@@ -0,0 +1,62 @@
+#include "AnimationClock.hpp"
+
+#include <Windows.h>
+
+//
+// Implements class HighResolutionClock
+//
+
+HighResolutionClock::HighResolutionClock()
+    :
+    m_Frequency(1),
+    m_StartCount(0)
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER count;
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&count);
+    m_Frequency = frequency.QuadPart;
+    m_StartCount = count.QuadPart;
+}
+
+double HighResolutionClock::Now() const
+{
+    LARGE_INTEGER count;
+    ::QueryPerformanceCounter(&count);
+
+    // N_̍ŌvZAoߎԂȂĂ double ̐x𗎂ƂȂ
+    const int64_t elapsed = count.QuadPart - m_StartCount;
+    const int64_t seconds = elapsed / m_Frequency;
+    const int64_t remainder = elapsed % m_Frequency;
+    return static_cast<double>(seconds) + static_cast<double>(remainder) / static_cast<double>(m_Frequency);
+}
+
+//
+// Implements class ManualClock
+//
+
+ManualClock::ManualClock(double step)
+    :
+    m_Step(step),
+    m_Now(0.0)
+{}
+
+double ManualClock::Now() const
+{
+    return m_Now;
+}
+
+void ManualClock::Advance()
+{
+    m_Now += m_Step;
+}
+
+void ManualClock::Advance(double seconds)
+{
+    m_Now += seconds;
+}
+
+void ManualClock::Set(double seconds)
+{
+    m_Now = seconds;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+// Aj[V̎̎擾
+//
+// ͕bPʂŁAP邱ƁiN_͎ɔCӁjB
+// AN^[͍ĐJn̎Ƃ̍t[ʒu߂̂ŁAN_̈Ⴂ͉eȂB
+class IAnimationClock
+{
+public:
+    virtual ~IAnimationClock() {}
+
+    // @brief ݂̎ibj
+    virtual double Now() const = 0;
+};
+using AnimationClockPtr = std::shared_ptr<IAnimationClock>;
+
+// \^C}[iQueryPerformanceCounterjɂ鎞
+class HighResolutionClock : public IAnimationClock
+{
+public:
+
+    HighResolutionClock();
+
+    virtual double Now() const;
+
+private:
+
+    int64_t m_Frequency;        // 1b̃JEg
+    int64_t m_StartCount;       // 쐬̃JEgi̋N_j
+};
+
+// Ăяoi߂鎞ieXgEItCopj
+//
+// Advance Ă񂾂Ƃiނ̂ŁA͖͂񓯂t[ʒuB
+class ManualClock : public IAnimationClock
+{
+public:
+
+    // @param step Advance() Ői߂biႦ 1.0 / 60.0j
+    explicit ManualClock(double step = 1.0 / 60.0);
+
+    virtual double Now() const;
+
+    void Advance();                 // 1Xebvi߂
+    void Advance(double seconds);   // wbi߂
+    void Set(double seconds);
+
+private:
+
+    double m_Step;
+    double m_Now;
+};
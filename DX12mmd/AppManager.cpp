@@ -4,12 +4,16 @@
 
 #include <d3dx12.h>
 #include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <vector>
 #include <wrl/client.h>
 
 #include "AppManager.hpp"
 #include "Shader.hpp"
 #include "Resource.hpp"
+#include "ModelLoader.hpp"
+#include "SceneBenchmark.hpp"
 
 
 using Microsoft::WRL::ComPtr;
@@ -37,24 +41,32 @@ GraphicEngine::GraphicEngine()
     m_RtvHeaps(nullptr),
     m_DepthBuffer(nullptr),
     m_DSV_Heap(nullptr),
-    m_VertexShader(),
+    m_VertexShaders(),
     m_PixelShader(),
-    m_PipelineState(nullptr),
+    m_PipelineStates(),
     m_RootSignature(nullptr),
     m_Fence(),
     m_ViewPort(),
     m_ScissorRect(),
     m_ConstBuff(),
+    m_ThreadPool(),
+    m_Scene(),
     m_Model(),
+    m_BenchmarkActorNum(0),
+    m_Clock(std::make_shared<HighResolutionClock>()),
+    m_SceneStartTime(0.0),
+    m_SceneMotion(),
+    m_SceneTrack(),
     m_Resource(),
     m_Textures()
 {}
 
-bool GraphicEngine::Initialize( HWND hwnd )
+bool GraphicEngine::Initialize( HWND hwnd, uint32_t benchmark_actor_num )
 {
     if (s_Instance == nullptr) {
         s_Instance = new GraphicEngine();
     }
+    s_Instance->m_BenchmarkActorNum = benchmark_actor_num;
 
     if (!s_Instance->InitializeDX12( hwnd )) {
         return false;
@@ -126,42 +138,49 @@ void GraphicEngine::SetViewPort()
 
 void GraphicEngine::FlipWindow()
 {
-#if 1
-    // ϊsݒ
-    auto world_mat = XMMatrixRotationY(0);
-
-    XMFLOAT3 eye(0, 10, -15);
-    XMFLOAT3 target(0, 10, 0);
-    XMFLOAT3 up(0, 1, 0);
-
-    auto view_mat = XMMatrixLookAtLH(
-        XMLoadFloat3(&eye), XMLoadFloat3(&target), XMLoadFloat3(&up)
-    );
-    auto proj_mat = XMMatrixPerspectiveFovLH(
-        XM_PIDIV2,
-        static_cast<float>(k_WindowWidth) / static_cast<float>(k_WindowHeight),
-        1.0f,
-        100.0f
-    );
-
-    m_Matrix.World = world_mat;
-    m_Matrix.View = view_mat;
-    m_Matrix.Proj = proj_mat;
-    m_Matrix.Eye = eye;
-
-    m_ConstBuff.Write(&m_Matrix, sizeof(m_Matrix));
-
-#endif
-
-    // f`ʏ
-    m_Model.MotionUpdate();
-    // Aj[Vϊ̃{[ϊsVF[_[ɓn
-    auto& bone_metrices = m_Model.GetBoneMetricesForMotion();
-    std::copy_n(
-        bone_metrices.begin(),
-        std::min<size_t>(bone_metrices.size(), k_BoneMetricesNum),
-        &m_Matrix.Bones[0]
-    );
+    // JEƖ̃gbN]Aς萔ށiJ~܂ĂΉȂj
+    const uint32_t scene_dirty = m_SceneTrack.Evaluate(SceneFrame());
+    const bool camera_changed = (scene_dirty & SceneTrackEvaluator::k_DirtyCamera) != 0;
+    if (camera_changed) {
+        const auto& camera = m_SceneTrack.Camera();
+        m_Matrix.View = camera.ViewMatrix();
+        m_Matrix.Proj = camera.ProjectionMatrix(
+            static_cast<float>(k_WindowWidth) / static_cast<float>(k_WindowHeight),
+            k_NearZ,
+            k_FarZ
+        );
+        m_Matrix.Eye = camera.Eye();
+        // View  Proj ͕ł̂1ŏ
+        WriteMatrix(&m_Matrix.View, sizeof(m_Matrix.View) + sizeof(m_Matrix.Proj));
+        WriteMatrix(&m_Matrix.Eye, sizeof(m_Matrix.Eye));
+    }
+    if (scene_dirty & SceneTrackEvaluator::k_DirtyLight) {
+        const auto& light = m_SceneTrack.Light();
+        m_Matrix.LightColor = XMFLOAT4(light.Color.x, light.Color.y, light.Color.z, 1.0f);
+        m_Matrix.LightDir = XMFLOAT4(light.Direction.x, light.Direction.y, light.Direction.z, 0.0f);
+        WriteMatrix(&m_Matrix.LightColor, sizeof(m_Matrix.LightColor) + sizeof(m_Matrix.LightDir));
+    }
+
+    // SAN^[̃[VXbhv[ōXVASIĂ珑
+    // i[V̎iłȂΎp͑Ô܂܁j
+    m_Scene.Update(&m_ThreadPool);
+    m_Scene.Upload();
+    const bool pose_changed = m_Scene.PoseChanged(0);
+    // ݂̎pŉʊÕNX^Aʏ̑傫LODIԁipJςĂȂΑÔ܂܁j
+    if (pose_changed || camera_changed) {
+        m_Model->UpdateDrawRanges(
+            m_Matrix.World * m_Matrix.View * m_Matrix.Proj,
+            XMVectorGetY(m_Matrix.Proj.r[1]),
+            static_cast<float>(k_WindowHeight)
+        );
+    }
+    // Aj[Vϊ̃{[ϊsVF[_[ɓnĩt[̕`ɊԂɍ悤Ap̍XVɏށj
+    if (pose_changed) {
+        auto& bone_metrices = m_Model->GetBoneMetricesForMotion();
+        const size_t bone_num = std::min<size_t>(bone_metrices.size(), k_BoneMetricesNum);
+        std::copy_n(bone_metrices.begin(), bone_num, &m_Matrix.Bones[0]);
+        WriteMatrix(&m_Matrix.Bones[0], static_cast<uint32_t>(sizeof(m_Matrix.Bones[0]) * bone_num));
+    }
 
     // obNobt@[̃_[^[Qbgr[Aꂩ痘p郌_[^[Qbgr[ɐݒ
     auto bbidx = m_Swapchain->GetCurrentBackBufferIndex();
@@ -171,8 +190,8 @@ void GraphicEngine::FlipWindow()
     // \[XoA _[^[Qbgɐݒ
     SetRenderTargetResourceBarrier(bbidx, true);
 
-    // pCvCXe[gZbg
-    m_CmdList->SetPipelineState(m_PipelineState);
+    // pCvCXe[gZbgiAN^[̒_tH[}bgɍ킹́j
+    m_CmdList->SetPipelineState(m_PipelineStates[static_cast<uint32_t>(m_Model->GetVertexBuffer()->GetFormat())]);
 
     auto dsv_desc_cpu_handle = m_DSV_Heap->GetCPUDescriptorHandleForHeapStart();
     m_CmdList->OMSetRenderTargets(1, &rtvH, true, &dsv_desc_cpu_handle);
@@ -199,9 +218,9 @@ void GraphicEngine::FlipWindow()
     m_CmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
     // _obt@[r[ݒ
-    auto vbview = m_Model.GetVertexBuffer()->GetVertexBufferView();
+    auto vbview = m_Model->GetVertexBuffer()->GetVertexBufferView();
     m_CmdList->IASetVertexBuffers(0, 1, &vbview);
-    auto idxview = m_Model.GetIndexBuffer()->GetIndexBufferView();
+    auto idxview = m_Model->GetIndexBuffer()->GetIndexBufferView();
     m_CmdList->IASetIndexBuffer(&idxview);
     
     //`ʖ
@@ -209,18 +228,22 @@ void GraphicEngine::FlipWindow()
     descriptor_heap = m_Resource.DescriptorHeap(handle);
     m_CmdList->SetDescriptorHeaps(1, &descriptor_heap);
 
-    //auto materialH = m_Model.DescriptorHeapGPU();
-    const std::vector<Material>& materials = m_Model.GetPMDData().GetMaterialData();
-    unsigned int idx_offset = 0;
-    
-    for (const auto& m : materials) {
-        m_CmdList->SetGraphicsRootDescriptorTable(
-            m_Resource.RootParameterID("Miku"),
-            m_Resource.DescriptorHeapGPU(handle)
-        );
-        m_CmdList->DrawIndexedInstanced(m.IndicesNum, 1, idx_offset, 0, 0);
+    //auto materialH = m_Model->DescriptorHeapGPU();
+    // }eAɁAĂNX^͈̔͂`悷
+    const uint32_t material_num = m_Model->GetPMDData().MaterialNum();
+    for (uint32_t i = 0; i < material_num; ++i) {
+        uint32_t range_num = 0;
+        const MeshClusterSet::DrawRange* ranges = m_Model->GetDrawRanges(i, &range_num);
+        if (range_num > 0) {
+            m_CmdList->SetGraphicsRootDescriptorTable(
+                m_Resource.RootParameterID("Miku"),
+                m_Resource.DescriptorHeapGPU(handle)
+            );
+            for (uint32_t r = 0; r < range_num; ++r) {
+                m_CmdList->DrawIndexedInstanced(ranges[r].IndexNum, 1, ranges[r].IndexOffset, 0, 0);
+            }
+        }
         handle.Advance();
-        idx_offset += m.IndicesNum;
     }
 
     // \[XoAPRESENTɖ߂
@@ -296,9 +319,8 @@ bool GraphicEngine::InitializeDX12( HWND hwnd )
         return false;
     }
 
-    m_VertexShader = CompileShader(L"BasicVertexShader.hlsl", "BasicVS", CompileShader::Type::k_VertexShader);
     m_PixelShader = CompileShader(L"BasicPixelShader.hlsl", "BasicPS", CompileShader::Type::k_PixelShader);
-    if (!m_VertexShader.IsValid() || !m_PixelShader.IsValid()) {
+    if (!m_PixelShader.IsValid()) {
         return false;
     }
 
@@ -315,33 +337,96 @@ bool GraphicEngine::InitializeDX12( HWND hwnd )
     //}
 
 #if 0
-    if (!m_Model.Create(&m_Resource, "Miku", "Model/~N.pmd", "Model/motion.vmd")) {
-        return false;
-    }
+    std::vector<ModelLoadRequest> requests = {
+        { "Miku", "Model/~N.pmd", "Model/motion.vmd" },
+    };
 #else
-    if (!m_Model.Create(&m_Resource, "Miku", "Model/~N.pmd", "Model/squat.vmd")) {
+    std::vector<ModelLoadRequest> requests = {
+        { "Miku", "Model/~N.pmd", "Model/squat.vmd" },
+    };
+#endif
+    // vpɁAŏ̃f𕡐ēǂݍށi`悵Ȃ̂ GPU \[X͍Ȃj
+    if (m_BenchmarkActorNum > 1) {
+        const ModelLoadRequest base = requests[0];
+        for (uint32_t i = 1; i < m_BenchmarkActorNum; ++i) {
+            ModelLoadRequest request = base;
+            request.MotionOnly = true;
+            requests.push_back(request);
+        }
+    }
+
+    std::vector<PMDActorPtr> actors;
+    ModelLoader loader(&m_ThreadPool);
+    if (!loader.Load(&m_Resource, requests, &actors)) {
         return false;
     }
-#endif
+
+    // ͌vɂgA`悷͍̂ŏ̃fɂ
+    if (m_BenchmarkActorNum > 0) {
+        ActorScene benchmark_scene;
+        for (const auto& actor : actors) {
+            benchmark_scene.AddActor(actor);
+        }
+        const std::vector<uint32_t> thread_nums = { 1, 2, 4, 8, 16, 32, 64 };
+        ReportSceneBenchmark(RunSceneBenchmark(&benchmark_scene, thread_nums, k_BenchmarkFrameNum), benchmark_scene.ActorNum());
+    }
+    m_Model = actors[0];
+    m_Scene.AddActor(m_Model);
+
+    // _VF[_[͒_tH[}bgɍA`悷AN^[̃tH[}bgɍ킹đI
+    for (uint32_t i = 0; i < VertexBufferPMD::k_FormatNum; ++i) {
+        const auto format = static_cast<VertexBufferPMD::Format>(i);
+        m_VertexShaders[i] = CompileShader(L"BasicVertexShader.hlsl", VertexBufferPMD::FormatVertexShaderEntry(format), CompileShader::Type::k_VertexShader);
+        if (!m_VertexShaders[i].IsValid()) {
+            return false;
+        }
+    }
+    auto vertbuff = m_Model->GetVertexBuffer();
 
     m_Matrix.World = XMMatrixIdentity();
     m_Matrix.View = XMMatrixIdentity();
     m_Matrix.Proj = XMMatrixIdentity();
+    m_Matrix.UVRange = vertbuff->UVRange();
+    m_Matrix.LightColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+    m_Matrix.LightDir = XMFLOAT4(1.0f, -1.0f, 1.0f, 0.0f);
+    m_Matrix.Eye = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    std::fill(std::begin(m_Matrix.Bones), std::end(m_Matrix.Bones), XMMatrixIdentity());
     if (!m_ConstBuff.Create(&m_Resource, sizeof(m_Matrix), 1, m_Resource.ResourceHandle("MatrixResource"))) {
         return false;
     }
+    // t[͕ς萔ނ̂ŁAŏɑŜł
+    if (!m_ConstBuff.Write(&m_Matrix, sizeof(m_Matrix))) {
+        return false;
+    }
 
-    // Aj[VX^[g
-    m_Model.PlayAnimation();
+    // JEƖ̃[ViΌŒ̃JEƖj
+    m_SceneTrack.SetDefault(
+        SceneCamera{ XMFLOAT3(0.0f, 10.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), -15.0f, XM_PIDIV2, true },
+        SceneLight{ XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT3(1.0f, -1.0f, 1.0f) },
+        SceneShadow{ 0, 0.0f }
+    );
+    if (m_SceneMotion.Open("Model/camera.vmd", false)) {
+        m_SceneTrack.Bind(m_SceneMotion);
+    }
+
+    // Aj[VX^[gifƃJ͓Ői߂j
+    for (uint32_t i = 0; i < m_Scene.ActorNum(); ++i) {
+        const PMDActorPtr& actor = m_Scene.GetActor(i);
+        actor->SetClock(m_Clock);
+        // dȂȂIKiȆEEXJ[gȂǁj̓[J[Xbhłɉ
+        actor->GetIKSolver().SetThreadPool(&m_ThreadPool);
+        actor->PlayAnimation();
+    }
+    m_SceneStartTime = m_Clock->Now();
 
 #if 0
     // [VeXg
     // {[Rs[
-    auto& bone_metrices = m_Model.GetBoneMetricesForMotion();
+    auto& bone_metrices = m_Model->GetBoneMetricesForMotion();
 
-    const auto& vmd_motion_table = m_Model.GetVMDMotionTable().GetMotionTable();
+    const auto& vmd_motion_table = m_Model->GetVMDMotionTable().GetMotionTable();
     for (const auto& bone_motion : vmd_motion_table) {
-        const auto& node = m_Model.GetPMDData().BoneFromName(bone_motion.first);
+        const auto& node = m_Model->GetPMDData().BoneFromName(bone_motion.first);
         const auto& pos = node->BoneStartPos;
 
         auto mat =
@@ -354,7 +439,7 @@ bool GraphicEngine::InitializeDX12( HWND hwnd )
 #endif
 #if 0
     // ɘr]
-    auto arm_bone = m_Model.GetPMDData().BoneFromName("r");
+    auto arm_bone = m_Model->GetPMDData().BoneFromName("r");
     if (arm_bone) {
         const auto& pos = arm_bone.value().BoneStartPos;
         auto mat =
@@ -365,7 +450,7 @@ bool GraphicEngine::InitializeDX12( HWND hwnd )
         bone_metrices[arm_bone.value().BoneIdx] = mat;
     }
     // ɂЂ]
-    auto elbow_bone = m_Model.GetPMDData().BoneFromName("Ђ");
+    auto elbow_bone = m_Model->GetPMDData().BoneFromName("Ђ");
     if (elbow_bone) {
         const auto& pos = elbow_bone.value().BoneStartPos;
         auto mat =
@@ -376,9 +461,9 @@ bool GraphicEngine::InitializeDX12( HWND hwnd )
         bone_metrices[elbow_bone.value().BoneIdx] = mat;
     }
 
-    auto root_bone = m_Model.GetPMDData().BoneFromName("Z^[");
+    auto root_bone = m_Model->GetPMDData().BoneFromName("Z^[");
     if (root_bone) {
-        m_Model.RecursiveMatrixMultiply(&(root_bone.value()), DirectX::XMMatrixIdentity());
+        m_Model->RecursiveMatrixMultiply(&(root_bone.value()), DirectX::XMMatrixIdentity());
     }
 
     std::copy_n(
@@ -551,8 +636,7 @@ bool GraphicEngine::CreateGraphicPipeLine()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
 
     gpipeline.pRootSignature = nullptr;     // ƂŐݒ肷
-    gpipeline.VS.pShaderBytecode = m_VertexShader.GetBlob()->GetBufferPointer();
-    gpipeline.VS.BytecodeLength = m_VertexShader.GetBlob()->GetBufferSize();
+    gpipeline.VS.pShaderBytecode = nullptr; // _VF[_[Ɠ̓CAEg͒_tH[}bgɐݒ肷
     gpipeline.PS.pShaderBytecode = m_PixelShader.GetBlob()->GetBufferPointer();
     gpipeline.PS.BytecodeLength = m_PixelShader.GetBlob()->GetBufferSize();
 
@@ -584,10 +668,6 @@ bool GraphicEngine::CreateGraphicPipeLine()
     gpipeline.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS;         // ق̗p
     gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT;                                // [xl 32bit float
 
-    // ̓CAEg̐ݒ
-    gpipeline.InputLayout.pInputElementDescs = m_Model.GetVertexBuffer()->GetVertexLayout();
-    gpipeline.InputLayout.NumElements = m_Model.GetVertexBuffer()->VertexLayoutLength();
-
     // gCAOJbgȂ
     gpipeline.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
     // Op`ō\
@@ -609,9 +689,18 @@ bool GraphicEngine::CreateGraphicPipeLine()
     gpipeline.pRootSignature = rootsignature;
     m_RootSignature = rootsignature;
 
-    auto result = m_Device->CreateGraphicsPipelineState(&gpipeline, IID_PPV_ARGS(&m_PipelineState));
-    if (result != S_OK) {
-        return false;
+    // _tH[}bgɁA_VF[_[Ɠ̓CAEgςpCvC
+    for (uint32_t i = 0; i < VertexBufferPMD::k_FormatNum; ++i) {
+        const auto format = static_cast<VertexBufferPMD::Format>(i);
+        gpipeline.VS.pShaderBytecode = m_VertexShaders[i].GetBlob()->GetBufferPointer();
+        gpipeline.VS.BytecodeLength = m_VertexShaders[i].GetBlob()->GetBufferSize();
+        gpipeline.InputLayout.pInputElementDescs = VertexBufferPMD::FormatVertexLayout(format);
+        gpipeline.InputLayout.NumElements = VertexBufferPMD::FormatVertexLayoutLength(format);
+
+        auto result = m_Device->CreateGraphicsPipelineState(&gpipeline, IID_PPV_ARGS(&m_PipelineStates[i]));
+        if (result != S_OK) {
+            return false;
+        }
     }
 
     return true;
@@ -651,6 +740,28 @@ bool GraphicEngine::CreateRootSignature( ID3D12RootSignature** rootsignature )
     return result == S_OK;
 }
 
+float GraphicEngine::SceneFrame()
+{
+    const double now = m_Clock->Now();
+    float frame = static_cast<float>((now - m_SceneStartTime) * PMDActor::k_MotionFps);
+
+    // f̃[VƓAŌ̃L[t[̎̃t[Ő擪ɖ߂
+    const float length = static_cast<float>(m_SceneTrack.MaxKeyFrameNo() + 1);
+    if (frame >= length) {
+        const double loops = std::floor(frame / length);
+        m_SceneStartTime += loops * length / PMDActor::k_MotionFps;
+        frame = static_cast<float>((now - m_SceneStartTime) * PMDActor::k_MotionFps);
+        frame = std::clamp(frame, 0.0f, std::nextafter(length, 0.0f));
+    }
+    return std::max(frame, 0.0f);
+}
+
+bool GraphicEngine::WriteMatrix(const void* member, uint32_t size)
+{
+    const auto offset = reinterpret_cast<const uint8_t*>(member) - reinterpret_cast<const uint8_t*>(&m_Matrix);
+    return m_ConstBuff.Write(member, static_cast<uint32_t>(offset), size);
+}
+
 bool GraphicEngine::SetRenderTargetResourceBarrier( UINT bbidx, bool barrier_on_flag )
 {
     ID3D12Resource* backbuffer = nullptr;
@@ -13,15 +13,25 @@
 #include "Resource.hpp"
 #include "Matrix.hpp"
 #include "PMDActor.hpp"
+#include "ThreadPool.hpp"
+#include "ActorScene.hpp"
+#include "AnimationClock.hpp"
+#include "SceneTrack.hpp"
 
 class GraphicEngine
 {
 public:
     static constexpr int k_WindowWidth = 1152;
     static constexpr int k_WindowHeight = 648;
+    static constexpr float k_NearZ = 1.0f;          // ߃Nbv
+    static constexpr float k_FarZ = 1000.0f;        // NbvʁiMMD ̃J[V͋傫̂ōL߂ɂƂj
+    static constexpr uint32_t k_BenchmarkFrameNum = 300;    // vŃXbhɍXVt[
 
 
-    static bool Initialize(HWND hwnd);
+    // @brief DirectX12 Afǂݍ
+    // @param benchmark_actor_num 0 ȊOȂAŏ̃f̐ēǂݍ݁AXṼX[vbg𑪂
+    //                            î͕ĂāAŏ̃f`悷j
+    static bool Initialize(HWND hwnd, uint32_t benchmark_actor_num = 0);
     static GraphicEngine& Instance();
     static void EnableDebugLayer();
 
@@ -48,6 +58,8 @@ private:
     bool LinkSwapchainToDesc();
     bool CreateRootSignature(ID3D12RootSignature** rootsignature);
     bool SetRenderTargetResourceBarrier(UINT bbidx, bool barrier_on_flag);
+    float SceneFrame();
+    bool WriteMatrix(const void* member, uint32_t size);
 
     ID3D12Device* m_Device;
     IDXGIFactory6* m_DxgiFactory;
@@ -62,10 +74,10 @@ private:
     ID3D12Resource* m_DepthBuffer;
     ID3D12DescriptorHeap* m_DSV_Heap;
 
-    CompileShader m_VertexShader;
+    CompileShader m_VertexShaders[VertexBufferPMD::k_FormatNum];     // _tH[}bg̒_VF[_[
     CompileShader m_PixelShader;
 
-    ID3D12PipelineState* m_PipelineState;
+    ID3D12PipelineState* m_PipelineStates[VertexBufferPMD::k_FormatNum];  // _tH[}bg̃pCvC
     ID3D12RootSignature* m_RootSignature;
 
     Fence m_Fence;
@@ -75,7 +87,15 @@ private:
     ConstantBuffer m_ConstBuff;
 
     SceneMatrix m_Matrix;
-    PMDActor m_Model;
+    ThreadPool m_ThreadPool;
+    ActorScene m_Scene;                     // [VXVAN^[iXbhv[œɍXVj
+    PMDActorPtr m_Model;                    // `悷AN^[im_Scene ̐擪j
+    uint32_t m_BenchmarkActorNum;           // XṼX[vbg𑪂AN^[i0 Ȃ瑪Ȃj
+
+    AnimationClockPtr   m_Clock;            // fƃJŋL鎞
+    double              m_SceneStartTime;   // JEƖ̃[VJn̎ibj
+    VMDMotionTable      m_SceneMotion;      // JEƖ̃[V
+    SceneTrackEvaluator m_SceneTrack;
 
     ResourceManager m_Resource;
     TextureGroup m_Textures;
@@ -0,0 +1,230 @@
+#include "BakedMotion.hpp"
+#include "FilePath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cwchar>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    constexpr uint64_t k_PoseAlign = 256;
+
+    DirectX::XMMATRIX ComposePose(DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR translation)
+    {
+        DirectX::XMMATRIX mat = DirectX::XMMatrixRotationQuaternion(rotation);
+        mat.r[3] = DirectX::XMVectorSetW(translation, 1.0f);
+        return mat;
+    }
+}
+
+std::filesystem::path BakedMotion::BakedPath(const std::filesystem::path& vmd_path, uint64_t skeleton_hash)
+{
+    wchar_t hash_str[17]{};
+    swprintf(hash_str, 17, L"%016llx", static_cast<unsigned long long>(skeleton_hash));
+
+    std::filesystem::path baked_path = vmd_path;
+    baked_path.replace_extension(std::wstring(L".") + hash_str + L".vmdb");
+    return baked_path;
+}
+
+BakedMotion::BakedMotion()
+    :
+    m_SkeletonHash(0),
+    m_BoneNum(0),
+    m_FrameNum(0),
+    m_File(),
+    m_PosesBuff(),
+    m_Poses()
+{}
+
+void BakedMotion::Create(uint64_t skeleton_hash, uint32_t bone_num, uint32_t frame_num)
+{
+    m_SkeletonHash = skeleton_hash;
+    m_BoneNum = bone_num;
+    m_FrameNum = frame_num;
+
+    m_File.reset();
+    m_PosesBuff.assign(static_cast<size_t>(bone_num) * frame_num, BakedBonePose{ { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } });
+    m_Poses = DataView<BakedBonePose>(m_PosesBuff.data(), m_PosesBuff.size());
+}
+
+void BakedMotion::SetFrame(uint32_t frame_no, const DirectX::XMMATRIX* matrices)
+{
+    if (frame_no >= m_FrameNum || m_PosesBuff.empty()) {
+        return;
+    }
+
+    BakedBonePose* poses = m_PosesBuff.data() + static_cast<size_t>(frame_no) * m_BoneNum;
+    for (uint32_t i = 0; i < m_BoneNum; ++i) {
+        // {[s͉]ƈړȂ̂ŁA 3x3 ]A4sڂړo
+        DirectX::XMStoreFloat4(&poses[i].Rotation, DirectX::XMQuaternionNormalize(DirectX::XMQuaternionRotationMatrix(matrices[i])));
+        DirectX::XMStoreFloat3(&poses[i].Translation, matrices[i].r[3]);
+    }
+}
+
+bool BakedMotion::Load(
+    const std::filesystem::path& baked_path,
+    const std::filesystem::path& vmd_path,
+    uint64_t skeleton_hash,
+    uint32_t bone_num
+)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(baked_path, ec) || ec) {
+        return false;
+    }
+
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(baked_path)) {
+        return false;
+    }
+
+    MappedFileReader reader(file->Data(), file->Size());
+    BakedMotionHeader header{};
+    if (!reader.Read(&header)) {
+        return false;
+    }
+    if (std::memcmp(header.Magic, k_Magic, sizeof(k_Magic)) != 0 || header.Version != k_Version) {
+        return false;
+    }
+    if (header.SkeletonHash != skeleton_hash || header.BoneNum != bone_num || header.FrameNum == 0) {
+        return false;
+    }
+
+    uint64_t size = 0;
+    int64_t write_time = 0;
+    if (!GetFileStamp(vmd_path, &size, &write_time) || size != header.SourceSize || write_time != header.SourceWriteTime) {
+        return false;
+    }
+
+    if (header.PoseOffset < sizeof(BakedMotionHeader) || !reader.Skip(header.PoseOffset - sizeof(BakedMotionHeader))) {
+        return false;
+    }
+    DataView<BakedBonePose> poses;
+    if (!reader.View(static_cast<size_t>(header.BoneNum) * header.FrameNum, &poses) || poses.empty()) {
+        return false;
+    }
+
+    m_SkeletonHash = header.SkeletonHash;
+    m_BoneNum = header.BoneNum;
+    m_FrameNum = header.FrameNum;
+    m_PosesBuff.clear();
+    m_Poses = poses;
+    m_File = file;
+
+    return true;
+}
+
+bool BakedMotion::Save(const std::filesystem::path& baked_path, const std::filesystem::path& vmd_path) const
+{
+    if (!IsValid()) {
+        return false;
+    }
+
+    BakedMotionHeader header{};
+    std::memcpy(header.Magic, k_Magic, sizeof(k_Magic));
+    header.Version = k_Version;
+    header.SkeletonHash = m_SkeletonHash;
+    if (!GetFileStamp(vmd_path, &header.SourceSize, &header.SourceWriteTime)) {
+        return false;
+    }
+    header.BoneNum = m_BoneNum;
+    header.FrameNum = m_FrameNum;
+    header.PoseOffset = (sizeof(BakedMotionHeader) + k_PoseAlign - 1) & ~(k_PoseAlign - 1);
+
+    const uint64_t pose_size = static_cast<uint64_t>(m_Poses.size()) * sizeof(BakedBonePose);
+    std::vector<uint8_t> blob(header.PoseOffset + pose_size, 0);
+    std::memcpy(blob.data(), &header, sizeof(header));
+    std::memcpy(blob.data() + header.PoseOffset, m_Poses.data(), pose_size);
+
+    // ݓr̃t@Cǂ܂Ȃ悤Aꎞt@CɏĂu
+    // ModelLoader ̃[J[Xbh瓯t@C𓯎ɕۑ邱Ƃ̂ŁAꎞt@C̓Xbhɕς
+    std::filesystem::path tmp_path = baked_path;
+    tmp_path += L"." + std::to_wstring(std::hash<std::thread::id>()(std::this_thread::get_id())) + L".tmp";
+    bool written = false;
+    {
+        std::ofstream ofs(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (ofs) {
+            ofs.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+            ofs.flush();
+            written = static_cast<bool>(ofs);
+        }
+    }
+
+    std::error_code ec;
+    if (!written) {
+        // ̈ꎞt@CcȂ
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    std::filesystem::rename(tmp_path, baked_path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool BakedMotion::IsValid() const
+{
+    return m_FrameNum > 0 && m_Poses.size() == static_cast<size_t>(m_BoneNum) * m_FrameNum;
+}
+
+uint32_t BakedMotion::BoneNum() const
+{
+    return m_BoneNum;
+}
+
+uint32_t BakedMotion::FrameNum() const
+{
+    return m_FrameNum;
+}
+
+void BakedMotion::Sample(float frame, DirectX::XMMATRIX* matrices) const
+{
+    if (!IsValid()) {
+        return;
+    }
+
+    const float last = static_cast<float>(m_FrameNum - 1);
+    frame = std::min(std::max(frame, 0.0f), last);
+    const uint32_t frame_no = static_cast<uint32_t>(frame);
+    const float t = frame - static_cast<float>(frame_no);
+    const BakedBonePose* poses0 = FramePoses(frame_no);
+
+    // t[ȂԂɂ̂܂܎g
+    if (t <= 0.0f || frame_no + 1 >= m_FrameNum) {
+        for (uint32_t i = 0; i < m_BoneNum; ++i) {
+            matrices[i] = ComposePose(DirectX::XMLoadFloat4(&poses0[i].Rotation), DirectX::XMLoadFloat3(&poses0[i].Translation));
+        }
+        return;
+    }
+
+    const BakedBonePose* poses1 = FramePoses(frame_no + 1);
+    const DirectX::XMVECTOR vt = DirectX::XMVectorReplicate(t);
+    for (uint32_t i = 0; i < m_BoneNum; ++i) {
+        const DirectX::XMVECTOR q0 = DirectX::XMLoadFloat4(&poses0[i].Rotation);
+        DirectX::XMVECTOR q1 = DirectX::XMLoadFloat4(&poses1[i].Rotation);
+        // 肵Ȃ悤AςȂ畄𔽓]ĂԂ
+        if (DirectX::XMVectorGetX(DirectX::XMVector4Dot(q0, q1)) < 0.0f) {
+            q1 = DirectX::XMVectorNegate(q1);
+        }
+        const DirectX::XMVECTOR rotation = DirectX::XMQuaternionNormalize(DirectX::XMVectorLerpV(q0, q1, vt));
+        const DirectX::XMVECTOR translation = DirectX::XMVectorLerpV(
+            DirectX::XMLoadFloat3(&poses0[i].Translation),
+            DirectX::XMLoadFloat3(&poses1[i].Translation),
+            vt
+        );
+        matrices[i] = ComposePose(rotation, translation);
+    }
+}
+
+const BakedBonePose* BakedMotion::FramePoses(uint32_t frame_no) const
+{
+    return m_Poses.data() + static_cast<size_t>(frame_no) * m_BoneNum;
+}
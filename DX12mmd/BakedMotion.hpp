@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <filesystem>
+#include <DirectXMath.h>
+
+#include "MappedFile.hpp"
+
+// 1{[E1t[̏ĂݍςݎpiXLjOp{[s]ƈړɕ́j
+struct BakedBonePose
+{
+    DirectX::XMFLOAT4 Rotation;         // ]iNH[^jIj
+    DirectX::XMFLOAT3 Translation;      // ړ
+};
+
+// .vmdb t@Ci[Vt[̃{[sɏĂ񂾂́j̃tH[}bg
+//
+// [BakedMotionHeader][piBakedBonePose t[E{[ԍ FrameNum * BoneNum j]
+// wb_[ɂ̓XPgiIKj̃nbVƌVMDt@C̏Aǂ炩ςĂĂB
+struct BakedMotionHeader
+{
+    char     Magic[4];                  // "VMDB"
+    uint32_t Version;                   // tH[}bgo[W
+    uint64_t SkeletonHash;              // Ă񂾃f̃XPg̃nbV
+    uint64_t SourceSize;                // VMDt@C̃TCY
+    int64_t  SourceWriteTime;           // VMDt@C̍XV
+    uint32_t BoneNum;                   // 1t[̃{[
+    uint32_t FrameNum;                  // t[
+    uint64_t PoseOffset;                // t@C擪pf[^܂ł̃ItZbg
+};
+
+// [VĂ񂾎p̗
+//
+// [VEIK St[ɌvZĂAĐׂ͗荇2t[Ԃ邾ɂB
+// {[s̓fԂł̍̕ϊi]{ړjȂ̂ŁANH[^jIƈړʂŎA
+// Ԃ̓NH[^jI̐K`Ԃƈړʂ̐`ԂōsB
+// t[ԍ̂Ƃ͕ԂÃt[̎p̂܂܎gB
+// \i[tj͏Ă܂Ȃ̂ŁAĐ VMD vZB
+class BakedMotion
+{
+public:
+
+    static constexpr char     k_Magic[4] = { 'V', 'M', 'D', 'B' };
+    static constexpr uint32_t k_Version = 1;
+
+    // @brief VMDt@CƃXPgɑΉĂ݃t@C̃pXi"[V.<nbV>.vmdb"jԂ
+    //        [Vʂ̃fŏĂłÃ݂t@C㏑Ȃ悤ɃnbV܂߂
+    static std::filesystem::path BakedPath(const std::filesystem::path& vmd_path, uint64_t skeleton_hash);
+
+    BakedMotion();
+
+    // @brief Ăݐ̗̈mۂ
+    // @param skeleton_hash XPg̃nbV
+    // @param bone_num      1t[̃{[
+    // @param frame_num     t[
+    void Create(uint64_t skeleton_hash, uint32_t bone_num, uint32_t frame_num);
+
+    // @brief 1t[̃{[sĂ
+    // @param frame_no t[ԍ
+    // @param matrices {[ԍ̃XLjOp{[siBoneNum j
+    void SetFrame(uint32_t frame_no, const DirectX::XMMATRIX* matrices);
+
+    // @brief Ă݃t@Cǂݍ
+    // @param baked_path    Ă݃t@CpX
+    // @param vmd_path      VMDt@CpXiXV`FbNɎgj
+    // @param skeleton_hash Đ郂f̃XPg̃nbV
+    // @param bone_num      Đ郂f̃{[
+    // @retval t@CEĂEÂEʂ̃XPg̏ꍇ false
+    bool Load(
+        const std::filesystem::path& baked_path,
+        const std::filesystem::path& vmd_path,
+        uint64_t skeleton_hash,
+        uint32_t bone_num
+    );
+
+    // @brief Ă񂾎pt@Cɕۑ
+    //        ꎞt@CɏłûŁAɓǂݍłĂݓr̃t@C͌Ȃ
+    bool Save(const std::filesystem::path& baked_path, const std::filesystem::path& vmd_path) const;
+
+    bool IsValid() const;
+    uint32_t BoneNum() const;
+    uint32_t FrameNum() const;
+
+    // @brief Ă񂾎p{[s
+    // @param frame    t[ԍiőÕt[ԂB͈͊O͒[̃t[j
+    // @param matrices {[ԍ̃{[siBoneNum ށj
+    void Sample(float frame, DirectX::XMMATRIX* matrices) const;
+
+private:
+
+
+    const BakedBonePose* FramePoses(uint32_t frame_no) const;
+
+    uint64_t                   m_SkeletonHash;
+    uint32_t                   m_BoneNum;
+    uint32_t                   m_FrameNum;
+
+    MappedFilePtr              m_File;          // ǂݍ񂾃t@Cim_Poses ̎QƐj
+    std::vector<BakedBonePose> m_PosesBuff;     // Ă񂾎pit@Cǂ񂾏ꍇ͋j
+    DataView<BakedBonePose>    m_Poses;         // St[̎p
+};
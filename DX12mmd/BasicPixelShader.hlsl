@@ -9,10 +9,10 @@ SamplerState smpToon : register(s1);    // 1
 float4 BasicPS(VertexShaderOutput input) : SV_TARGET
 {
 	// ̌xNgisj
-	float3 light = normalize(float3(1, -1, 1));
+	float3 light = normalize(lightdir.xyz);
 
 	// Cg̃J[
-	float lightColor = float3(1, 1, 1);
+	float3 lightColor = lightcolor.rgb;
 
 	// fBt[YvZ
 	float diffuseB = saturate(dot(-light, input.normal));
@@ -32,6 +32,7 @@ float4 BasicPS(VertexShaderOutput input) : SV_TARGET
 	return max(
 		saturate(
 			toonDif		    // Px
+			* float4(lightColor, 1)	// CgF
 			* diffuse		// fBt[YF
 			* texColor		// eNX`F
 			* sph.Sample(smp, sphereMapUV) 			// XtBA}bviZj
@@ -39,7 +40,7 @@ float4 BasicPS(VertexShaderOutput input) : SV_TARGET
 			+ 
 		saturate(
 			spa.Sample(smp, sphereMapUV) * texColor			// XtBA}bviZj
-			+ float4(specularB * specular.rgb, 1)	// XyL
+			+ float4(specularB * specular.rgb * lightColor, 1)	// XyL
 		)
 			, float4(texColor * ambient, 1)			// ArGg
 	);
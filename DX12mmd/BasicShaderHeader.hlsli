@@ -16,6 +16,9 @@ cbuffer cbuff0 : register(b0)
     matrix world;       // [hs
     matrix view;        // r[s
     matrix proj;        // vWFNVs
+    float4 uvrange;     // k_UVpixy: ŏl, zw: j
+    float4 lightcolor;  // CgFiw ͖gpj
+    float4 lightdir;    // ̌iw ͖gpj
     float3 eye;         // _W
 
     matrix bones[256];  // {[s
@@ -1,11 +1,12 @@
 #include "BasicShaderHeader.hlsli"
 
-VertexShaderOutput BasicVS(
-	float4 pos : POSITION,
-	float4 normal : NORMAL,
-	float2 uv : TEXCOORD,
-	min16uint2 boneno : BONE_NO,
-	min16uint weight : WEIGHT
+// {[ό`ƍWϊi_tH[}bgɂ炸ʁj
+VertexShaderOutput TransformVertex(
+	float4 pos,
+	float4 normal,
+	float2 uv,
+	uint2 boneno,
+	uint weight
 )
 {
 	VertexShaderOutput output;
@@ -28,4 +29,42 @@ VertexShaderOutput BasicVS(
 	output.ray = normalize(pos.xyz - eye);    // xNgvZ
 
 	return output;
-}
\ No newline at end of file
+}
+
+VertexShaderOutput BasicVS(
+	float4 pos : POSITION,
+	float4 normal : NORMAL,
+	float2 uv : TEXCOORD,
+	min16uint2 boneno : BONE_NO,
+	min16uint weight : WEIGHT
+)
+{
+	return TransformVertex(pos, normal, uv, boneno, weight);
+}
+
+// ʑ̃}bsO@𕜌iCompactVertexConverter::DecodeNormal ƓvZj
+float3 DecodeNormal(float2 e)
+{
+	float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += (n.xy >= 0.0f) ? -t : t;
+	return normalize(n);
+}
+
+// k_iPMDCompactVertexjp
+VertexShaderOutput CompactVS(
+	float3 pos : POSITION,
+	float2 normal : NORMAL,
+	float2 uv : TEXCOORD,
+	uint2 boneno : BONE_NO,
+	uint weight : WEIGHT
+)
+{
+	return TransformVertex(
+		float4(pos, 1.0f),
+		float4(DecodeNormal(normal), 0.0f),
+		uvrange.xy + uv * uvrange.zw,
+		boneno,
+		weight
+	);
+}
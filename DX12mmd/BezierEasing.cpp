@@ -0,0 +1,201 @@
+#include "BezierEasing.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // _[ɂȐ͒[̋߂ x(t) ̌Xق 0 ɂȂAԓ̐`Ԃ̏l傫̂ŁA
+    // 񐔂Œ肹 t ̕ω k_Tolerance ȉɂȂ܂ŌJԂiʏ2`3Ŏ܂j
+    constexpr uint32_t k_MaxIterations = 16;
+    constexpr float    k_Tolerance = 1e-7f;
+    constexpr float    k_MinSlope = 1e-6f;
+
+    // ̒ԁiMMD o 20, 20, 107, 107j
+    constexpr uint8_t k_LinearP1 = 20;
+    constexpr uint8_t k_LinearP2 = 107;
+
+    DirectX::XMVECTOR LoadLanes(const float* lanes)
+    {
+        return DirectX::XMLoadFloat4A(reinterpret_cast<const DirectX::XMFLOAT4A*>(lanes));
+    }
+}
+
+BezierEasingTable::BezierEasingTable()
+    :
+    m_Curves(),
+    m_CurveIndexTable()
+{
+    // Ȑԍ 0 ͏ɒԂɂĂ
+    Register(k_LinearP1, k_LinearP1, k_LinearP2, k_LinearP2);
+}
+
+uint32_t BezierEasingTable::Register(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    // x1 == y1  x2 == y2 ̋Ȑ͂ǂȂ̂ŁA1ɂ܂Ƃ߂
+    if (x1 == y1 && x2 == y2 && !m_Curves.empty()) {
+        return k_LinearCurve;
+    }
+
+    const uint32_t key = (static_cast<uint32_t>(x1) << 24) | (static_cast<uint32_t>(y1) << 16) | (static_cast<uint32_t>(x2) << 8) | y2;
+    auto itr = m_CurveIndexTable.find(key);
+    if (itr != m_CurveIndexTable.end()) {
+        return itr->second;
+    }
+
+    const double px1 = x1 / 127.0, py1 = y1 / 127.0;
+    const double px2 = x2 / 127.0, py2 = y2 / 127.0;
+
+    Curve curve;
+    const double cx = 3.0 * px1;
+    const double bx = 3.0 * (px2 - px1) - cx;
+    const double ax = 1.0 - cx - bx;
+    const double cy = 3.0 * py1;
+    const double by = 3.0 * (py2 - py1) - cy;
+    const double ay = 1.0 - cy - by;
+    curve.Ax = static_cast<float>(ax);
+    curve.Bx = static_cast<float>(bx);
+    curve.Cx = static_cast<float>(cx);
+    curve.Ay = static_cast<float>(ay);
+    curve.By = static_cast<float>(by);
+    curve.Cy = static_cast<float>(cy);
+
+    // _ x  0`1 Ȃ̂ x(t) ͒P
+    for (uint32_t i = 0; i <= k_SegmentNum; ++i) {
+        const double t = static_cast<double>(i) / k_SegmentNum;
+        curve.X[i] = static_cast<float>(((ax * t + bx) * t + cx) * t);
+    }
+
+    const uint32_t idx = static_cast<uint32_t>(m_Curves.size());
+    m_Curves.push_back(curve);
+    m_CurveIndexTable.emplace(key, idx);
+
+    return idx;
+}
+
+uint32_t BezierEasingTable::CurveNum() const
+{
+    return static_cast<uint32_t>(m_Curves.size());
+}
+
+uint32_t BezierEasingTable::FindSegment(const Curve& curve, float x)
+{
+    const float* itr = std::upper_bound(curve.X + 1, curve.X + k_SegmentNum, x);
+    return static_cast<uint32_t>(itr - (curve.X + 1));
+}
+
+float BezierEasingTable::Evaluate(uint32_t curve_idx, float x) const
+{
+    if (curve_idx == k_LinearCurve) {
+        return x;
+    }
+    // [_ł x(t) ̌X 0 ɂȂȐ̂ŁAɊm肳
+    if (x <= 0.0f) {
+        return 0.0f;
+    }
+    if (x >= 1.0f) {
+        return 1.0f;
+    }
+
+    const Curve& curve = m_Curves[curve_idx];
+    const uint32_t seg = FindSegment(curve, x);
+    const float x0 = curve.X[seg];
+    const float x1 = curve.X[seg + 1];
+    float lo = static_cast<float>(seg) / k_SegmentNum;
+    float hi = static_cast<float>(seg + 1) / k_SegmentNum;
+    float t = x1 > x0 ? lo + (hi - lo) * (x - x0) / (x1 - x0) : lo;
+
+    for (uint32_t i = 0; i < k_MaxIterations; ++i) {
+        const float xt = ((curve.Ax * t + curve.Bx) * t + curve.Cx) * t - x;
+        const float dx = (3.0f * curve.Ax * t + 2.0f * curve.Bx) * t + curve.Cx;
+        if (xt < 0.0f) {
+            lo = t;
+        }
+        else {
+            hi = t;
+        }
+        const float next = dx > k_MinSlope ? t - xt / dx : -1.0f;
+        const float prev = t;
+        t = (next >= lo && next <= hi) ? next : (lo + hi) * 0.5f;
+        if (std::fabs(t - prev) <= k_Tolerance) {
+            break;
+        }
+    }
+
+    return ((curve.Ay * t + curve.By) * t + curve.Cy) * t;
+}
+
+DirectX::XMVECTOR BezierEasingTable::Evaluate4(const uint32_t* curves, float x) const
+{
+    using namespace DirectX;
+
+    if (x <= 0.0f) {
+        return XMVectorZero();
+    }
+    if (x >= 1.0f) {
+        return XMVectorSplatOne();
+    }
+
+    // 4Ȑ̌WEt ͈̔́Et ̏levfɏW߂
+    alignas(16) float ax[k_ChannelNum], bx[k_ChannelNum], cx[k_ChannelNum];
+    alignas(16) float ay[k_ChannelNum], by[k_ChannelNum], cy[k_ChannelNum];
+    alignas(16) float lo[k_ChannelNum], hi[k_ChannelNum], t0[k_ChannelNum];
+    for (uint32_t lane = 0; lane < k_ChannelNum; ++lane) {
+        const Curve& curve = m_Curves[curves[lane]];
+        ax[lane] = curve.Ax;
+        bx[lane] = curve.Bx;
+        cx[lane] = curve.Cx;
+        ay[lane] = curve.Ay;
+        by[lane] = curve.By;
+        cy[lane] = curve.Cy;
+
+        const uint32_t seg = FindSegment(curve, x);
+        const float x0 = curve.X[seg];
+        const float x1 = curve.X[seg + 1];
+        lo[lane] = static_cast<float>(seg) / k_SegmentNum;
+        hi[lane] = static_cast<float>(seg + 1) / k_SegmentNum;
+        t0[lane] = x1 > x0 ? lo[lane] + (hi[lane] - lo[lane]) * (x - x0) / (x1 - x0) : lo[lane];
+    }
+
+    const XMVECTOR vax = LoadLanes(ax);
+    const XMVECTOR vbx = LoadLanes(bx);
+    const XMVECTOR vcx = LoadLanes(cx);
+    const XMVECTOR vx = XMVectorReplicate(x);
+    const XMVECTOR three = XMVectorReplicate(3.0f);
+    const XMVECTOR two = XMVectorReplicate(2.0f);
+    const XMVECTOR half = XMVectorReplicate(0.5f);
+    const XMVECTOR min_slope = XMVectorReplicate(k_MinSlope);
+    const XMVECTOR tolerance = XMVectorReplicate(k_Tolerance);
+
+    XMVECTOR vlo = LoadLanes(lo);
+    XMVECTOR vhi = LoadLanes(hi);
+    XMVECTOR t = LoadLanes(t0);
+    for (uint32_t i = 0; i < k_MaxIterations; ++i) {
+        const XMVECTOR xt = XMVectorSubtract(XMVectorMultiply(XMVectorMultiplyAdd(XMVectorMultiplyAdd(vax, t, vbx), t, vcx), t), vx);
+        const XMVECTOR dx = XMVectorMultiplyAdd(XMVectorMultiplyAdd(XMVectorMultiply(three, vax), t, XMVectorMultiply(two, vbx)), t, vcx);
+
+        // ޔ͈͂߂
+        const XMVECTOR below = XMVectorLess(xt, XMVectorZero());
+        vlo = XMVectorSelect(vlo, t, below);
+        vhi = XMVectorSelect(t, vhi, below);
+
+        // j[g@̌ʂ͈͊Oi܂͌Xق 0jȂ񕪖@ɂ
+        const XMVECTOR next = XMVectorSubtract(t, XMVectorDivide(xt, XMVectorMax(dx, min_slope)));
+        const XMVECTOR valid = XMVectorAndInt(
+            XMVectorGreater(dx, min_slope),
+            XMVectorAndInt(XMVectorGreaterOrEqual(next, vlo), XMVectorLessOrEqual(next, vhi))
+        );
+        const XMVECTOR prev = t;
+        t = XMVectorSelect(XMVectorMultiply(XMVectorAdd(vlo, vhi), half), next, valid);
+
+        // 4ȐƂ܂܂ő
+        if (XMVector4LessOrEqual(XMVectorAbs(XMVectorSubtract(t, prev)), tolerance)) {
+            break;
+        }
+    }
+
+    return XMVectorMultiply(
+        XMVectorMultiplyAdd(XMVectorMultiplyAdd(LoadLanes(ay), t, LoadLanes(by)), t, LoadLanes(cy)),
+        t
+    );
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <DirectXMath.h>
+
+// VMD̕ԋȐin_ (0,0)EI_ (1,1) 3xWFȐj]NX
+//
+// _ 0`127 ɗʎqĂ̂ŁAȐ1ɂ܂Ƃ߂ĔԍŎQƂB
+// Ȑɔ}ϐ t 𓙊Ԋuɋ؂ʒu x ǂݍݎɋ߂ĂA
+// ]͕\ x ܂ދԁit ͈̔́jTA͈͓̔Ńj[g@i͈͊Oɏo񕪖@j
+// t ܂܂ŕ␳Ă y vZB
+// 덷 float ŌvZ x(t) ̊ۂߌ덷Ō܂A{x̓񕪖@ŉlƂ̍ 2e-5 ȉ
+// i傫Ȃ̂ x(t) ̌Xق 0 ɂȂ[̋߂ŁAȊO 1e-6 xjB
+// X, Y, Z, ] 4Ȑ͓ x ŕ]̂ŁA4vf̃xNgZł܂Ƃ߂ČvZB
+class BezierEasingTable
+{
+public:
+
+    static constexpr uint32_t k_SegmentNum = 16;                    // t ̋؂萔
+    static constexpr uint32_t k_LinearCurve = 0;                    // Ԃ̋Ȑԍiɓo^ς݁j
+
+    enum Channel
+    {
+        k_ChannelX,
+        k_ChannelY,
+        k_ChannelZ,
+        k_ChannelRotation,
+        k_ChannelNum,
+    };
+
+public:
+
+    BezierEasingTable();
+
+    // @brief Ȑo^i_̋Ȑ͓ԍԂj
+    // @param x1, y1 _1i0`127j
+    // @param x2, y2 _2i0`127j
+    // @retval Ȑԍ
+    uint32_t Register(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+
+    uint32_t CurveNum() const;
+
+    // @brief 1Ȑ]
+    // @param curve Ȑԍ
+    // @param x     0`1
+    float Evaluate(uint32_t curve, float x) const;
+
+    // @brief 4Ȑ𓯂 x ŕ]
+    // @param curves ȐԍiChannel j
+    // @param x      0`1
+    // @retval eȐ yiChannel j
+    DirectX::XMVECTOR Evaluate4(const uint32_t* curves, float x) const;
+
+private:
+
+    // x(t) = ((Ax t + Bx) t + Cx) t, y(t) l
+    struct Curve
+    {
+        float Ax, Bx, Cx;
+        float Ay, By, Cy;
+        float X[k_SegmentNum + 1];      // t = i / k_SegmentNum ł xiPj
+    };
+
+    static uint32_t FindSegment(const Curve& curve, float x);
+
+    std::vector<Curve> m_Curves;
+    std::unordered_map<uint32_t, uint32_t> m_CurveIndexTable;     // _ -> Ȑԍ
+};
@@ -0,0 +1,121 @@
+#include "CompactVertex.hpp"
+#include "PMD.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    int16_t ToSnorm16(float v)
+    {
+        v = std::min(std::max(v, -1.0f), 1.0f);
+        return static_cast<int16_t>(std::lround(v * 32767.0f));
+    }
+
+    float FromSnorm16(int16_t v)
+    {
+        // D3D  SNORM Ɠ -32768  -32767 ͂ǂ -1.0 ɂȂ
+        return std::max(static_cast<float>(v) / 32767.0f, -1.0f);
+    }
+
+    float SignNotZero(float v)
+    {
+        return v >= 0.0f ? 1.0f : -1.0f;
+    }
+}
+
+void CompactVertexConverter::EncodeNormal(const DirectX::XMFLOAT3& normal, int16_t* out)
+{
+    // ʑ̂ɓeA͊Oɐ܂Ԃ
+    float len = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (len <= 0.0f) {
+        out[0] = 0;
+        out[1] = 0;
+        return;
+    }
+
+    float x = normal.x / len;
+    float y = normal.y / len;
+    if (normal.z < 0.0f) {
+        float fx = (1.0f - std::abs(y)) * SignNotZero(x);
+        float fy = (1.0f - std::abs(x)) * SignNotZero(y);
+        x = fx;
+        y = fy;
+    }
+
+    out[0] = ToSnorm16(x);
+    out[1] = ToSnorm16(y);
+}
+
+DirectX::XMFLOAT3 CompactVertexConverter::DecodeNormal(const int16_t* encoded)
+{
+    // VF[_[iDecodeNormaljƓvZ
+    float x = FromSnorm16(encoded[0]);
+    float y = FromSnorm16(encoded[1]);
+    float z = 1.0f - std::abs(x) - std::abs(y);
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    DirectX::XMFLOAT3 result;
+    DirectX::XMStoreFloat3(&result, DirectX::XMVector3Normalize(DirectX::XMVectorSet(x, y, z, 0.0f)));
+    return result;
+}
+
+bool CompactVertexConverter::Convert(const PMDData& pmd, std::vector<uint8_t>* out, DirectX::XMFLOAT4* uv_range)
+{
+    const uint32_t vertex_num = pmd.VertexNum();
+    const PMDVertex* src = reinterpret_cast<const PMDVertex*>(pmd.GetVertexData());
+
+    // UV͈̔͂߂iPMDUV 0`1 𒴂邱Ƃj
+    DirectX::XMFLOAT2 uv_min(0.0f, 0.0f);
+    DirectX::XMFLOAT2 uv_max(1.0f, 1.0f);
+    for (uint32_t i = 0; i < vertex_num; ++i) {
+        if (src[i].BoneNo[0] >= k_MaxBoneNum || src[i].BoneNo[1] >= k_MaxBoneNum) {
+            return false;
+        }
+        uv_min.x = std::min(uv_min.x, src[i].UV.x);
+        uv_min.y = std::min(uv_min.y, src[i].UV.y);
+        uv_max.x = std::max(uv_max.x, src[i].UV.x);
+        uv_max.y = std::max(uv_max.y, src[i].UV.y);
+    }
+    const DirectX::XMFLOAT2 uv_scale(uv_max.x - uv_min.x, uv_max.y - uv_min.y);
+    *uv_range = DirectX::XMFLOAT4(uv_min.x, uv_min.y, uv_scale.x, uv_scale.y);
+
+    out->resize(static_cast<size_t>(vertex_num) * sizeof(PMDCompactVertex));
+    PMDCompactVertex* dst = reinterpret_cast<PMDCompactVertex*>(out->data());
+
+    // ϊȂAl̒lƔׂĂ
+    float min_normal_dot = 1.0f;
+    float max_uv_error = 0.0f;
+    for (uint32_t i = 0; i < vertex_num; ++i) {
+        const PMDVertex& s = src[i];
+        PMDCompactVertex& d = dst[i];
+
+        d.Pos = s.Pos;
+        EncodeNormal(s.Normal, d.Normal);
+        d.UV[0] = static_cast<uint16_t>(std::lround((s.UV.x - uv_min.x) / uv_scale.x * 65535.0f));
+        d.UV[1] = static_cast<uint16_t>(std::lround((s.UV.y - uv_min.y) / uv_scale.y * 65535.0f));
+        d.BoneNo[0] = static_cast<uint8_t>(s.BoneNo[0]);
+        d.BoneNo[1] = static_cast<uint8_t>(s.BoneNo[1]);
+        d.BoneWeight = s.BoneWeight;
+        d.EdgeFlg = s.EdgeFlg;
+
+        DirectX::XMVECTOR normal = DirectX::XMLoadFloat3(&s.Normal);
+        if (DirectX::XMVector3Length(normal).m128_f32[0] > 0.0f) {
+            DirectX::XMFLOAT3 decoded = DecodeNormal(d.Normal);
+            float dot = DirectX::XMVector3Dot(
+                DirectX::XMVector3Normalize(normal), DirectX::XMLoadFloat3(&decoded)
+            ).m128_f32[0];
+            min_normal_dot = std::min(min_normal_dot, dot);
+        }
+
+        float decoded_u = uv_min.x + (d.UV[0] / 65535.0f) * uv_scale.x;
+        float decoded_v = uv_min.y + (d.UV[1] / 65535.0f) * uv_scale.y;
+        max_uv_error = std::max(max_uv_error, std::abs(decoded_u - s.UV.x) / uv_scale.x);
+        max_uv_error = std::max(max_uv_error, std::abs(decoded_v - s.UV.y) / uv_scale.y);
+    }
+
+    return min_normal_dot >= k_NormalTolerance && max_uv_error <= k_UVTolerance;
+}
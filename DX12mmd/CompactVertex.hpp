@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+class PMDData;
+
+// GPU]p̈k_i24bytej
+// PMDVertexi40bytejȉk
+//  - @: ʑ̃}bsO2 snorm16 ŕێ
+//  - UV  : fŜUV͈͂ŐK unorm16 ŕێi͈͂̓VF[_[֒萔œnj
+//  - {[ԍ: 8biti{[256ȉ̃f̂݁j
+// W͕\̏̂ float ̂܂ܐ擪ɒuiPMDVertex Ɠʒuj
+struct PMDCompactVertex
+{
+    DirectX::XMFLOAT3 Pos;
+    int16_t  Normal[2];
+    uint16_t UV[2];
+    uint8_t  BoneNo[2];
+    uint8_t  BoneWeight;
+    uint8_t  EdgeFlg;
+};
+static_assert(sizeof(PMDCompactVertex) == 24, "PMDCompactVertex must be 24 bytes");
+
+class CompactVertexConverter
+{
+public:
+
+    static constexpr uint32_t k_MaxBoneNum = 256;                   // 8bit ŕ\{[
+    static constexpr float    k_NormalTolerance = 0.9999f;          // ̖@Ƃ̓ς̉
+    static constexpr float    k_UVTolerance = 1.0f / 8192.0f;       // UVƂ̍̏iUV͈͂ɑ΂銄j
+
+    // @brief PMD̒_k_ɕϊ
+    // @param pmd      ϊ
+    // @param out      ϊ
+    // @param uv_range UV̕pp[^ixy: ŏl, zw: j
+    // @retval {[A܂͕덷el𒴂ꍇ false
+    static bool Convert(const PMDData& pmd, std::vector<uint8_t>* out, DirectX::XMFLOAT4* uv_range);
+
+    static void EncodeNormal(const DirectX::XMFLOAT3& normal, int16_t* out);
+    static DirectX::XMFLOAT3 DecodeNormal(const int16_t* encoded);
+};
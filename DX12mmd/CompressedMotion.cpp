@@ -0,0 +1,309 @@
+#include "CompressedMotion.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+    constexpr float    k_Sqrt2 = 1.41421356f;
+    constexpr uint32_t k_RotationMax = 0x7FFF;          // ]̊evf̗ʎqii15bitj
+    constexpr uint32_t k_TranslationMax = 0xFFFF;       // ʒůevf̗ʎqii16bitj
+
+    uint16_t QuantizeUnit(float v, uint32_t max)
+    {
+        const float scaled = std::round(std::min(std::max(v, 0.0f), 1.0f) * static_cast<float>(max));
+        return static_cast<uint16_t>(scaled);
+    }
+
+    // 2̉]̍iWAj
+    // ς acos ͍Ƃɐx̂ŁÃxNg̒狁߂
+    float RotationError(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b)
+    {
+        const DirectX::XMVECTOR qa = DirectX::XMQuaternionNormalize(a);
+        DirectX::XMVECTOR qb = DirectX::XMQuaternionNormalize(b);
+        if (DirectX::XMVectorGetX(DirectX::XMVector4Dot(qa, qb)) < 0.0f) {
+            qb = DirectX::XMVectorNegate(qb);
+        }
+        const float chord = DirectX::XMVectorGetX(DirectX::XMVector4Length(DirectX::XMVectorSubtract(qa, qb)));
+        return 4.0f * std::asin(std::min(chord * 0.5f, 1.0f));
+    }
+
+    float PositionError(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b)
+    {
+        return DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(a, b)));
+    }
+}
+
+CompressedMotion::CompressedMotion()
+    :
+    m_TrackNames(),
+    m_Tracks(),
+    m_FrameNos(),
+    m_Rotations(),
+    m_CurveSets(),
+    m_Translations(),
+    m_CurveSetTable(),
+    m_SourceKeyNum(0)
+{}
+
+bool CompressedMotion::Build(
+    const VMDMotionTable::MotionTable& motions,
+    const BezierEasingTable& easing,
+    const MotionCompressionSettings& settings
+)
+{
+    *this = CompressedMotion();
+
+    // Azz̕т͎sɕς肤̂ŁAOɕׂČʂɂ
+    std::vector<const VMDMotionTable::MotionTable::value_type*> sorted;
+    sorted.reserve(motions.size());
+    for (const auto& motion : motions) {
+        if (!motion.second.empty()) {
+            sorted.push_back(&motion);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::unordered_map<uint64_t, uint16_t> curve_set_index;
+    std::vector<uint32_t> kept;
+    for (const auto* motion : sorted) {
+        const auto& keyframes = motion->second;
+        m_SourceKeyNum += static_cast<uint32_t>(keyframes.size());
+
+        if (settings.Decimate) {
+            Decimate(keyframes, easing, settings, &kept);
+        }
+        else {
+            kept.resize(keyframes.size());
+            for (uint32_t i = 0; i < kept.size(); ++i) {
+                kept[i] = i;
+            }
+        }
+
+        Track track{};
+        track.KeyBegin = static_cast<uint32_t>(m_FrameNos.size());
+        track.KeyNum = static_cast<uint32_t>(kept.size());
+
+        // ʒu͈̔
+        DirectX::XMVECTOR min_pos = DirectX::XMLoadFloat3(&keyframes[kept[0]].Offset);
+        DirectX::XMVECTOR max_pos = min_pos;
+        for (uint32_t idx : kept) {
+            const DirectX::XMVECTOR pos = DirectX::XMLoadFloat3(&keyframes[idx].Offset);
+            min_pos = DirectX::XMVectorMin(min_pos, pos);
+            max_pos = DirectX::XMVectorMax(max_pos, pos);
+        }
+        const DirectX::XMVECTOR extent = DirectX::XMVectorSubtract(max_pos, min_pos);
+        DirectX::XMStoreFloat3(&track.TranslationMin, min_pos);
+        DirectX::XMStoreFloat3(&track.TranslationScale, DirectX::XMVectorScale(extent, 1.0f / k_TranslationMax));
+        const bool constant_translation = DirectX::XMVector3Equal(extent, DirectX::XMVectorZero());
+        track.TranslationBegin = constant_translation ? k_ConstantTranslation : static_cast<uint32_t>(m_Translations.size());
+
+        for (uint32_t idx : kept) {
+            const auto& key = keyframes[idx];
+            m_FrameNos.push_back(key.FrameNo);
+            m_Rotations.push_back(EncodeRotation(key.Quaternion));
+
+            // ԋȐ̑gݍ킹͏Ȃ̂ŁAԍUċL
+            uint64_t curve_key = 0;
+            for (uint32_t c = 0; c < BezierEasingTable::k_ChannelNum; ++c) {
+                if (key.Curves[c] > 0xFFFF) {
+                    return false;
+                }
+                curve_key |= static_cast<uint64_t>(key.Curves[c]) << (16 * c);
+            }
+            auto itr = curve_set_index.find(curve_key);
+            if (itr == curve_set_index.end()) {
+                const size_t set_idx = m_CurveSetTable.size() / BezierEasingTable::k_ChannelNum;
+                if (set_idx > 0xFFFF) {
+                    return false;
+                }
+                itr = curve_set_index.emplace(curve_key, static_cast<uint16_t>(set_idx)).first;
+                m_CurveSetTable.insert(m_CurveSetTable.end(), key.Curves, key.Curves + BezierEasingTable::k_ChannelNum);
+            }
+            m_CurveSets.push_back(itr->second);
+
+            if (!constant_translation) {
+                const float offset[3] = { key.Offset.x, key.Offset.y, key.Offset.z };
+                const float lo[3] = { track.TranslationMin.x, track.TranslationMin.y, track.TranslationMin.z };
+                const float range[3] = { DirectX::XMVectorGetX(extent), DirectX::XMVectorGetY(extent), DirectX::XMVectorGetZ(extent) };
+                PackedTranslation packed;
+                for (int k = 0; k < 3; ++k) {
+                    packed.Bits[k] = range[k] > 0.0f ? QuantizeUnit((offset[k] - lo[k]) / range[k], k_TranslationMax) : 0;
+                }
+                m_Translations.push_back(packed);
+            }
+        }
+
+        m_TrackNames.push_back(motion->first);
+        m_Tracks.push_back(track);
+    }
+
+    return true;
+}
+
+uint32_t CompressedMotion::TrackNum() const
+{
+    return static_cast<uint32_t>(m_Tracks.size());
+}
+
+const std::string& CompressedMotion::GetTrackName(uint32_t track_idx) const
+{
+    return m_TrackNames[track_idx];
+}
+
+uint32_t CompressedMotion::KeyNum(uint32_t track_idx) const
+{
+    return m_Tracks[track_idx].KeyNum;
+}
+
+const uint32_t* CompressedMotion::FrameNos(uint32_t track_idx) const
+{
+    return m_FrameNos.data() + m_Tracks[track_idx].KeyBegin;
+}
+
+void CompressedMotion::Decode(uint32_t track_idx, uint32_t key_idx, MotionKeyFrame* out) const
+{
+    const Track& track = m_Tracks[track_idx];
+    const uint32_t idx = track.KeyBegin + key_idx;
+
+    out->FrameNo = m_FrameNos[idx];
+    out->Quaternion = DecodeRotation(m_Rotations[idx]);
+
+    if (track.TranslationBegin == k_ConstantTranslation) {
+        out->Offset = track.TranslationMin;
+    }
+    else {
+        const PackedTranslation& packed = m_Translations[track.TranslationBegin + key_idx];
+        out->Offset.x = track.TranslationMin.x + track.TranslationScale.x * packed.Bits[0];
+        out->Offset.y = track.TranslationMin.y + track.TranslationScale.y * packed.Bits[1];
+        out->Offset.z = track.TranslationMin.z + track.TranslationScale.z * packed.Bits[2];
+    }
+
+    const uint32_t* curves = &m_CurveSetTable[static_cast<size_t>(m_CurveSets[idx]) * BezierEasingTable::k_ChannelNum];
+    std::copy_n(curves, BezierEasingTable::k_ChannelNum, out->Curves);
+}
+
+uint32_t CompressedMotion::SourceKeyNum() const
+{
+    return m_SourceKeyNum;
+}
+
+uint32_t CompressedMotion::CompressedKeyNum() const
+{
+    return static_cast<uint32_t>(m_FrameNos.size());
+}
+
+size_t CompressedMotion::MemorySize() const
+{
+    return m_Tracks.size() * sizeof(Track) +
+        m_FrameNos.size() * sizeof(uint32_t) +
+        m_Rotations.size() * sizeof(PackedRotation) +
+        m_CurveSets.size() * sizeof(uint16_t) +
+        m_Translations.size() * sizeof(PackedTranslation) +
+        m_CurveSetTable.size() * sizeof(uint32_t);
+}
+
+CompressedMotion::PackedRotation CompressedMotion::EncodeRotation(const DirectX::XMFLOAT4& q)
+{
+    DirectX::XMFLOAT4 normalized;
+    DirectX::XMStoreFloat4(&normalized, DirectX::XMQuaternionNormalize(DirectX::XMLoadFloat4(&q)));
+    float comps[4] = { normalized.x, normalized.y, normalized.z, normalized.w };
+
+    // Βlő̗vf͎c3vf畜ł̂ŎȂ
+    // q  -q ͓]Ȃ̂ŁAő̗vfɂȂ悤ɕ𑵂
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i) {
+        if (std::fabs(comps[i]) > std::fabs(comps[largest])) {
+            largest = i;
+        }
+    }
+    const float sign = comps[largest] < 0.0f ? -1.0f : 1.0f;
+
+    // c̗vf -1/2 ` 1/2 Ɏ܂
+    uint16_t bits[3];
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i != largest) {
+            bits[n++] = QuantizeUnit((comps[i] * sign * k_Sqrt2 + 1.0f) * 0.5f, k_RotationMax);
+        }
+    }
+
+    // vf̔ԍ͏2bitɓ
+    PackedRotation packed;
+    packed.Bits[0] = static_cast<uint16_t>(((largest >> 1) << 15) | bits[0]);
+    packed.Bits[1] = static_cast<uint16_t>(((largest & 1) << 15) | bits[1]);
+    packed.Bits[2] = bits[2];
+    return packed;
+}
+
+DirectX::XMFLOAT4 CompressedMotion::DecodeRotation(const PackedRotation& packed)
+{
+    const uint32_t largest = ((packed.Bits[0] >> 15) << 1) | (packed.Bits[1] >> 15);
+
+    float comps[4];
+    float sum = 0.0f;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        const float unit = static_cast<float>(packed.Bits[n++] & k_RotationMax) / k_RotationMax;
+        comps[i] = (unit * 2.0f - 1.0f) / k_Sqrt2;
+        sum += comps[i] * comps[i];
+    }
+    comps[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+
+    return DirectX::XMFLOAT4(comps[0], comps[1], comps[2], comps[3]);
+}
+
+void CompressedMotion::Decimate(
+    const std::vector<MotionKeyFrame>& keyframes,
+    const BezierEasingTable& easing,
+    const MotionCompressionSettings& settings,
+    std::vector<uint32_t>* kept
+)
+{
+    const uint32_t key_num = static_cast<uint32_t>(keyframes.size());
+    kept->clear();
+    kept->push_back(0);
+    if (key_num == 1) {
+        return;
+    }
+
+    // begin  end ܂ł1ԂɂƂAԂ̑St[Ō̃[VƂ̍e덷Ɏ܂邩
+    auto can_merge = [&](uint32_t begin, uint32_t end) {
+        const VMDMotionTable::MotionInterpolater merged{ 0, &keyframes[begin], &keyframes[end] };
+        uint32_t segment = begin;
+        for (uint32_t frame_no = keyframes[begin].FrameNo + 1; frame_no < keyframes[end].FrameNo; ++frame_no) {
+            while (segment + 1 < end && keyframes[segment + 1].FrameNo <= frame_no) {
+                ++segment;
+            }
+            const VMDMotionTable::MotionInterpolater source{ 0, &keyframes[segment], &keyframes[segment + 1] };
+
+            DirectX::XMVECTOR source_rotation, source_offset;
+            DirectX::XMVECTOR merged_rotation, merged_offset;
+            source.Interpolate(static_cast<float>(frame_no), easing, &source_rotation, &source_offset);
+            merged.Interpolate(static_cast<float>(frame_no), easing, &merged_rotation, &merged_offset);
+            if (RotationError(source_rotation, merged_rotation) > settings.MaxAngleError ||
+                PositionError(source_offset, merged_offset) > settings.MaxPositionError) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // OɎcL[t[玟̃L[t[܂ł1ԂɂłȂAԂ̃L[t[Ԉ
+    uint32_t anchor = 0;
+    uint32_t run = 0;
+    for (uint32_t i = 1; i + 1 < key_num; ++i) {
+        if (run < k_MaxDecimateRun && can_merge(anchor, i + 1)) {
+            ++run;
+            continue;
+        }
+        kept->push_back(i);
+        anchor = i;
+        run = 0;
+    }
+    kept->push_back(key_num - 1);
+}
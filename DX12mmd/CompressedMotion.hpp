@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "VMD.hpp"
+
+// {[[Vk̐ݒ
+struct MotionCompressionSettings
+{
+    static constexpr float k_DefaultAngleError = 0.002f;        // 0.1x
+    static constexpr float k_DefaultPositionError = 0.001f;
+
+    bool  Decimate = true;                          // ԂōČłL[t[Ԉ
+    float MaxAngleError = k_DefaultAngleError;      // Ԉŋe]̌덷iWAj
+    float MaxPositionError = k_DefaultPositionError;// Ԉŋeʒǔ덷ifW̋j
+};
+
+// {[[ṼL[t[kĎNX
+//
+// L[t[iMotionKeyFrame 48bytejvf̔zɕėʎqB
+//  - t[ԍ: uint32_ti񕪒TŘAēǂނ̂ŕʔzj
+//  - ]: smallest-threeiΒlő̗vf3vf15bit{vf̔ԍ2bitj6byte
+//  - ʒu: gbN̍ŏlE͈͂Ŋevf16bitɗʎq6byteiSL[ʒũgbN͎Ȃj
+//  - ԋȐ: X, Y, Z, ] ̋Ȑԍ̑gݍ킹̔ԍ2byte
+// Ԉ́AL[t[đÕL[t[ŕԂƂɁA̋Ԃ̑St[
+// ̃[VƂ̍e덷Ɏ܂ꍇsiMMD ƓԂ̕ԋȐ͏I[̃L[t[̂́jB
+// ʎqɂ덷͉]Ŗ1e-4WAAʒuŔ͈͂ 1/131070 Ԉ̌덷ɉB
+class CompressedMotion
+{
+public:
+
+    static constexpr uint32_t k_MaxDecimateRun = 64;    // AĊԈL[t[̏iԈ̔RXg}j
+
+public:
+
+    CompressedMotion();
+
+    // @brief [Vk
+    // @param motions  {[̃L[t[it[ԍ̏j
+    // @param easing   L[t[̕ԋȐ
+    // @param settings k̐ݒ
+    // @retval ԋȐ̑gݍ킹ꍇ false
+    bool Build(
+        const VMDMotionTable::MotionTable& motions,
+        const BezierEasingTable& easing,
+        const MotionCompressionSettings& settings
+    );
+
+    uint32_t TrackNum() const;
+    const std::string& GetTrackName(uint32_t track_idx) const;
+    uint32_t KeyNum(uint32_t track_idx) const;
+    const uint32_t* FrameNos(uint32_t track_idx) const;     // t[ԍiKeyNum j
+
+    // @brief L[t[WJ
+    // @param track_idx gbNԍ
+    // @param key_idx   gbÑL[t[ԍ
+    // @param out       WJ
+    void Decode(uint32_t track_idx, uint32_t key_idx, MotionKeyFrame* out) const;
+
+    uint32_t SourceKeyNum() const;          // ԈÕL[t[
+    uint32_t CompressedKeyNum() const;      // Ԉ̃L[t[
+    size_t   MemorySize() const;            // L[t[f[^̃oCg
+
+private:
+
+    struct Track
+    {
+        uint32_t KeyBegin;                      // m_FrameNos Ȃǂ̐擪vfԍ
+        uint32_t KeyNum;
+        uint32_t TranslationBegin;              // m_Translations ̐擪vfԍiʒuȂ k_ConstantTranslationj
+        DirectX::XMFLOAT3 TranslationMin;       // ʒu̍ŏliȂ炻̒lj
+        DirectX::XMFLOAT3 TranslationScale;     // ʎq1ïʒu
+    };
+
+    struct PackedRotation
+    {
+        uint16_t Bits[3];
+    };
+
+    struct PackedTranslation
+    {
+        uint16_t Bits[3];
+    };
+
+    static constexpr uint32_t k_ConstantTranslation = 0xFFFFFFFF;
+
+    static PackedRotation EncodeRotation(const DirectX::XMFLOAT4& q);
+    static DirectX::XMFLOAT4 DecodeRotation(const PackedRotation& packed);
+
+    static void Decimate(
+        const std::vector<MotionKeyFrame>& keyframes,
+        const BezierEasingTable& easing,
+        const MotionCompressionSettings& settings,
+        std::vector<uint32_t>* kept
+    );
+
+    std::vector<std::string>        m_TrackNames;
+    std::vector<Track>              m_Tracks;
+    std::vector<uint32_t>           m_FrameNos;         // L[t[̃t[ԍ
+    std::vector<PackedRotation>     m_Rotations;        // L[t[̉]
+    std::vector<uint16_t>           m_CurveSets;        // L[t[̕ԋȐ̑gݍ킹ԍ
+    std::vector<PackedTranslation>  m_Translations;     // ʒuωgbÑL[t[̈ʒu
+    std::vector<uint32_t>           m_CurveSetTable;    // ԋȐ̑gݍ킹ik_ChannelNum j
+    uint32_t                        m_SourceKeyNum;
+};
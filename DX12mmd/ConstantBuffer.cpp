@@ -6,6 +6,7 @@
 ConstantBuffer::ConstantBuffer()
     :
     m_ConstBuff(nullptr),
+    m_Mapped(nullptr),
     m_Resource(nullptr)
 {}
 
@@ -49,29 +50,43 @@ bool ConstantBuffer::Create(ResourceManager* resource_manager,
     return true;
 }
 
+uint8_t* ConstantBuffer::Map()
+{
+    if (m_Mapped == nullptr) {
+        auto result = m_ConstBuff->Map(0, nullptr, reinterpret_cast<void**>(&m_Mapped));
+        if (result != S_OK) {
+            m_Mapped = nullptr;
+        }
+    }
+    return m_Mapped;
+}
+
 bool ConstantBuffer::Write(void* ptr, uint32_t size)
 {
-    uint8_t* map = nullptr;
-    auto result = m_ConstBuff->Map(0, nullptr, reinterpret_cast<void**>(&map));
-    if (result != S_OK) {
+    return Write(ptr, 0, size);
+}
+
+bool ConstantBuffer::Write(void* srcdata, WriterFunc func)
+{
+    uint8_t* map = Map();
+    if (map == nullptr) {
         return false;
     }
 
-    uint8_t* src = reinterpret_cast<uint8_t*>(ptr);
-    std::copy_n(src, size, map);
+    func(srcdata, map);
 
     return true;
 }
 
-bool ConstantBuffer::Write(void* srcdata, WriterFunc func)
+bool ConstantBuffer::Write(const void* ptr, uint32_t offset, uint32_t size)
 {
-    uint8_t* map = nullptr;
-    auto result = m_ConstBuff->Map(0, nullptr, reinterpret_cast<void**>(&map));
-    if (result != S_OK) {
+    uint8_t* map = Map();
+    if (map == nullptr) {
         return false;
     }
 
-    func(srcdata, map);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(ptr);
+    std::copy_n(src, size, map + offset);
 
     return true;
-}
\ No newline at end of file
+}
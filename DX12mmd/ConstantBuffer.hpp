@@ -25,9 +25,18 @@ public:
     bool Write(void* ptr, uint32_t size);
     bool Write(void* srcdata, WriterFunc func);
 
+    // @brief obt@[̈ꕔށiς萔XVpj
+    // @param ptr    ރf[^
+    // @param offset obt@[擪̃oCgʒu
+    // @param size   oCg
+    bool Write(const void* ptr, uint32_t offset, uint32_t size);
+
 private:
 
+    uint8_t* Map();
+
     ID3D12Resource*  m_ConstBuff;
+    uint8_t*         m_Mapped;          // }bvAhXiAbv[hq[vȂ̂ōŏ݂̏Ń}bv܂܂ɂj
     ResourceManager* m_Resource;
 };
 
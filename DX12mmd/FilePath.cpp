@@ -42,4 +42,21 @@ TexturePath GetTexturePathFromModelAndTexPath(
     }
 
     return result;
-}
\ No newline at end of file
+}
+
+bool GetFileStamp(const std::filesystem::path& filepath, uint64_t* size, int64_t* write_time)
+{
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(filepath, ec);
+    if (ec) {
+        return false;
+    }
+    auto file_time = std::filesystem::last_write_time(filepath, ec);
+    if (ec) {
+        return false;
+    }
+
+    *size = static_cast<uint64_t>(file_size);
+    *write_time = static_cast<int64_t>(file_time.time_since_epoch().count());
+    return true;
+}
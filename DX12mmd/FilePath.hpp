@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <vector>
 
@@ -14,3 +15,7 @@ TexturePath GetTexturePathFromModelAndTexPath(
     const std::filesystem::path& model_path,
     const std::filesystem::path& texture_path
 );
+
+// @brief t@C̃TCYƍXV擾iLbVt@CƑΉĂ邩̔pj
+// @retval t@Cꍇ false
+bool GetFileStamp(const std::filesystem::path& filepath, uint64_t* size, int64_t* write_time);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+static constexpr uint64_t k_FNV1aOffsetBasis = 0xcbf29ce484222325ULL;
+static constexpr uint64_t k_FNV1aPrime = 0x100000001b3ULL;
+
+// FNV-1a 64bit nbV
+// seed ɑǑʂnƑvZł
+inline uint64_t HashFNV1a(const void* data, size_t size, uint64_t seed = k_FNV1aOffsetBasis)
+{
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= ptr[i];
+        hash *= k_FNV1aPrime;
+    }
+    return hash;
+}
@@ -0,0 +1,480 @@
+#include "IKSolver.hpp"
+#include "SkeletonPose.hpp"
+#include "PMD.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+IKSolver::IKSolver()
+    :
+    m_Jobs(),
+    m_WaveEnds(),
+    m_Pool(nullptr),
+    m_Nodes(),
+    m_ChainBones(),
+    m_Enabled(),
+    m_Stats(),
+    m_IKNum(0),
+    m_WarmRotations(),
+    m_WarmValid(),
+    m_WorkRotations(),
+    m_WorkPositions()
+{}
+
+void IKSolver::Bind(const PMDData& pmd)
+{
+    const auto& iks = pmd.GetPMDIKData();
+    const auto& knees = pmd.GetBoneIndexes();
+    const uint32_t bone_num = pmd.GetSkeleton().BoneNum();
+
+    m_Jobs.clear();
+    m_Nodes.clear();
+    m_ChainBones.clear();
+    m_Stats.clear();
+    m_IKNum = static_cast<uint32_t>(iks.size());
+    uint32_t max_node_num = 0;
+    for (uint32_t ik_idx = 0; ik_idx < m_IKNum; ++ik_idx) {
+        const auto& ik = iks[ik_idx];
+
+        IKChainStats stats;
+        stats.IKBone = ik.BoneIdx;
+        m_Stats.push_back(stats);
+
+        // ͈͊Õ{[wIK̓WuɂȂiIKԍ͂炳Ȃj
+        const bool valid = ik.BoneIdx < bone_num && ik.TargetIdx < bone_num && !ik.NodeIdxes.empty() &&
+            std::all_of(ik.NodeIdxes.begin(), ik.NodeIdxes.end(), [bone_num](uint16_t idx) { return idx < bone_num; });
+        if (!valid) {
+            continue;
+        }
+
+        const uint32_t node_num = static_cast<uint32_t>(ik.NodeIdxes.size());
+        const bool knee = node_num == 2 &&
+            std::find(knees.begin(), knees.end(), ik.NodeIdxes[0]) != knees.end();
+
+        Job job;
+        job.Solve = SelectSolveFunc(node_num, knee);
+        job.IKIdx = static_cast<uint16_t>(ik_idx);
+        job.IKBone = ik.BoneIdx;
+        job.EndBone = ik.TargetIdx;
+        job.Iterations = ik.Iterations;
+        // x@180ŊlL^Ă̂ŁAWAɂ
+        job.Limit = ik.Limit * DirectX::XM_PI;
+        job.NodeBegin = static_cast<uint32_t>(m_Nodes.size());
+        job.NodeNum = node_num;
+        m_Jobs.push_back(job);
+
+        m_Nodes.insert(m_Nodes.end(), ik.NodeIdxes.begin(), ik.NodeIdxes.end());
+        m_Stats.back().NodeNum = node_num;
+        max_node_num = std::max(max_node_num, node_num);
+    }
+
+    m_ChainBones = m_Nodes;
+    std::sort(m_ChainBones.begin(), m_ChainBones.end());
+    m_ChainBones.erase(std::unique(m_ChainBones.begin(), m_ChainBones.end()), m_ChainBones.end());
+
+    m_WarmRotations.assign(m_Nodes.size(), DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+    m_WarmValid.assign(m_IKNum, 0);
+
+    // ꉻĂȂ CCD ̍Ɨ̈́AɉĂdȂȂ悤WuɊmۂĂ
+    if (max_node_num > k_MaxFixedChainLength) {
+        m_WorkRotations.resize(m_Nodes.size());
+        m_WorkPositions.resize(m_Nodes.size());
+    }
+
+    BuildWaves(pmd);
+
+    const uint32_t word_num = std::max<uint32_t>((IKNum() + IKEnableTimeline::k_WordBits - 1) / IKEnableTimeline::k_WordBits, 1);
+    m_Enabled.assign(word_num, ~IKEnableTimeline::Word(0));
+}
+
+void IKSolver::BuildWaves(const PMDData& pmd)
+{
+    const Skeleton& skeleton = pmd.GetSkeleton();
+    const auto& parents = skeleton.Parents();
+    const auto& order = skeleton.Order();
+    const auto& order_pos = skeleton.OrderPositions();
+    const auto& subtree_end = skeleton.SubtreeEnds();
+    const uint32_t bone_num = skeleton.BoneNum();
+    const uint32_t job_num = static_cast<uint32_t>(m_Jobs.size());
+
+    // WuɁA{[iԂ̃{[̕؁jƓǂރ{[Ɉt
+    std::vector<std::vector<uint8_t>> writes(job_num, std::vector<uint8_t>(bone_num, 0));
+    std::vector<std::vector<uint8_t>> reads(job_num, std::vector<uint8_t>(bone_num, 0));
+    for (uint32_t j = 0; j < job_num; ++j) {
+        const Job& job = m_Jobs[j];
+        reads[j][job.IKBone] = 1;
+        reads[j][job.EndBone] = 1;
+        for (uint32_t i = 0; i < job.NodeNum; ++i) {
+            const uint16_t node = m_Nodes[job.NodeBegin + i];
+            reads[j][node] = 1;
+            if (parents[node] != Skeleton::k_InvalidBoneIdx) {
+                reads[j][parents[node]] = 1;
+            }
+            const uint32_t begin = order_pos[node];
+            for (uint32_t pos = begin; pos < subtree_end[begin]; ++pos) {
+                writes[j][order[pos]] = 1;
+            }
+        }
+    }
+
+    // ÕWu{[ǂݏ邩AÕWuǂރ{[ȂA̎̒iɂ
+    auto conflicts = [&](uint32_t a, uint32_t b) {
+        for (uint32_t i = 0; i < bone_num; ++i) {
+            if ((writes[a][i] && (reads[b][i] || writes[b][i])) || (writes[b][i] && reads[a][i])) {
+                return true;
+            }
+        }
+        return false;
+    };
+    std::vector<uint32_t> waves(job_num, 0);
+    uint32_t wave_num = 0;
+    for (uint32_t b = 0; b < job_num; ++b) {
+        for (uint32_t a = 0; a < b; ++a) {
+            if (waves[a] >= waves[b] && conflicts(a, b)) {
+                waves[b] = waves[a] + 1;
+            }
+        }
+        wave_num = std::max(wave_num, waves[b] + 1);
+    }
+
+    // ȉɕבւii̒ IKԍ̂܂܁j
+    std::vector<Job> jobs;
+    jobs.reserve(job_num);
+    m_WaveEnds.clear();
+    for (uint32_t wave = 0; wave < wave_num; ++wave) {
+        for (uint32_t j = 0; j < job_num; ++j) {
+            if (waves[j] == wave) {
+                jobs.push_back(m_Jobs[j]);
+            }
+        }
+        m_WaveEnds.push_back(static_cast<uint32_t>(jobs.size()));
+    }
+    m_Jobs = std::move(jobs);
+}
+
+IKSolver::SolveFunc IKSolver::SelectSolveFunc(uint32_t node_num, bool knee)
+{
+    switch (node_num) {
+    case 1:     // Ԃ̃{[1̎LookAt
+        return &IKSolver::SolveLookAt;
+    case 2:     // Ԃ̃{[2̎͗]藝IK
+        return knee ? &IKSolver::SolveCosine<true> : &IKSolver::SolveCosine<false>;
+    case 3:
+        return &IKSolver::SolveCCD<3>;
+    case 4:
+        return &IKSolver::SolveCCD<4>;
+    case 5:
+        return &IKSolver::SolveCCD<5>;
+    case 6:
+        return &IKSolver::SolveCCD<6>;
+    case 7:
+        return &IKSolver::SolveCCD<7>;
+    case 8:
+        return &IKSolver::SolveCCD<8>;
+    default:
+        static_assert(k_MaxFixedChainLength == 8, "SelectSolveFunc must cover every fixed chain length");
+        return &IKSolver::SolveCCD<0>;
+    }
+}
+
+uint32_t IKSolver::IKNum() const
+{
+    return m_IKNum;
+}
+
+uint32_t IKSolver::WaveNum() const
+{
+    return static_cast<uint32_t>(m_WaveEnds.size());
+}
+
+void IKSolver::SetThreadPool(ThreadPool* pool)
+{
+    m_Pool = pool;
+}
+
+bool IKSolver::SetEnabled(const IKEnableTimeline::Word* enabled)
+{
+    if (std::equal(m_Enabled.begin(), m_Enabled.end(), enabled)) {
+        return false;
+    }
+    std::copy_n(enabled, m_Enabled.size(), m_Enabled.begin());
+    return true;
+}
+
+void IKSolver::Solve(SkeletonPose* pose)
+{
+    // OIǨʂ̂ĂĂAAj[V̎p̏ŉ
+    for (uint16_t bone_idx : m_ChainBones) {
+        pose->RestoreSource(bone_idx);
+    }
+    if (!m_ChainBones.empty()) {
+        pose->MarkChanged();
+    }
+    pose->UpdateWorld();
+
+    uint32_t begin = 0;
+    for (uint32_t end : m_WaveEnds) {
+        if (m_Pool != nullptr && end - begin >= 2) {
+            SolveWave(begin, end, pose);
+        }
+        else {
+            for (uint32_t j = begin; j < end; ++j) {
+                SolveJob(m_Jobs[j], pose);
+            }
+        }
+        // Wu̓{[̈󂵂tȂ̂ŁAiIĂ炱̃Xbhł܂Ƃ߂ĕt
+        for (uint32_t j = begin; j < end; ++j) {
+            if (m_Stats[m_Jobs[j].IKIdx].Solved) {
+                pose->MarkChanged();
+                break;
+            }
+        }
+        begin = end;
+    }
+}
+
+void IKSolver::SolveWave(uint32_t begin, uint32_t end, SkeletonPose* pose)
+{
+    m_Pool->ParallelFor(end - begin, [this, begin, pose](uint32_t i) { SolveJob(m_Jobs[begin + i], pose); });
+}
+
+void IKSolver::SolveJob(const Job& job, SkeletonPose* pose)
+{
+    IKChainStats& stats = m_Stats[job.IKIdx];
+    stats.Solved = false;
+    stats.WarmStarted = false;
+    stats.Iterations = 0;
+
+    // OFFȂAIK͏ȂBONɂȂƂ͑Ỏn߂Ȃ
+    if (!IKEnableTimeline::IsEnabled(m_Enabled.data(), job.IKIdx)) {
+        m_WarmValid[job.IKIdx] = 0;
+        return;
+    }
+
+    (this->*job.Solve)(job, pose, &stats);
+
+    stats.Solved = true;
+    stats.Error = Distance(pose->WorldPosition(job.EndBone), pose->WorldPosition(job.IKBone));
+    ++stats.TotalSolves;
+    stats.TotalIterations += stats.Iterations;
+    stats.MaxError = std::max(stats.MaxError, stats.Error);
+}
+
+void IKSolver::ResetWarmStart()
+{
+    std::fill(m_WarmValid.begin(), m_WarmValid.end(), 0);
+}
+
+const std::vector<IKChainStats>& IKSolver::GetStats() const
+{
+    return m_Stats;
+}
+
+void IKSolver::ResetStats()
+{
+    for (auto& stats : m_Stats) {
+        stats.TotalSolves = 0;
+        stats.TotalIterations = 0;
+        stats.MaxError = 0.0f;
+    }
+}
+
+DirectX::XMVECTOR IKSolver::RotationBetween(DirectX::FXMVECTOR from, DirectX::FXMVECTOR to, float max_angle)
+{
+    const DirectX::XMVECTOR from_n = DirectX::XMVector3Normalize(from);
+    const DirectX::XMVECTOR to_n = DirectX::XMVector3Normalize(to);
+    const float angle = std::min(DirectX::XMVectorGetX(DirectX::XMVector3AngleBetweenNormals(from_n, to_n)), max_angle);
+    if (angle <= 0.0f) {
+        return DirectX::XMQuaternionIdentity();
+    }
+
+    DirectX::XMVECTOR axis = DirectX::XMVector3Cross(from_n, to_n);
+    if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(axis)) < 1.0e-12f) {
+        // ^tĂꍇ́AKȎŉ
+        axis = DirectX::XMVector3Cross(from_n, DirectX::XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f));
+        if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(axis)) < 1.0e-12f) {
+            axis = DirectX::XMVector3Cross(from_n, DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        }
+    }
+    return DirectX::XMQuaternionRotationAxis(axis, angle);
+}
+
+float IKSolver::Distance(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b)
+{
+    return DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(a, b)));
+}
+
+void IKSolver::SolveLookAt(const Job& job, SkeletonPose* pose, IKChainStats* stats)
+{
+    // Ԃ̃{[1Ȃ̂ŁÃ{[疖[ւ̃xNgAIK{[֌
+    const uint16_t root = m_Nodes[job.NodeBegin];
+    const DirectX::XMVECTOR root_pos = pose->WorldPosition(root);
+    const DirectX::XMVECTOR end_pos = pose->WorldPosition(job.EndBone);
+    const DirectX::XMVECTOR target_pos = pose->WorldPosition(job.IKBone);
+
+    pose->RotateWorld(
+        root,
+        RotationBetween(DirectX::XMVectorSubtract(end_pos, root_pos), DirectX::XMVectorSubtract(target_pos, root_pos), DirectX::XM_PI)
+    );
+    stats->Iterations = 1;
+}
+
+template <bool Knee>
+void IKSolver::SolveCosine(const Job& job, SkeletonPose* pose, IKChainStats* stats)
+{
+    // IK`F[͖[L^Ă̂ŁA1[gɋ߂
+    const uint16_t root = m_Nodes[job.NodeBegin + 1];
+    const uint16_t middle = m_Nodes[job.NodeBegin];
+    stats->Iterations = 1;
+
+    const DirectX::XMVECTOR root_pos = pose->WorldPosition(root);
+    const DirectX::XMVECTOR middle_pos = pose->WorldPosition(middle);
+    const DirectX::XMVECTOR end_pos = pose->WorldPosition(job.EndBone);
+    const DirectX::XMVECTOR target_pos = pose->WorldPosition(job.IKBone);
+
+    const DirectX::XMVECTOR to_root = DirectX::XMVectorSubtract(root_pos, middle_pos);
+    const DirectX::XMVECTOR to_end = DirectX::XMVectorSubtract(end_pos, middle_pos);
+    const float upper_len = DirectX::XMVectorGetX(DirectX::XMVector3Length(to_root));
+    const float lower_len = DirectX::XMVectorGetX(DirectX::XMVector3Length(to_end));
+    if (upper_len < k_Epsilon || lower_len < k_Epsilon) {
+        // ǂꂩӂ0ɋ߂̂Ńf[^BȂB
+        return;
+    }
+
+    // [g^[Qbg܂ł̋A͈͂͂Ɏ߂
+    const float min_len = std::abs(upper_len - lower_len) + k_Epsilon;
+    const float max_len = upper_len + lower_len - k_Epsilon;
+    const float target_len = std::clamp(
+        DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(target_pos, root_pos))),
+        std::min(min_len, max_len),
+        max_len
+    );
+
+    // ]藝ŒԂ̓p߁A̓pƂ̍ԂȂ
+    const float cos_angle = (upper_len * upper_len + lower_len * lower_len - target_len * target_len) / (2.0f * upper_len * lower_len);
+    const float angle = std::acos(std::clamp(cos_angle, -1.0f, 1.0f));
+    const float current_angle = DirectX::XMVectorGetX(
+        DirectX::XMVector3AngleBetweenNormals(DirectX::XMVector3Normalize(to_root), DirectX::XMVector3Normalize(to_end))
+    );
+
+    // Ȃ鎲BЂ͎XłȂBȊO͍ȂĂ镽ʂ̖@i܂Ȃ烋[gXj
+    // @ n = ([g) x ([) ܂̐̉]͓pL
+    const DirectX::XMVECTOR x_axis = DirectX::XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+    DirectX::XMVECTOR axis;
+    if constexpr (Knee) {
+        axis = DirectX::XMVector3Rotate(x_axis, pose->WorldRotation(middle));
+    }
+    else {
+        axis = DirectX::XMVector3Cross(to_root, to_end);
+        if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(axis)) < 1.0e-12f) {
+            axis = DirectX::XMVector3Rotate(x_axis, pose->WorldRotation(root));
+        }
+    }
+    pose->RotateWorld(middle, DirectX::XMQuaternionRotationAxis(axis, angle - current_angle));
+
+    // Ȃ̖[^[Qbg̕ɗ悤Ƀ[g
+    const DirectX::XMVECTOR bent_end_pos = pose->WorldPosition(job.EndBone);
+    pose->RotateWorld(
+        root,
+        RotationBetween(DirectX::XMVectorSubtract(bent_end_pos, root_pos), DirectX::XMVectorSubtract(target_pos, root_pos), DirectX::XM_PI)
+    );
+}
+
+template <uint32_t N>
+void IKSolver::SolveCCD(const Job& job, SkeletonPose* pose, IKChainStats* stats)
+{
+    // ꉻ{[Ȃ烋[v񐔂͒萔ɂȂAƗ̈̓X^bNɎ
+    const uint32_t node_num = (N != 0) ? N : job.NodeNum;
+    const uint16_t* nodes = &m_Nodes[job.NodeBegin];
+    DirectX::XMFLOAT4* warm_rotations = &m_WarmRotations[job.NodeBegin];
+    std::array<DirectX::XMVECTOR, (N != 0) ? N : 1> fixed_rotations;
+    std::array<DirectX::XMVECTOR, (N != 0) ? N : 1> fixed_positions;
+    DirectX::XMVECTOR* rotations = (N != 0) ? fixed_rotations.data() : &m_WorkRotations[job.NodeBegin];
+    DirectX::XMVECTOR* positions = (N != 0) ? fixed_positions.data() : &m_WorkPositions[job.NodeBegin];
+
+    const DirectX::XMVECTOR target_pos = pose->WorldPosition(job.IKBone);
+    float error = Distance(pose->WorldPosition(job.EndBone), target_pos);
+
+    // Õt[̉̂ق[^[Qbgɋ߂΁An߂
+    if (m_WarmValid[job.IKIdx] && error > k_Epsilon) {
+        for (uint32_t i = 0; i < node_num; ++i) {
+            pose->SetLocalRotation(nodes[i], DirectX::XMLoadFloat4(&warm_rotations[i]));
+        }
+        // ̃WuƓɉĂ邱Ƃ̂ŁA`F[̕؂vZi[gj
+        for (uint32_t i = node_num; i > 0; --i) {
+            pose->UpdateWorld(&nodes[i - 1], 1);
+        }
+
+        const float warm_error = Distance(pose->WorldPosition(job.EndBone), target_pos);
+        if (warm_error < error) {
+            error = warm_error;
+            stats->WarmStarted = true;
+        }
+        else {
+            for (uint32_t i = 0; i < node_num; ++i) {
+                pose->RestoreSource(nodes[i]);
+            }
+            for (uint32_t i = node_num; i > 0; --i) {
+                pose->UpdateWorld(&nodes[i - 1], 1);
+            }
+        }
+    }
+
+    // `F[̃{[̃[h]EʒuƖ[̈ʒu茳Ɏĉ
+    for (uint32_t i = 0; i < node_num; ++i) {
+        rotations[i] = pose->WorldRotation(nodes[i]);
+        positions[i] = pose->WorldPosition(nodes[i]);
+    }
+    DirectX::XMVECTOR end_pos = pose->WorldPosition(job.EndBone);
+
+    uint32_t iterations = 0;
+    while (iterations < job.Iterations && error > k_Epsilon) {
+        ++iterations;
+
+        // ꂼ̃{[𖖒[炳̂ڂȂA
+        // pxɈȂ悤ɖ[^[Qbg֌悤ȂĂ
+        for (uint32_t j = 0; j < node_num; ++j) {
+            const DirectX::XMVECTOR center = positions[j];
+            const DirectX::XMVECTOR delta = RotationBetween(
+                DirectX::XMVectorSubtract(end_pos, center), DirectX::XMVectorSubtract(target_pos, center), job.Limit
+            );
+
+            // j 薖[̃{[Ɩ[Aj ̈ʒu𒆐SɈꏏɉ
+            rotations[j] = DirectX::XMQuaternionNormalize(DirectX::XMQuaternionMultiply(rotations[j], delta));
+            for (uint32_t i = 0; i < j; ++i) {
+                rotations[i] = DirectX::XMQuaternionNormalize(DirectX::XMQuaternionMultiply(rotations[i], delta));
+                positions[i] = DirectX::XMVectorAdd(
+                    DirectX::XMVector3Rotate(DirectX::XMVectorSubtract(positions[i], center), delta), center
+                );
+            }
+            end_pos = DirectX::XMVectorAdd(DirectX::XMVector3Rotate(DirectX::XMVectorSubtract(end_pos, center), delta), center);
+        }
+
+        // 덷قƂǌȂȂAs񐔂cĂĂł؂
+        const float new_error = Distance(end_pos, target_pos);
+        const bool stalled = error - new_error < error * k_MinImprovement;
+        error = new_error;
+        if (stalled) {
+            break;
+        }
+    }
+    stats->Iterations = iterations;
+
+    // [g珇ɁA߂[h]ɂȂ悤pɏ߂
+    if (iterations > 0) {
+        for (uint32_t j = node_num; j > 0; --j) {
+            const uint16_t node = nodes[j - 1];
+            pose->RotateWorld(
+                node,
+                DirectX::XMQuaternionMultiply(DirectX::XMQuaternionInverse(pose->WorldRotation(node)), rotations[j - 1])
+            );
+        }
+    }
+
+    for (uint32_t i = 0; i < node_num; ++i) {
+        DirectX::XMStoreFloat4(&warm_rotations[i], pose->LocalRotation(nodes[i]));
+    }
+    m_WarmValid[job.IKIdx] = 1;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "VMD.hpp"
+
+class PMDData;
+class SkeletonPose;
+class ThreadPool;
+
+// IK̉ʁi`[jOpj
+struct IKChainStats
+{
+    uint16_t IKBone = 0;            // IK{[ԍiO PMDData::GetBoneName ňj
+    uint32_t NodeNum = 0;           // Ԃ̃{[
+    bool     Solved = false;        // O Solve ŉiOFF Ȃ falsej
+    bool     WarmStarted = false;   // Ỏn߂iCCD ̂݁j
+    uint32_t Iterations = 0;        // gs񐔁iCCD ȊO 1j
+    float    Error = 0.0f;          // ̖[IK{[̋
+
+    // ResetStats ̗݌v
+    uint64_t TotalSolves = 0;
+    uint64_t TotalIterations = 0;
+    float    MaxError = 0.0f;
+};
+
+// fIKA{[̃[hpi]Eړj̏ŉNX
+//
+// IK ̃`F[͓ǂݍݎɁA{[ԍ1{̔zɋl߂Wu̗ɂĂB
+// Wuɂ̓`F[̌`iԂ̃{[EЂjɍ킹ēꉻ֐|C^Ŏ̂ŁA
+// t[̓`F[̌`ŕ򂹂AWuɎs邾ɂȂB
+// Ԃ̃{[ 1 Ȃ킹邾A2 Ȃ]藝Aȏ CCD ŉB
+// CCD ̓{[ k_MaxFixedChainLength ܂Ń{[ɓꉻAƗ̈̓X^bŇŒ蒷zɎB
+//
+// t[ SkeletonPose ̃[hp{[ʒu߁A`F[̃{[݈ʒu𒆐Sɉ]B
+// ]{[̕؂͂̏ŌvẐŁAIK͑OIǨʂ̏ŉB
+//
+// ǂݍݎɁAWuɓǂރ{[iIK{[E[EԂ̃{[Ƃ̐ej
+// {[iԂ̃{[̕؁j𒲂ׁAÕWuƏdȂWu͎̒iɉ񂷁B
+// ĩWu݂͌Ɋ֌WȂ̂ŁAXbhv[ΓɉB
+// i̒̏Ԃ͓ւ邪A֌WWȕԂ IK ԍ̂܂܂Ȃ̂ŁAʂ͏ɉꍇƓɂȂB
+//
+// CCD ̓`F[̃{[Ɩ[̃[h]Eʒu茳ɎăNH[^jIŉ񂵁A
+// IĂp1񂾂߂BÕt[̉i`F[̃[J]joĂA
+// Aj[V̎pn߂薖[^[Qbgɋ߂΂n߂B
+// 1̎sŌ덷قƂǌȂȂAs񐔂cĂĂł؂B
+class IKSolver
+{
+public:
+
+    static constexpr float k_Epsilon = 0.0005f;     // [^[Qbgɂȏ߂ΉI
+    static constexpr float k_MinImprovement = 1.0e-3f;  // 1̎sŌ덷̊ȂΑł؂
+    static constexpr uint32_t k_MaxFixedChainLength = 8;    // CCD {[ɓꉻő̃{[
+
+public:
+
+    IKSolver();
+
+    // @brief fIKWu̗ɂAɉWuiɂ܂Ƃ߂
+    void Bind(const PMDData& pmd);
+
+    uint32_t IKNum() const;
+    uint32_t WaveNum() const;       // i̐iׂďɉȂLIK̐Ɠj
+
+    // @brief ĩWûɎgXbhv[ݒ肷inullptr ȂĂяoXbhŏɉj
+    //        ĂяoXbĥŁAv[̃^XNŖ܂ĂĂ҂Ȃ
+    void SetThreadPool(ThreadPool* pool);
+
+    // @brief LIKݒ肷
+    // @param enabled IKԍ̃rbgiIKEnableTimeline::Enabled ̌ʁj
+    // @retval O񂩂ς
+    bool SetEnabled(const IKEnableTimeline::Word* enabled);
+
+    // @brief LIKɉ
+    //        `F[̃{[͉OɃAj[V̎pɖ߂iCCD ͑Ỏ̂ق߂΂n߂j
+    // @param pose pi[hp͌vZς݂łȂĂ悢j
+    void Solve(SkeletonPose* pose);
+
+    // @brief Õt[̉̂ĂiV[NEĂ݂ȂǁAÕt[ƑȂƂj
+    void ResetWarmStart();
+
+    // @brief IKԍ̌
+    const std::vector<IKChainStats>& GetStats() const;
+    void ResetStats();
+
+private:
+
+    struct Job;
+    using SolveFunc = void (IKSolver::*)(const Job& job, SkeletonPose* pose, IKChainStats* stats);
+
+    // IK 1̏i͈͊Õ{[wIK̓WuɂȂj
+    struct Job
+    {
+        SolveFunc Solve;        // `F[̌`ɍ킹ēꉻ
+        uint16_t  IKIdx;        // IKԍiLrbgEʂ̓Yj
+        uint16_t  IKBone;       // IK{[i[߂ÂڕWj
+        uint16_t  EndBone;      // [{[
+        uint16_t  Iterations;   // s
+        float     Limit;        // 1񂠂̉]iWAj
+        uint32_t  NodeBegin;    // Ԃ̃{[i[j m_Nodes ł̐擪
+        uint32_t  NodeNum;      // Ԃ̃{[
+    };
+
+    static SolveFunc SelectSolveFunc(uint32_t node_num, bool knee);
+    void BuildWaves(const PMDData& pmd);
+
+    void SolveJob(const Job& job, SkeletonPose* pose);
+    void SolveWave(uint32_t begin, uint32_t end, SkeletonPose* pose);
+
+    static DirectX::XMVECTOR RotationBetween(DirectX::FXMVECTOR from, DirectX::FXMVECTOR to, float max_angle);
+    static float Distance(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b);
+
+    void SolveLookAt(const Job& job, SkeletonPose* pose, IKChainStats* stats);
+    template <bool Knee>
+    void SolveCosine(const Job& job, SkeletonPose* pose, IKChainStats* stats);
+    template <uint32_t N>   // N  0 Ȃ{[ job.NodeNumiƗ̈̓o[̔zj
+    void SolveCCD(const Job& job, SkeletonPose* pose, IKChainStats* stats);
+
+    std::vector<Job>                  m_Jobs;         // iȉAi̒ IKԍj
+    std::vector<uint32_t>             m_WaveEnds;     // i m_Jobs ̏I
+    ThreadPool*                       m_Pool;
+    std::vector<uint16_t>             m_Nodes;        // SWůԂ̃{[
+    std::vector<uint16_t>             m_ChainBones;   // ꂩIK̃`F[ɓĂ{[
+    std::vector<IKEnableTimeline::Word> m_Enabled;    // LIK̃rbg
+    std::vector<IKChainStats>         m_Stats;        // IKԍ
+    uint32_t                          m_IKNum;
+
+    // CCD ̑Õt[̉im_Nodes Ɠт̃[J]jƁAꂪg邩iIKԍj
+    std::vector<DirectX::XMFLOAT4>    m_WarmRotations;
+    std::vector<uint8_t>              m_WarmValid;
+
+    // k_MaxFixedChainLength 蒷 CCD ̍Ɨ̈im_Nodes Ɠт̃[h]Eʒuj
+    std::vector<DirectX::XMVECTOR>    m_WorkRotations;
+    std::vector<DirectX::XMVECTOR>    m_WorkPositions;
+};
@@ -2,6 +2,8 @@
 #include "IndexBuffer.hpp"
 #include "AppManager.hpp"
 
+#include <vector>
+
 IndexBuffer::IndexBuffer()
     :
     m_IndicesBuff(nullptr),
@@ -77,7 +79,17 @@ bool IndexBuffer::CreateIndexBuffer(const uint16_t* indices, size_t count)
 bool IndexBuffer::CreateIndexBuffer(const PMDData& pmd)
 {
     const uint16_t* ptr = reinterpret_cast<const uint16_t*>(pmd.GetIndexData());
-    return this->CreateIndexBuffer(ptr, pmd.IndexNum());
+    if (pmd.LodIndexNum() == 0) {
+        return this->CreateIndexBuffer(ptr, pmd.IndexNum());
+    }
+
+    // LOD̃CfbNX͌̃CfbNX̌ɑĒu
+    const uint16_t* lod_ptr = reinterpret_cast<const uint16_t*>(pmd.GetLodIndexData());
+    std::vector<uint16_t> indices;
+    indices.reserve(static_cast<size_t>(pmd.IndexNum()) + pmd.LodIndexNum());
+    indices.insert(indices.end(), ptr, ptr + pmd.IndexNum());
+    indices.insert(indices.end(), lod_ptr, lod_ptr + pmd.LodIndexNum());
+    return this->CreateIndexBuffer(indices.data(), indices.size());
 }
 
 D3D12_INDEX_BUFFER_VIEW IndexBuffer::GetIndexBufferView() const
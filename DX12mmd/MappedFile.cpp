@@ -0,0 +1,84 @@
+#include "MappedFile.hpp"
+
+#include "windows.h"
+
+MappedFile::MappedFile()
+    :
+    m_File(INVALID_HANDLE_VALUE),
+    m_Mapping(nullptr),
+    m_View(nullptr),
+    m_Size(0)
+{}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::filesystem::path& filename)
+{
+    Close();
+
+    m_File = ::CreateFileW(
+        filename.c_str(),
+        GENERIC_READ,
+        // JĂԂALbV rename Œu悤폜̋L
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (m_File == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size{};
+    if (!::GetFileSizeEx(m_File, &file_size) || file_size.QuadPart == 0) {
+        // TCY0̃t@C̓}bvłȂ
+        Close();
+        return false;
+    }
+    m_Size = static_cast<uint64_t>(file_size.QuadPart);
+
+    m_Mapping = ::CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping == nullptr) {
+        Close();
+        return false;
+    }
+
+    m_View = reinterpret_cast<const uint8_t*>(::MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_View == nullptr) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_View) {
+        ::UnmapViewOfFile(m_View);
+        m_View = nullptr;
+    }
+    if (m_Mapping) {
+        ::CloseHandle(m_Mapping);
+        m_Mapping = nullptr;
+    }
+    if (m_File != INVALID_HANDLE_VALUE) {
+        ::CloseHandle(m_File);
+        m_File = INVALID_HANDLE_VALUE;
+    }
+    m_Size = 0;
+}
+
+const uint8_t* MappedFile::Data() const
+{
+    return m_View;
+}
+
+uint64_t MappedFile::Size() const
+{
+    return m_Size;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <filesystem>
+
+// ǂݍݐpŃt@CɃ}bvNX
+// }bv̓NXj܂ŗL
+class MappedFile
+{
+public:
+
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::filesystem::path& filename);
+    void Close();
+
+    const uint8_t* Data() const;
+    uint64_t Size() const;
+
+private:
+
+    void*          m_File;          // t@Cnh
+    void*          m_Mapping;       // t@C}bsOnh
+    const uint8_t* m_View;          // }bv̐擪
+    uint64_t       m_Size;          // t@CTCY
+};
+using MappedFilePtr = std::shared_ptr<MappedFile>;
+
+// }bv̔zRs[ɎQƂ邽߂̃r[
+template <typename T>
+class DataView
+{
+public:
+
+    DataView()
+        : m_Data(nullptr), m_Count(0) {}
+    DataView(const T* data, size_t count)
+        : m_Data(data), m_Count(count) {}
+
+    const T* data() const { return m_Data; }
+    size_t size() const { return m_Count; }
+    bool empty() const { return m_Count == 0; }
+    const T* begin() const { return m_Data; }
+    const T* end() const { return m_Data + m_Count; }
+    const T& operator[](size_t idx) const { return m_Data[idx]; }
+
+private:
+
+    const T* m_Data;
+    size_t   m_Count;
+};
+
+// }bv擪珇ɓǂݐi߂NX
+// ͈͊OǂƂꍇ false / nullptr Ԃ
+class MappedFileReader
+{
+public:
+
+    MappedFileReader(const uint8_t* data, uint64_t size)
+        : m_Data(data), m_Size(size), m_Offset(0) {}
+
+    template <typename T>
+    bool Read(T* out)
+    {
+        if (Remaining() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(out, m_Data + m_Offset, sizeof(T));
+        m_Offset += sizeof(T);
+        return true;
+    }
+
+    // @brief count ̔zRs[ɎQƂicount  0 Ȃ̃r[Őj
+    // @retval ͈͊OȂ falseiout ͕ύXȂj
+    template <typename T>
+    bool View(size_t count, DataView<T>* out)
+    {
+        uint64_t size = static_cast<uint64_t>(sizeof(T)) * count;
+        if (Remaining() < size) {
+            return false;
+        }
+        const T* ptr = reinterpret_cast<const T*>(m_Data + m_Offset);
+        m_Offset += size;
+        *out = DataView<T>(ptr, count);
+        return true;
+    }
+
+    const uint8_t* Bytes(uint64_t size)
+    {
+        if (Remaining() < size) {
+            return nullptr;
+        }
+        const uint8_t* ptr = m_Data + m_Offset;
+        m_Offset += size;
+        return ptr;
+    }
+
+    bool Skip(uint64_t size)
+    {
+        return Bytes(size) != nullptr;
+    }
+
+    uint64_t Offset() const { return m_Offset; }
+    uint64_t Remaining() const { return m_Size - m_Offset; }
+
+private:
+
+    const uint8_t* m_Data;
+    uint64_t       m_Size;
+    uint64_t       m_Offset;
+};
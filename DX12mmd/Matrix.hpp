@@ -8,6 +8,9 @@ struct SceneMatrix
     DirectX::XMMATRIX World;        
     DirectX::XMMATRIX View;     // r[s
     DirectX::XMMATRIX Proj;     // vWFNVs
+    DirectX::XMFLOAT4 UVRange;  // k_UVpixy: ŏl, zw: j
+    DirectX::XMFLOAT4 LightColor;   // CgFiw ͖gpj
+    DirectX::XMFLOAT4 LightDir;     // ̌iw ͖gpj
     DirectX::XMFLOAT3 Eye;      // _W
 
     DirectX::XMMATRIX Bones[k_BoneMetricesNum];     // {[s
@@ -0,0 +1,339 @@
+#include "MeshCluster.hpp"
+#include "PMD.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace
+{
+    constexpr float k_MinConeDot = 0.1f;    // @JĂNX^̓R[Ŕ肵Ȃ
+
+    // 6ʂisxNgK clip = v * M Ȃ̂ M ̗񂩂j
+    void ExtractFrustumPlanes(const DirectX::XMMATRIX& m, DirectX::XMVECTOR* planes)
+    {
+        const DirectX::XMMATRIX t = DirectX::XMMatrixTranspose(m);
+        planes[0] = DirectX::XMVectorAdd(t.r[3], t.r[0]);          // 
+        planes[1] = DirectX::XMVectorSubtract(t.r[3], t.r[0]);     // E
+        planes[2] = DirectX::XMVectorAdd(t.r[3], t.r[1]);          // 
+        planes[3] = DirectX::XMVectorSubtract(t.r[3], t.r[1]);     // 
+        planes[4] = t.r[2];                                        // ߁iD3D  0 <= zj
+        planes[5] = DirectX::XMVectorSubtract(t.r[3], t.r[2]);     // 
+        for (int i = 0; i < 6; ++i) {
+            planes[i] = DirectX::XMPlaneNormalize(planes[i]);
+        }
+    }
+
+    // sɂg嗦̏
+    float MaxScale(const DirectX::XMMATRIX& m)
+    {
+        float scale_sq = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            scale_sq = std::max(scale_sq, DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(m.r[i])));
+        }
+        return std::sqrt(scale_sq);
+    }
+}
+
+MeshClusterSet::MeshClusterSet()
+    :
+    m_Clusters(),
+    m_ClusterBones(),
+    m_MaterialClusterBegin()
+{}
+
+bool MeshClusterSet::Build(
+    const uint16_t* indices,
+    uint32_t index_num,
+    const PMDVertex* vertices,
+    uint32_t vertex_num,
+    const std::vector<uint32_t>& material_index_nums,
+    const std::vector<float>* inflate
+)
+{
+    m_Clusters.clear();
+    m_ClusterBones.clear();
+    m_MaterialClusterBegin.clear();
+
+    if (inflate && inflate->size() < vertex_num) {
+        inflate = nullptr;
+    }
+
+    // _ɍŌɓo^NX^̔ԍANX^̒_𐔂
+    std::vector<uint32_t> stamp(vertex_num, std::numeric_limits<uint32_t>::max());
+    uint32_t stamp_id = 0;
+    uint32_t offset = 0;
+
+    for (size_t m = 0; m < material_index_nums.size(); ++m) {
+        m_MaterialClusterBegin.push_back(static_cast<uint32_t>(m_Clusters.size()));
+
+        const uint32_t end = offset + material_index_nums[m];
+        if (end > index_num) {
+            return false;
+        }
+
+        uint32_t cluster_begin = offset;
+        uint32_t cluster_vertex_num = 0;
+        uint32_t cluster_triangle_num = 0;
+        for (uint32_t i = offset; i + 3 <= end; i += 3) {
+            const uint16_t* tri = &indices[i];
+            if (tri[0] >= vertex_num || tri[1] >= vertex_num || tri[2] >= vertex_num) {
+                return false;
+            }
+
+            auto count_new_vertices = [&]() {
+                uint32_t num = 0;
+                for (int k = 0; k < 3; ++k) {
+                    bool duplicated = (k >= 1 && tri[k] == tri[0]) || (k == 2 && tri[2] == tri[1]);
+                    if (stamp[tri[k]] != stamp_id && !duplicated) {
+                        ++num;
+                    }
+                }
+                return num;
+            };
+
+            uint32_t new_vertex_num = count_new_vertices();
+            if (cluster_triangle_num == k_MaxTriangles || cluster_vertex_num + new_vertex_num > k_MaxVertices) {
+                AddCluster(cluster_begin, i - cluster_begin, static_cast<uint16_t>(m), indices, vertices, inflate);
+                ++stamp_id;
+                cluster_begin = i;
+                cluster_vertex_num = 0;
+                cluster_triangle_num = 0;
+                new_vertex_num = count_new_vertices();
+            }
+
+            for (int k = 0; k < 3; ++k) {
+                stamp[tri[k]] = stamp_id;
+            }
+            cluster_vertex_num += new_vertex_num;
+            ++cluster_triangle_num;
+        }
+        if (cluster_triangle_num > 0) {
+            AddCluster(cluster_begin, cluster_triangle_num * 3, static_cast<uint16_t>(m), indices, vertices, inflate);
+            ++stamp_id;
+        }
+
+        offset = end;
+    }
+    m_MaterialClusterBegin.push_back(static_cast<uint32_t>(m_Clusters.size()));
+
+    return true;
+}
+
+void MeshClusterSet::AddCluster(
+    uint32_t index_offset,
+    uint32_t index_num,
+    uint16_t material_idx,
+    const uint16_t* indices,
+    const PMDVertex* vertices,
+    const std::vector<float>* inflate
+)
+{
+    MeshCluster cluster{};
+    cluster.IndexOffset = index_offset;
+    cluster.IndexNum = index_num;
+    cluster.MaterialIdx = material_idx;
+
+    std::vector<uint16_t> unique_vertices(indices + index_offset, indices + index_offset + index_num);
+    std::sort(unique_vertices.begin(), unique_vertices.end());
+    unique_vertices.erase(std::unique(unique_vertices.begin(), unique_vertices.end()), unique_vertices.end());
+
+    // EiAABB̒Sԉ_܂Łj
+    DirectX::XMVECTOR aabb_min = DirectX::XMLoadFloat3(&vertices[unique_vertices[0]].Pos);
+    DirectX::XMVECTOR aabb_max = aabb_min;
+    for (uint16_t v : unique_vertices) {
+        DirectX::XMVECTOR pos = DirectX::XMLoadFloat3(&vertices[v].Pos);
+        aabb_min = DirectX::XMVectorMin(aabb_min, pos);
+        aabb_max = DirectX::XMVectorMax(aabb_max, pos);
+    }
+    DirectX::XMVECTOR center = DirectX::XMVectorScale(DirectX::XMVectorAdd(aabb_min, aabb_max), 0.5f);
+    float radius = 0.0f;
+    for (uint16_t v : unique_vertices) {
+        DirectX::XMVECTOR pos = DirectX::XMLoadFloat3(&vertices[v].Pos);
+        float dist = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(pos, center)));
+        radius = std::max(radius, dist + (inflate ? (*inflate)[v] : 0.0f));
+    }
+    DirectX::XMStoreFloat3(&cluster.Center, center);
+    cluster.Radius = radius;
+
+    // @R[iOp`̖ʖ@̕ςɂAԊJʖ@Ƃ̊px画lj
+    std::vector<DirectX::XMVECTOR> normals;
+    normals.reserve(index_num / 3);
+    DirectX::XMVECTOR normal_sum = DirectX::XMVectorZero();
+    for (uint32_t i = index_offset; i + 3 <= index_offset + index_num; i += 3) {
+        DirectX::XMVECTOR p0 = DirectX::XMLoadFloat3(&vertices[indices[i + 0]].Pos);
+        DirectX::XMVECTOR p1 = DirectX::XMLoadFloat3(&vertices[indices[i + 1]].Pos);
+        DirectX::XMVECTOR p2 = DirectX::XMLoadFloat3(&vertices[indices[i + 2]].Pos);
+        DirectX::XMVECTOR n = DirectX::XMVector3Cross(DirectX::XMVectorSubtract(p1, p0), DirectX::XMVectorSubtract(p2, p0));
+        if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(n)) <= 0.0f) {
+            continue;   // kނOp`
+        }
+        n = DirectX::XMVector3Normalize(n);
+        normals.push_back(n);
+        normal_sum = DirectX::XMVectorAdd(normal_sum, n);
+    }
+
+    cluster.ConeAxis = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+    cluster.ConeCutoff = 1.0f;
+    if (!normals.empty() && DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(normal_sum)) > 1e-12f) {
+        DirectX::XMVECTOR axis = DirectX::XMVector3Normalize(normal_sum);
+        float min_dot = 1.0f;
+        for (const auto& n : normals) {
+            min_dot = std::min(min_dot, DirectX::XMVectorGetX(DirectX::XMVector3Dot(axis, n)));
+        }
+        DirectX::XMStoreFloat3(&cluster.ConeAxis, axis);
+        if (min_dot > k_MinConeDot) {
+            cluster.ConeCutoff = std::sqrt(1.0f - min_dot * min_dot);
+        }
+    }
+
+    // e{[EFCg̍v傫ɕׂ
+    std::vector<std::pair<uint16_t, float>> bone_weights;
+    auto add_weight = [&bone_weights](uint16_t bone, float weight) {
+        if (weight <= 0.0f) {
+            return;
+        }
+        auto itr = std::find_if(bone_weights.begin(), bone_weights.end(), [bone](const auto& bw) { return bw.first == bone; });
+        if (itr == bone_weights.end()) {
+            bone_weights.emplace_back(bone, weight);
+        }
+        else {
+            itr->second += weight;
+        }
+    };
+    for (uint16_t v : unique_vertices) {
+        const float weight = static_cast<float>(vertices[v].BoneWeight) / 100.0f;
+        add_weight(vertices[v].BoneNo[0], weight);
+        add_weight(vertices[v].BoneNo[1], 1.0f - weight);
+    }
+    std::stable_sort(bone_weights.begin(), bone_weights.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+
+    cluster.BoneBegin = static_cast<uint32_t>(m_ClusterBones.size());
+    cluster.BoneNum = static_cast<uint16_t>(bone_weights.size());
+    for (const auto& bw : bone_weights) {
+        m_ClusterBones.push_back(bw.first);
+    }
+
+    m_Clusters.push_back(cluster);
+}
+
+uint32_t MeshClusterSet::ClusterNum() const
+{
+    return static_cast<uint32_t>(m_Clusters.size());
+}
+
+const MeshCluster& MeshClusterSet::GetCluster(uint32_t idx) const
+{
+    return m_Clusters[idx];
+}
+
+const uint16_t* MeshClusterSet::GetClusterBones(const MeshCluster& cluster) const
+{
+    return m_ClusterBones.data() + cluster.BoneBegin;
+}
+
+uint32_t MeshClusterSet::MaterialNum() const
+{
+    return m_MaterialClusterBegin.empty() ? 0 : static_cast<uint32_t>(m_MaterialClusterBegin.size() - 1);
+}
+
+uint32_t MeshClusterSet::Cull(
+    const DirectX::XMMATRIX& world_view_proj,
+    const DirectX::XMMATRIX* bones,
+    uint32_t bone_num,
+    std::vector<DrawRange>* ranges,
+    std::vector<uint32_t>* material_range_begin,
+    DirectX::XMFLOAT4* bounds
+) const
+{
+    ranges->clear();
+    material_range_begin->clear();
+
+    // fŜ͈̔͂͊eNX^̋AABB
+    DirectX::XMVECTOR bounds_min = DirectX::XMVectorReplicate(std::numeric_limits<float>::max());
+    DirectX::XMVECTOR bounds_max = DirectX::XMVectorReplicate(-std::numeric_limits<float>::max());
+
+    DirectX::XMVECTOR planes[6];
+    ExtractFrustumPlanes(world_view_proj, planes);
+
+    uint32_t visible_num = 0;
+    for (uint32_t m = 0; m < MaterialNum(); ++m) {
+        const size_t range_begin = ranges->size();
+        material_range_begin->push_back(static_cast<uint32_t>(range_begin));
+
+        for (uint32_t c = m_MaterialClusterBegin[m]; c < m_MaterialClusterBegin[m + 1]; ++c) {
+            const MeshCluster& cluster = m_Clusters[c];
+
+            // e{[œEAԉȇ傫{[œS
+            bool visible = false;
+            DirectX::XMVECTOR rest_center = DirectX::XMLoadFloat3(&cluster.Center);
+            DirectX::XMVECTOR center = rest_center;
+            float radius = cluster.Radius;
+            const uint16_t* cluster_bones = GetClusterBones(cluster);
+            for (uint16_t b = 0; b < cluster.BoneNum; ++b) {
+                if (cluster_bones[b] >= bone_num) {
+                    visible = true;     // s̖{[gĂꍇ͔肵Ȃ
+                    break;
+                }
+                const DirectX::XMMATRIX& bone = bones[cluster_bones[b]];
+                DirectX::XMVECTOR moved = DirectX::XMVector3Transform(rest_center, bone);
+                float moved_radius = cluster.Radius * MaxScale(bone);
+                if (b == 0) {
+                    center = moved;
+                    radius = moved_radius;
+                }
+                else {
+                    float dist = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(moved, center)));
+                    radius = std::max(radius, dist + moved_radius);
+                }
+            }
+
+            if (bounds) {
+                const DirectX::XMVECTOR extent = DirectX::XMVectorReplicate(radius);
+                bounds_min = DirectX::XMVectorMin(bounds_min, DirectX::XMVectorSubtract(center, extent));
+                bounds_max = DirectX::XMVectorMax(bounds_max, DirectX::XMVectorAdd(center, extent));
+            }
+
+            if (!visible) {
+                visible = true;
+                for (const auto& plane : planes) {
+                    if (DirectX::XMVectorGetX(DirectX::XMPlaneDotCoord(plane, center)) < -radius) {
+                        visible = false;
+                        break;
+                    }
+                }
+            }
+            if (!visible) {
+                continue;
+            }
+            ++visible_num;
+
+            // O͈̔͂ɑĂ΂܂Ƃ߂
+            if (ranges->size() > range_begin) {
+                DrawRange& last = ranges->back();
+                if (last.IndexOffset + last.IndexNum == cluster.IndexOffset) {
+                    last.IndexNum += cluster.IndexNum;
+                    continue;
+                }
+            }
+            ranges->push_back(DrawRange{ cluster.IndexOffset, cluster.IndexNum });
+        }
+    }
+    material_range_begin->push_back(static_cast<uint32_t>(ranges->size()));
+
+    if (bounds) {
+        if (m_Clusters.empty()) {
+            *bounds = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+        else {
+            DirectX::XMVECTOR center = DirectX::XMVectorScale(DirectX::XMVectorAdd(bounds_min, bounds_max), 0.5f);
+            DirectX::XMVECTOR half = DirectX::XMVectorScale(DirectX::XMVectorSubtract(bounds_max, bounds_min), 0.5f);
+            DirectX::XMStoreFloat4(bounds, DirectX::XMVectorSetW(center, DirectX::XMVectorGetX(DirectX::XMVector3Length(half))));
+        }
+    }
+
+    return visible_num;
+}
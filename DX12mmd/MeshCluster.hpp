@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+struct PMDVertex;
+
+// }eA̎Op`ȉiNX^jɕ
+// CfbNXobt@ŘA͈͂ŵŁAȃNX^͈͂͂܂Ƃ߂ĕ`ł
+struct MeshCluster
+{
+    uint32_t IndexOffset;               // CfbNXobt@̐擪
+    uint32_t IndexNum;                  // CfbNX
+    DirectX::XMFLOAT3 Center;           // Ei{pE\̍őړʍ݁j
+    float    Radius;
+    DirectX::XMFLOAT3 ConeAxis;         // @R[̎
+    float    ConeCutoff;                // @R[̔li1 ȂR[ɂJOsj
+    uint32_t BoneBegin;                 // NX^̃{[ԍXg̐擪iȇ傫j
+    uint16_t BoneNum;                   // e{[
+    uint16_t MaterialIdx;               // }eA
+};
+
+// ǂݍݎɃ}eA̎Op`NX^ɕAt[JONX
+//
+// NX^̓CfbNX̕яi_LbVœK̏ԁĵ܂ܐ擪l߂č̂ŁA
+// CfbNX̕בւ͍sȂB
+// XLjO̒_́Aee{[sœE̓ʕ̒Ɏ܂̂ŁA
+// NX^ɉeS{[ŋE𓮂AދŔ肷B
+//
+// @R[́iJʒu eye ݂āj
+//   dot(Center - eye, ConeAxis) >= ConeCutoff * length(Center - eye) + Radius
+// 𖞂ƂNX^ŜɂȂB
+// {pł̒lŁÃ݂pCvC͗ʕ`Ȃ̂Ŕɂ͎gĂȂB
+class MeshClusterSet
+{
+public:
+
+    static constexpr uint32_t k_MaxVertices = 64;       // 1NX^̍ő咸_
+    static constexpr uint32_t k_MaxTriangles = 124;     // 1NX^̍őOp`
+
+    // `悷CfbNX͈̔
+    struct DrawRange
+    {
+        uint32_t IndexOffset;
+        uint32_t IndexNum;
+    };
+
+public:
+
+    MeshClusterSet();
+
+    // @brief NX^쐬
+    // @param indices     fŜ̃CfbNX
+    // @param index_num   CfbNX
+    // @param vertices    _f[^
+    // @param vertex_num  _
+    // @param material_index_nums }eÃCfbNXi擪珇ɕł́j
+    // @param inflate     _̋E̊gʁi\̈ړʁBsvȂ nullptrj
+    // @retval CfbNX͈͊Ȍꍇ false
+    bool Build(
+        const uint16_t* indices,
+        uint32_t index_num,
+        const PMDVertex* vertices,
+        uint32_t vertex_num,
+        const std::vector<uint32_t>& material_index_nums,
+        const std::vector<float>* inflate = nullptr
+    );
+
+    uint32_t ClusterNum() const;
+    const MeshCluster& GetCluster(uint32_t idx) const;
+    const uint16_t* GetClusterBones(const MeshCluster& cluster) const;
+    uint32_t MaterialNum() const;
+
+    // @brief ̊OɂNX^`͈͂
+    // @param world_view_proj [hEr[EvWFNVs
+    // @param bones       XLjOp̃{[s
+    // @param bone_num    {[s̐
+    // @param ranges      `͈́i}eABAČNX^1ɂ܂Ƃ߂j
+    // @param material_range_begin }eA ranges ̐擪iMaterialNum + 1 j
+    // @param bounds      ݂̎pŃfŜދixyz: S, w: aBsvȂ nullptrj
+    // @retval ĂNX^
+    uint32_t Cull(
+        const DirectX::XMMATRIX& world_view_proj,
+        const DirectX::XMMATRIX* bones,
+        uint32_t bone_num,
+        std::vector<DrawRange>* ranges,
+        std::vector<uint32_t>* material_range_begin,
+        DirectX::XMFLOAT4* bounds = nullptr
+    ) const;
+
+private:
+
+    void AddCluster(
+        uint32_t index_offset,
+        uint32_t index_num,
+        uint16_t material_idx,
+        const uint16_t* indices,
+        const PMDVertex* vertices,
+        const std::vector<float>* inflate
+    );
+
+    std::vector<MeshCluster> m_Clusters;
+    std::vector<uint16_t>    m_ClusterBones;            // NX^̃{[ԍiȇ傫j
+    std::vector<uint32_t>    m_MaterialClusterBegin;    // }eÃNX^̐擪i}eA + 1 j
+};
@@ -0,0 +1,240 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // XRAvZp̒萔iForsyth ̘_̒lj
+    constexpr float k_CacheDecayPower = 1.5f;
+    constexpr float k_LastTriScore = 0.75f;
+    constexpr float k_ValenceBoostScale = 2.0f;
+    constexpr float k_ValenceBoostPower = 0.5f;
+
+    // @param cache_pos       LbV̈ʒuiLbVɖ -1j
+    // @param remaining_tris  ܂`ĂȂA̒_gOp`̐
+    float VertexScore(int cache_pos, uint32_t remaining_tris)
+    {
+        if (remaining_tris == 0) {
+            // gȂ_
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cache_pos >= 0) {
+            if (cache_pos < 3) {
+                // O̎Op`Ŏg_́AǂgĂȂ̂ŌŒl
+                score = k_LastTriScore;
+            }
+            else {
+                const float scaler = 1.0f / (MeshOptimizer::k_CacheSize - 3);
+                score = std::pow(1.0f - (cache_pos - 3) * scaler, k_CacheDecayPower);
+            }
+        }
+
+        // c̎Op`Ȃ_D悵āAǗOp`cȂ悤ɂ
+        score += k_ValenceBoostScale * std::pow(static_cast<float>(remaining_tris), -k_ValenceBoostPower);
+        return score;
+    }
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint16_t* indices, uint32_t index_num, uint32_t vertex_num)
+{
+    const uint32_t tri_num = index_num / 3;
+    if (tri_num == 0) {
+        return;
+    }
+
+    // _ -> Op`̑Ή\iCSR `j
+    std::vector<uint32_t> tri_begin(vertex_num + 1, 0);
+    for (uint32_t i = 0; i < tri_num * 3; ++i) {
+        ++tri_begin[indices[i] + 1];
+    }
+    for (uint32_t v = 0; v < vertex_num; ++v) {
+        tri_begin[v + 1] += tri_begin[v];
+    }
+    std::vector<uint32_t> vertex_tris(tri_num * 3);
+    std::vector<uint32_t> fill(tri_begin.begin(), tri_begin.end() - 1);
+    for (uint32_t t = 0; t < tri_num; ++t) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            uint16_t v = indices[t * 3 + k];
+            vertex_tris[fill[v]++] = t;
+        }
+    }
+
+    // _́ugp̎Op`vigpς݂̎Op`͑Ή\̌Ɋ񂹂Ăj
+    std::vector<uint32_t> remaining(vertex_num, 0);
+    for (uint32_t v = 0; v < vertex_num; ++v) {
+        remaining[v] = tri_begin[v + 1] - tri_begin[v];
+    }
+
+    std::vector<int> cache_pos(vertex_num, -1);
+    std::vector<float> vertex_score(vertex_num, 0.0f);
+    for (uint32_t v = 0; v < vertex_num; ++v) {
+        vertex_score[v] = VertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> tri_score(tri_num, 0.0f);
+    std::vector<uint8_t> tri_added(tri_num, 0);
+    for (uint32_t t = 0; t < tri_num; ++t) {
+        tri_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint16_t> output;
+    output.reserve(tri_num * 3);
+
+    // LRU LbViVOp`3_擪ɓ̂ŁAӂ镪̗]Tj
+    uint32_t cache[k_CacheSize + 3];
+    uint32_t cache_num = 0;
+    uint32_t new_cache[k_CacheSize + 3];
+
+    uint32_t best_tri = 0;
+    for (uint32_t t = 1; t < tri_num; ++t) {
+        if (tri_score[t] > tri_score[best_tri]) {
+            best_tri = t;
+        }
+    }
+    uint32_t scan_pos = 0;      // LbVɌ₪ƂɁA̖gpOp`Tʒu
+
+    for (uint32_t added = 0; added < tri_num; ++added) {
+        if (best_tri == UINT32_MAX) {
+            // LbV̒_gOp`ȂA擪珇ɖgp̂̂T
+            while (tri_added[scan_pos]) {
+                ++scan_pos;
+            }
+            best_tri = scan_pos;
+        }
+
+        // Op`o͂
+        const uint16_t* tri = &indices[best_tri * 3];
+        output.insert(output.end(), tri, tri + 3);
+        tri_added[best_tri] = 1;
+
+        // o͂Op`𒸓_̑Ή\Oigp̖Ɠւj
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint16_t v = tri[k];
+            uint32_t* list = &vertex_tris[tri_begin[v]];
+            uint32_t* last = list + remaining[v] - 1;
+            *std::find(list, last + 1, best_tri) = *last;
+            *last = best_tri;
+            --remaining[v];
+        }
+
+        // LbVXViOp`3_擪ɁAc͂̂܂܂̏ŌɁj
+        uint32_t new_cache_num = 0;
+        for (uint32_t k = 0; k < 3; ++k) {
+            // kނOp`œ_dȂ悤ɂ
+            if (std::find(new_cache, new_cache + new_cache_num, tri[k]) == new_cache + new_cache_num) {
+                new_cache[new_cache_num++] = tri[k];
+            }
+        }
+        for (uint32_t i = 0; i < cache_num; ++i) {
+            const uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                new_cache[new_cache_num++] = v;
+            }
+        }
+
+        // LbVǂoꂽ_͈ʒu𖳌ɂ
+        for (uint32_t i = k_CacheSize; i < new_cache_num; ++i) {
+            cache_pos[new_cache[i]] = -1;
+            vertex_score[new_cache[i]] = VertexScore(-1, remaining[new_cache[i]]);
+        }
+        cache_num = std::min(new_cache_num, k_CacheSize);
+        std::memcpy(cache, new_cache, sizeof(cache[0]) * cache_num);
+
+        // LbV̒_̃XRAXVAgOp`̃XRAXV
+        for (uint32_t i = 0; i < cache_num; ++i) {
+            const uint32_t v = cache[i];
+            cache_pos[v] = static_cast<int>(i);
+            const float new_score = VertexScore(static_cast<int>(i), remaining[v]);
+            const float diff = new_score - vertex_score[v];
+            vertex_score[v] = new_score;
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                tri_score[vertex_tris[tri_begin[v] + j]] += diff;
+            }
+        }
+        for (uint32_t i = k_CacheSize; i < new_cache_num; ++i) {
+            const uint32_t v = new_cache[i];
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                // ǂoꂽ_̃XRAω𔽉f邽߁AOp`̃XRAvZ
+                const uint32_t t = vertex_tris[tri_begin[v] + j];
+                tri_score[t] =
+                    vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+            }
+        }
+
+        // ̎Op`́ALbV̒_ggp̎Op`I
+        best_tri = UINT32_MAX;
+        float best_score = -1.0f;
+        for (uint32_t i = 0; i < cache_num; ++i) {
+            const uint32_t v = cache[i];
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                const uint32_t t = vertex_tris[tri_begin[v] + j];
+                if (tri_score[t] > best_score) {
+                    best_score = tri_score[t];
+                    best_tri = t;
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(
+    uint16_t* indices,
+    uint32_t index_num,
+    uint8_t* vertices,
+    uint32_t vertex_num,
+    uint32_t stride,
+    std::vector<uint32_t>* remap
+)
+{
+    // CfbNXōŏɎQƂꂽɐVԍU
+    remap->assign(vertex_num, UINT32_MAX);
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < index_num; ++i) {
+        uint32_t& dst = (*remap)[indices[i]];
+        if (dst == UINT32_MAX) {
+            dst = next++;
+        }
+    }
+    // ǂQƂȂ_́ȀԂ̂܂܌ɕׂ
+    for (auto& dst : *remap) {
+        if (dst == UINT32_MAX) {
+            dst = next++;
+        }
+    }
+
+    std::vector<uint8_t> src(vertices, vertices + static_cast<size_t>(vertex_num) * stride);
+    for (uint32_t v = 0; v < vertex_num; ++v) {
+        std::memcpy(vertices + static_cast<size_t>((*remap)[v]) * stride, src.data() + static_cast<size_t>(v) * stride, stride);
+    }
+    for (uint32_t i = 0; i < index_num; ++i) {
+        indices[i] = static_cast<uint16_t>((*remap)[indices[i]]);
+    }
+}
+
+float MeshOptimizer::CalcACMR(const uint16_t* indices, uint32_t index_num, uint32_t vertex_num, uint32_t cache_size)
+{
+    const uint32_t tri_num = index_num / 3;
+    if (tri_num == 0) {
+        return 0.0f;
+    }
+
+    // e_LbVɓoĂAcache_size ȏOȂǂoꂽƂ݂Ȃ
+    std::vector<uint32_t> cached_at(vertex_num, 0);
+    uint32_t timestamp = cache_size + 1;
+    uint32_t miss = 0;
+    for (uint32_t i = 0; i < tri_num * 3; ++i) {
+        const uint16_t v = indices[i];
+        if (timestamp - cached_at[v] > cache_size) {
+            cached_at[v] = timestamp++;
+            ++miss;
+        }
+    }
+
+    return static_cast<float>(miss) / tri_num;
+}
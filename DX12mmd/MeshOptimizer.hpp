@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// œKO ACMRik_ReportCacheSize  FIFO LbVŌςlj
+struct MeshOptimizeStats
+{
+    float AcmrBefore = 0.0f;
+    float AcmrAfter = 0.0f;
+};
+
+// ǂݍݎɃCfbNXE_̕тœKNX
+//
+// 1. _LbVœKiTom Forsyth  Linear-Speed Vertex Cache Optimisationj
+//    OɎg_gOp`قǐɕ`悤AOp`̏ԂבւB
+//    }eA͈̔͂̒ŕבւ̂ŁAMaterial::IndicesNum ̋؂͂̂܂܎gB
+// 2. _tFb`œK
+//    CfbNXōŏɎQƂ鏇ɒ_בւA_̓ǂݍ݂AB
+class MeshOptimizer
+{
+public:
+
+    static constexpr uint32_t k_CacheSize = 32;         // œKőz肷钸_LbṼTCY
+    static constexpr uint32_t k_ReportCacheSize = 16;   // ACMR vɎg FIFO LbṼTCY
+
+    // @brief Op`̕т𒸓_LbVɍ킹ĕבւ
+    // @param indices    בւ͈͂̐擪i3̔{j
+    // @param index_num  ͈͂̃CfbNX
+    // @param vertex_num fŜ̒_iCfbNX͑SĂꖢł邱ƁBǂݍݎɊmFς݁j
+    static void OptimizeVertexCache(uint16_t* indices, uint32_t index_num, uint32_t vertex_num);
+
+    // @brief _ŏɎQƂ鏇ɕבւACfbNXtւ
+    // @param indices    fŜ̃CfbNX
+    // @param index_num  CfbNX
+    // @param vertices   _f[^
+    // @param vertex_num _
+    // @param stride     1_̃oCg
+    // @param remap      ̒_ԍ -> V_ԍ
+    static void OptimizeVertexFetch(
+        uint16_t* indices,
+        uint32_t index_num,
+        uint8_t* vertices,
+        uint32_t vertex_num,
+        uint32_t stride,
+        std::vector<uint32_t>* remap
+    );
+
+    // @brief ACMRiOp`̒_VF[_[s񐔁j FIFO LbVŌς
+    static float CalcACMR(const uint16_t* indices, uint32_t index_num, uint32_t vertex_num, uint32_t cache_size = k_ReportCacheSize);
+};
@@ -0,0 +1,322 @@
+#include "MeshSimplifier.hpp"
+#include "PMD.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    // ʂ܂ł̋̓a\񎟌`iΏ 4x4 s̏Opj
+    struct Quadric
+    {
+        double a2, b2, c2, d2;
+        double ab, ac, ad;
+        double bc, bd;
+        double cd;
+        double w;               // ʐς̍vi덷𕽋ςɂ邽߂̏d݁j
+
+        void Add(const Quadric& q)
+        {
+            a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+            ab += q.ab; ac += q.ac; ad += q.ad;
+            bc += q.bc; bd += q.bd;
+            cd += q.cd;
+            w += q.w;
+        }
+
+        double Eval(const DirectX::XMFLOAT3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            double r = a2 * x * x + b2 * y * y + c2 * z * z + d2
+                + 2.0 * (ab * x * y + ac * x * z + ad * x + bc * y * z + bd * y + cd * z);
+            return std::max(r, 0.0);
+        }
+    };
+
+    Quadric PlaneQuadric(double a, double b, double c, double d, double w)
+    {
+        Quadric q;
+        q.a2 = a * a * w; q.b2 = b * b * w; q.c2 = c * c * w; q.d2 = d * d * w;
+        q.ab = a * b * w; q.ac = a * c * w; q.ad = a * d * w;
+        q.bc = b * c * w; q.bd = b * d * w;
+        q.cd = c * d * w;
+        q.w = w;
+        return q;
+    }
+
+    DirectX::XMFLOAT3 Sub(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return DirectX::XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z);
+    }
+
+    DirectX::XMFLOAT3 Cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return DirectX::XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // 2_̃{[EFCg̍i0 ` 1j
+    float BoneWeightDistance(const PMDVertex& a, const PMDVertex& b)
+    {
+        const float wa[2] = { a.BoneWeight / 100.0f, 1.0f - a.BoneWeight / 100.0f };
+        const float wb[2] = { b.BoneWeight / 100.0f, 1.0f - b.BoneWeight / 100.0f };
+
+        // ɋʂ{[̃EFCg̏v̂vx
+        float shared = 0.0f;
+        bool used_b[2] = { false, false };
+        for (int i = 0; i < 2; ++i) {
+            if (wa[i] <= 0.0f) {
+                continue;
+            }
+            for (int k = 0; k < 2; ++k) {
+                if (!used_b[k] && wb[k] > 0.0f && a.BoneNo[i] == b.BoneNo[k]) {
+                    shared += std::min(wa[i], wb[k]);
+                    used_b[k] = true;
+                    break;
+                }
+            }
+        }
+        return 1.0f - shared;
+    }
+
+    struct PositionKey
+    {
+        uint32_t Bits[3];
+
+        bool operator==(const PositionKey& other) const
+        {
+            return Bits[0] == other.Bits[0] && Bits[1] == other.Bits[1] && Bits[2] == other.Bits[2];
+        }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& key) const
+        {
+            return (key.Bits[0] * 73856093u) ^ (key.Bits[1] * 19349663u) ^ (key.Bits[2] * 83492791u);
+        }
+    };
+
+    struct Collapse
+    {
+        uint16_t From;
+        uint16_t To;
+        float    Error;
+    };
+}
+
+float MeshSimplifier::Simplify(
+    const uint16_t* indices,
+    uint32_t index_num,
+    const PMDVertex* vertices,
+    uint32_t vertex_num,
+    uint32_t target_index_num,
+    float max_error,
+    std::vector<uint16_t>* out
+)
+{
+    index_num -= index_num % 3;
+    out->assign(indices, indices + index_num);
+    if (index_num <= target_index_num) {
+        return 0.0f;
+    }
+
+    // Ȃ_𒲂ׂ
+    std::vector<uint8_t> locked(vertex_num, 0);
+    {
+        // UVE@̌pځiWɕʂ̒_j
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> positions;
+        positions.reserve(vertex_num);
+        for (uint32_t i = 0; i < vertex_num; ++i) {
+            PositionKey key;
+            std::memcpy(key.Bits, &vertices[i].Pos, sizeof(key.Bits));
+            auto result = positions.emplace(key, i);
+            if (!result.second) {
+                locked[i] = 1;
+                locked[result.first->second] = 1;
+            }
+        }
+
+        // JӁit̕ӂӁj
+        std::unordered_map<uint32_t, uint32_t> edges;
+        edges.reserve(index_num);
+        for (uint32_t i = 0; i < index_num; i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                uint32_t a = (*out)[i + k];
+                uint32_t b = (*out)[i + (k + 1) % 3];
+                ++edges[(a << 16) | b];
+            }
+        }
+        for (const auto& edge : edges) {
+            uint32_t a = edge.first >> 16;
+            uint32_t b = edge.first & 0xFFFF;
+            if (edges.find((b << 16) | a) == edges.end()) {
+                locked[a] = 1;
+                locked[b] = 1;
+            }
+        }
+    }
+
+    // _Ɏ͂̎Op`̕ʂ̓񎟌`𑫂Ă
+    std::vector<Quadric> quadrics(vertex_num, Quadric{});
+    for (uint32_t i = 0; i < index_num; i += 3) {
+        const uint16_t* tri = &(*out)[i];
+        const auto& p0 = vertices[tri[0]].Pos;
+        DirectX::XMFLOAT3 n = Cross(Sub(vertices[tri[1]].Pos, p0), Sub(vertices[tri[2]].Pos, p0));
+        const double len = std::sqrt(static_cast<double>(Dot(n, n)));
+        if (len <= 0.0) {
+            continue;
+        }
+        const double a = n.x / len, b = n.y / len, c = n.z / len;
+        const double d = -(a * p0.x + b * p0.y + c * p0.z);
+        const Quadric q = PlaneQuadric(a, b, c, d, len * 0.5);
+        for (int k = 0; k < 3; ++k) {
+            quadrics[tri[k]].Add(q);
+        }
+    }
+
+    const double error_limit = static_cast<double>(max_error) * max_error;
+    double result_error = 0.0;
+
+    std::vector<Collapse> collapses;
+    std::vector<uint16_t> remap(vertex_num);
+    std::vector<uint8_t> touched(vertex_num);
+    std::vector<uint32_t> adjacency_begin(vertex_num + 1);
+    std::vector<uint32_t> adjacency;
+
+    while (out->size() > target_index_num) {
+        const uint32_t current_num = static_cast<uint32_t>(out->size());
+
+        // _ -> Op`̑Ή\
+        std::fill(adjacency_begin.begin(), adjacency_begin.end(), 0);
+        for (uint16_t v : *out) {
+            ++adjacency_begin[v + 1];
+        }
+        for (uint32_t v = 0; v < vertex_num; ++v) {
+            adjacency_begin[v + 1] += adjacency_begin[v];
+        }
+        adjacency.resize(current_num);
+        {
+            std::vector<uint32_t> fill(adjacency_begin.begin(), adjacency_begin.end() - 1);
+            for (uint32_t i = 0; i < current_num; ++i) {
+                adjacency[fill[(*out)[i]]++] = i / 3;
+            }
+        }
+
+        // Ӗɂ܂Ƃ߂A덷̏ɕׂ
+        collapses.clear();
+        for (uint32_t i = 0; i < current_num; i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                const uint16_t a = (*out)[i + k];
+                const uint16_t b = (*out)[i + (k + 1) % 3];
+                const uint16_t pair[2][2] = { { a, b }, { b, a } };
+                for (const auto& p : pair) {
+                    const uint16_t from = p[0];
+                    const uint16_t to = p[1];
+                    if (locked[from] || from == to) {
+                        continue;
+                    }
+                    if (BoneWeightDistance(vertices[from], vertices[to]) > k_BoneWeightTolerance) {
+                        continue;
+                    }
+                    Quadric q = quadrics[from];
+                    q.Add(quadrics[to]);
+                    const double error = q.w > 0.0 ? q.Eval(vertices[to].Pos) / q.w : 0.0;
+                    if (error > error_limit) {
+                        continue;
+                    }
+                    collapses.push_back(Collapse{ from, to, static_cast<float>(error) });
+                }
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            return a.Error < b.Error;
+        });
+
+        // ̎ŐG_͎̎g킸A덷̂̂珇ɂ܂Ƃ߂
+        for (uint32_t v = 0; v < vertex_num; ++v) {
+            remap[v] = static_cast<uint16_t>(v);
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+        uint32_t removed_index_num = 0;
+        const uint32_t needed_index_num = current_num - target_index_num;
+
+        for (const auto& collapse : collapses) {
+            if (touched[collapse.From] || touched[collapse.To]) {
+                continue;
+            }
+
+            // ܂Ƃ߂ƂɗԂOp`Β߂
+            bool flipped = false;
+            uint32_t degenerate_num = 0;
+            for (uint32_t a = adjacency_begin[collapse.From]; a < adjacency_begin[collapse.From + 1]; ++a) {
+                const uint16_t* tri = &(*out)[adjacency[a] * 3];
+                if (tri[0] == collapse.To || tri[1] == collapse.To || tri[2] == collapse.To) {
+                    ++degenerate_num;
+                    continue;
+                }
+                DirectX::XMFLOAT3 before[3];
+                DirectX::XMFLOAT3 after[3];
+                for (int k = 0; k < 3; ++k) {
+                    before[k] = vertices[tri[k]].Pos;
+                    after[k] = tri[k] == collapse.From ? vertices[collapse.To].Pos : before[k];
+                }
+                DirectX::XMFLOAT3 n0 = Cross(Sub(before[1], before[0]), Sub(before[2], before[0]));
+                DirectX::XMFLOAT3 n1 = Cross(Sub(after[1], after[0]), Sub(after[2], after[0]));
+                if (Dot(n0, n1) <= 0.0f) {
+                    flipped = true;
+                    break;
+                }
+            }
+            if (flipped) {
+                continue;
+            }
+
+            remap[collapse.From] = collapse.To;
+            quadrics[collapse.To].Add(quadrics[collapse.From]);
+            result_error = std::max(result_error, static_cast<double>(collapse.Error));
+
+            for (uint32_t a = adjacency_begin[collapse.From]; a < adjacency_begin[collapse.From + 1]; ++a) {
+                const uint16_t* tri = &(*out)[adjacency[a] * 3];
+                touched[tri[0]] = 1;
+                touched[tri[1]] = 1;
+                touched[tri[2]] = 1;
+            }
+
+            removed_index_num += degenerate_num * 3;
+            if (removed_index_num >= needed_index_num) {
+                break;
+            }
+        }
+        if (removed_index_num == 0) {
+            break;
+        }
+
+        // tւāAׂꂽOp`菜
+        uint32_t write = 0;
+        for (uint32_t i = 0; i < current_num; i += 3) {
+            const uint16_t a = remap[(*out)[i + 0]];
+            const uint16_t b = remap[(*out)[i + 1]];
+            const uint16_t c = remap[(*out)[i + 2]];
+            if (a == b || b == c || c == a) {
+                continue;
+            }
+            (*out)[write + 0] = a;
+            (*out)[write + 1] = b;
+            (*out)[write + 2] = c;
+            write += 3;
+        }
+        out->resize(write);
+    }
+
+    return static_cast<float>(std::sqrt(result_error));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct PMDVertex;
+
+// ڍדxiLODj1ĩCfbNX
+struct MeshLod
+{
+    uint32_t IndexOffset;                       // LODCfbNX̐擪
+    uint32_t IndexNum;                          // CfbNX
+    float    Error;                             // ̃bV̌덷ifW̋j
+    std::vector<uint32_t> MaterialIndexNums;    // }eÃCfbNX
+};
+
+// 񎟌덷iQuadric Error MetricsjŒ_܂Ƃ߂ĎOp`炷NX
+//
+// _̕ʂ̒_Ɋ񂹂邾ŐV_͍Ȃ̂ŁALOD͌̒_obt@̂܂܎gB
+// ڂ₷_͓ȂB
+//  - Jӂ̒_i}eA̋ڂJӂɂȂj
+//  - Wɕʂ̒_钸_iUVE@̌pځj
+// ܂A{[EFCg傫Ⴄ_m͂܂Ƃ߂Ȃiό`ƂɌ`邽߁jB
+class MeshSimplifier
+{
+public:
+
+    static constexpr float k_BoneWeightTolerance = 0.1f;    // ܂Ƃ߂Ă悢{[EFCg̍
+
+    // @brief Op`炵CfbNX
+    // @param indices    ̃CfbNXi3̔{j
+    // @param index_num  CfbNX
+    // @param vertices   _f[^
+    // @param vertex_num _
+    // @param target_index_num ڕW̃CfbNX
+    // @param max_error  e덷ifW̋j
+    // @param out        ʂ̃CfbNX
+    // @retval ʂ̌덷ifW̋j
+    static float Simplify(
+        const uint16_t* indices,
+        uint32_t index_num,
+        const PMDVertex* vertices,
+        uint32_t vertex_num,
+        uint32_t target_index_num,
+        float max_error,
+        std::vector<uint16_t>* out
+    );
+};
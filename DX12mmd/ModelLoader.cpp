@@ -0,0 +1,73 @@
+#include "ModelLoader.hpp"
+
+#include <future>
+
+ModelLoader::ModelLoader(ThreadPool* pool)
+    :
+    m_Pool(pool)
+{}
+
+bool ModelLoader::Load(
+    ResourceManager* resource_manager,
+    const std::vector<ModelLoadRequest>& requests,
+    std::vector<PMDActorPtr>* actors
+)
+{
+    struct PendingModel
+    {
+        PMDActorPtr       Actor;
+        std::future<bool> ModelResult;      // PMD + eNX`fR[h
+        std::future<bool> MotionResult;     // VMD
+    };
+
+    // CPUŊ鏈ׂ͂ă[J[Xbhɓ
+    // PMD  VMD ͕ʃo[ĜŁAAN^[łɓǂݍ߂
+    std::vector<PendingModel> pending;
+    pending.reserve(requests.size());
+    for (const auto& request : requests) {
+        auto actor = std::make_shared<PMDActor>();
+        PendingModel model;
+        model.Actor = actor;
+        model.ModelResult = m_Pool->Submit([actor, path = request.PMDPath, optimize = request.OptimizeMesh, textures = !request.MotionOnly]() {
+            return actor->LoadModel(path, optimize, textures);
+        });
+        if (request.StreamMotion) {
+            // `N̐ǂ݂ɂXbhv[g
+            model.MotionResult = m_Pool->Submit([actor, path = request.VMDPath, pool = m_Pool]() {
+                return actor->LoadMotionStream(path, pool);
+            });
+        }
+        else {
+            model.MotionResult = m_Pool->Submit([actor, path = request.VMDPath, compression = request.MotionCompression]() {
+                return actor->LoadMotion(path, compression ? &*compression : nullptr);
+            });
+        }
+        pending.emplace_back(std::move(model));
+    }
+
+    // GPU\[X̍쐬͕`Xbhœo^ɍs
+    // ҂ĂԂA㑱f̓ǂݍ݂̓[J[XbhŐił
+    bool result = true;
+    actors->clear();
+    actors->reserve(requests.size());
+    for (size_t i = 0; i < pending.size(); ++i) {
+        bool loaded = pending[i].ModelResult.get();
+        loaded = pending[i].MotionResult.get() && loaded;
+
+        if (loaded && requests[i].MotionOnly) {
+            pending[i].Actor->CreateMotionOnly();
+        }
+        else if (!loaded || !pending[i].Actor->CreateResources(resource_manager, requests[i].ModelName)) {
+            result = false;
+            actors->emplace_back(nullptr);
+            continue;
+        }
+        // Ă݂ɎsĂʏ̍Đ͂ł̂ŁAǂݍݎsɂ͂Ȃ
+        if (requests[i].BakeMotion) {
+            pending[i].Actor->UseBakedMotion();
+        }
+        actors->emplace_back(pending[i].Actor);
+    }
+
+    return result;
+}
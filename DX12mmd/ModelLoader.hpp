@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <optional>
+
+#include "PMDActor.hpp"
+#include "CompressedMotion.hpp"
+#include "ThreadPool.hpp"
+
+struct ModelLoadRequest
+{
+    std::string           ModelName;        // \[X
+    std::filesystem::path PMDPath;          // ft@C
+    std::filesystem::path VMDPath;          // [Vt@C
+    bool                  OptimizeMesh = true;  // ǂݍݎɃCfbNXE_בւ邩
+    bool                  BakeMotion = false;   // [VĂ񂾎pōĐ邩iĐpj
+    std::optional<MotionCompressionSettings> MotionCompression;   // {[[VkĎꍇ̐ݒ
+    bool                  StreamMotion = false; // {[[VXg[~OĐ邩i[VBk̐ݒ͖j
+    bool                  MotionOnly = false;   // GPU\[XEeNX`炸A[V̍XVł悤ɂ邩iXV̌vpj
+};
+
+// f܂Ƃ߂ēǂݍރNX
+// PMD́EVMD́EeNX`̃fR[h̓Xbhv[ŕɍsA
+// GPU\[X̍쐬Ăяoi`Xbhjŏɍs
+class ModelLoader
+{
+public:
+
+    explicit ModelLoader(ThreadPool* pool);
+
+    // @brief fǂݍ
+    // @param resource_manager GPU\[X̓o^iMotionOnly ̃f͓o^Ȃj
+    // @param requests         ǂݍރf̃Xg
+    // @param actors           ǂݍ񂾃firequests Ɠԁj
+    // @retval ЂƂłǂݍ݂Ɏs false
+    bool Load(
+        ResourceManager* resource_manager,
+        const std::vector<ModelLoadRequest>& requests,
+        std::vector<PMDActorPtr>* actors
+    );
+
+private:
+
+    ThreadPool* m_Pool;
+};
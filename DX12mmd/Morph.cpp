@@ -0,0 +1,348 @@
+#include "Morph.hpp"
+#include "PMD.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <DirectXMath.h>
+
+namespace
+{
+    uint32_t AlignSimd(uint32_t num)
+    {
+        return (num + MorphSet::k_SimdWidth - 1) & ~(MorphSet::k_SimdWidth - 1);
+    }
+
+    DirectX::XMVECTOR LoadSimd(const float* ptr)
+    {
+        return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(ptr));
+    }
+}
+
+MorphSet::MorphSet()
+    :
+    m_BaseVertexIdx(),
+    m_BasePosX(),
+    m_BasePosY(),
+    m_BasePosZ(),
+    m_EntryBaseIdx(),
+    m_OffsetX(),
+    m_OffsetY(),
+    m_OffsetZ(),
+    m_Morphs(),
+    m_MorphIndexTable()
+{}
+
+bool MorphSet::Create(const uint8_t* data, uint64_t size, uint16_t skin_num, uint32_t vertex_num, uint64_t* read_size)
+{
+    m_BaseVertexIdx.clear();
+    m_BasePosX.clear();
+    m_BasePosY.clear();
+    m_BasePosZ.clear();
+    m_EntryBaseIdx.clear();
+    m_OffsetX.clear();
+    m_OffsetY.clear();
+    m_OffsetZ.clear();
+    m_Morphs.clear();
+    m_MorphIndexTable.clear();
+
+    if (read_size) {
+        *read_size = 0;
+    }
+    if (skin_num == 0) {
+        return true;
+    }
+
+    // ܂XL̋؂𒲂ׂi_f[^̓t@C𒼐ڎQƂj
+    struct SkinSource
+    {
+        PMDSkinHeader Header;
+        DataView<PMDSkinVertex> Vertices;
+    };
+    std::vector<SkinSource> skins(skin_num);
+    MappedFileReader reader(data, size);
+    for (auto& skin : skins) {
+        if (!reader.Read(&skin.Header)) {
+            return false;
+        }
+        if (!reader.View(skin.Header.SkinVertexNum, &skin.Vertices)) {
+            return false;
+        }
+    }
+    if (read_size) {
+        *read_size = reader.Offset();
+    }
+
+    auto base = std::find_if(skins.begin(), skins.end(), [](const SkinSource& skin) {
+        return skin.Header.SkinType == k_Base;
+    });
+    if (base == skins.end()) {
+        return false;
+    }
+
+    // base
+    const uint32_t base_num = static_cast<uint32_t>(base->Vertices.size());
+    const uint32_t base_aligned = AlignSimd(base_num);
+    m_BaseVertexIdx.resize(base_num);
+    m_BasePosX.assign(base_aligned, 0.0f);
+    m_BasePosY.assign(base_aligned, 0.0f);
+    m_BasePosZ.assign(base_aligned, 0.0f);
+    for (uint32_t i = 0; i < base_num; ++i) {
+        const PMDSkinVertex& v = base->Vertices[i];
+        if (v.SkinVertexIdx >= vertex_num) {
+            return false;
+        }
+        m_BaseVertexIdx[i] = v.SkinVertexIdx;
+        m_BasePosX[i] = v.SkinVertexPos.x;
+        m_BasePosY[i] = v.SkinVertexPos.y;
+        m_BasePosZ[i] = v.SkinVertexPos.z;
+    }
+
+    // base ȊÕXL[tƂēo^
+    for (const auto& skin : skins) {
+        if (&skin == &(*base)) {
+            continue;
+        }
+
+        MorphInfo info;
+        info.Name = std::string(skin.Header.SkinName, strnlen(skin.Header.SkinName, sizeof(skin.Header.SkinName)));
+        info.Type = skin.Header.SkinType;
+        info.EntryBegin = static_cast<uint32_t>(m_EntryBaseIdx.size());
+        info.EntryNum = AlignSimd(static_cast<uint32_t>(skin.Vertices.size()));
+        info.BaseBegin = 0;
+        info.BaseEnd = 0;
+
+        for (const PMDSkinVertex& v : skin.Vertices) {
+            if (v.SkinVertexIdx >= base_num) {
+                return false;
+            }
+            m_EntryBaseIdx.push_back(v.SkinVertexIdx);
+            m_OffsetX.push_back(v.SkinVertexPos.x);
+            m_OffsetY.push_back(v.SkinVertexPos.y);
+            m_OffsetZ.push_back(v.SkinVertexPos.z);
+        }
+        // 4vfPʂŏł悤AItZbg0̗vfŋl߂
+        const uint32_t pad_idx = skin.Vertices.empty() ? 0 : m_EntryBaseIdx.back();
+        while (m_EntryBaseIdx.size() < static_cast<size_t>(info.EntryBegin) + info.EntryNum) {
+            m_EntryBaseIdx.push_back(pad_idx);
+            m_OffsetX.push_back(0.0f);
+            m_OffsetY.push_back(0.0f);
+            m_OffsetZ.push_back(0.0f);
+        }
+
+        // ̃[tꍇ͐擪̂̂g
+        m_MorphIndexTable.emplace(info.Name, static_cast<uint32_t>(m_Morphs.size()));
+        m_Morphs.emplace_back(std::move(info));
+    }
+
+    SortBase();
+
+    return true;
+}
+
+bool MorphSet::RemapBaseVertices(uint8_t* data, uint64_t size, uint16_t skin_num, const std::vector<uint32_t>& remap)
+{
+    MappedFileReader reader(data, size);
+    for (uint16_t i = 0; i < skin_num; ++i) {
+        PMDSkinHeader header;
+        if (!reader.Read(&header)) {
+            return false;
+        }
+        const uint64_t offset = reader.Offset();
+        if (!reader.Skip(static_cast<uint64_t>(header.SkinVertexNum) * sizeof(PMDSkinVertex))) {
+            return false;
+        }
+        // base ȊO base ̔ԍȂ̂ŕtւsv
+        if (header.SkinType != k_Base) {
+            continue;
+        }
+
+        // t@C̈ʒu̓ACĂȂ̂ memcpy œǂݏ
+        for (uint32_t v = 0; v < header.SkinVertexNum; ++v) {
+            uint8_t* entry = data + offset + static_cast<uint64_t>(v) * sizeof(PMDSkinVertex);
+            uint32_t vertex_idx = 0;
+            std::memcpy(&vertex_idx, entry, sizeof(vertex_idx));
+            if (vertex_idx < remap.size()) {
+                vertex_idx = remap[vertex_idx];
+                std::memcpy(entry, &vertex_idx, sizeof(vertex_idx));
+            }
+        }
+    }
+    return true;
+}
+
+void MorphSet::RemapVertices(const std::vector<uint32_t>& remap)
+{
+    for (auto& vertex_idx : m_BaseVertexIdx) {
+        if (vertex_idx < remap.size()) {
+            vertex_idx = remap[vertex_idx];
+        }
+    }
+    // _ԍ̂ŕג
+    SortBase();
+}
+
+void MorphSet::SortBase()
+{
+    // base 𒸓_ԍɕבւƁAbase ԍ͈̔͂̂܂܋_͈͂ɂȂ
+    const uint32_t base_num = static_cast<uint32_t>(m_BaseVertexIdx.size());
+    std::vector<uint32_t> order(base_num);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return m_BaseVertexIdx[a] < m_BaseVertexIdx[b];
+    });
+
+    std::vector<uint32_t> new_idx(base_num);
+    std::vector<uint32_t> vertex_idx(base_num);
+    std::vector<float> pos_x(m_BasePosX.size(), 0.0f);
+    std::vector<float> pos_y(m_BasePosY.size(), 0.0f);
+    std::vector<float> pos_z(m_BasePosZ.size(), 0.0f);
+    for (uint32_t i = 0; i < base_num; ++i) {
+        new_idx[order[i]] = i;
+        vertex_idx[i] = m_BaseVertexIdx[order[i]];
+        pos_x[i] = m_BasePosX[order[i]];
+        pos_y[i] = m_BasePosY[order[i]];
+        pos_z[i] = m_BasePosZ[order[i]];
+    }
+    m_BaseVertexIdx.swap(vertex_idx);
+    m_BasePosX.swap(pos_x);
+    m_BasePosY.swap(pos_y);
+    m_BasePosZ.swap(pos_z);
+
+    for (auto& idx : m_EntryBaseIdx) {
+        idx = new_idx[idx];
+    }
+
+    for (auto& morph : m_Morphs) {
+        if (morph.EntryNum == 0) {
+            morph.BaseBegin = morph.BaseEnd = 0;
+            continue;
+        }
+        auto entry_begin = m_EntryBaseIdx.begin() + morph.EntryBegin;
+        auto minmax = std::minmax_element(entry_begin, entry_begin + morph.EntryNum);
+        morph.BaseBegin = *minmax.first;
+        morph.BaseEnd = *minmax.second + 1;
+    }
+}
+
+uint32_t MorphSet::MorphNum() const
+{
+    return static_cast<uint32_t>(m_Morphs.size());
+}
+
+const MorphSet::MorphInfo& MorphSet::GetMorph(uint32_t idx) const
+{
+    return m_Morphs[idx];
+}
+
+uint32_t MorphSet::FindMorphIndex(const std::string& name) const
+{
+    auto itr = m_MorphIndexTable.find(name);
+    if (itr == m_MorphIndexTable.end()) {
+        return k_InvalidMorphIdx;
+    }
+    return itr->second;
+}
+
+void MorphSet::InitState(State* state) const
+{
+    const size_t acc_num = m_BasePosX.size();
+    state->AccX.assign(acc_num, 0.0f);
+    state->AccY.assign(acc_num, 0.0f);
+    state->AccZ.assign(acc_num, 0.0f);
+    state->ActiveMorphs.clear();
+    state->ActiveMorphs.reserve(m_Morphs.size());
+    state->NextActive.clear();
+    state->NextActive.reserve(m_Morphs.size());
+}
+
+MorphSet::DirtyRange MorphSet::Apply(const float* weights, State* state, uint8_t* vertices, uint32_t stride) const
+{
+    // EFCg 0 łȂ[tƁAOĂ[tiɖ߂Kvj͈̔͂vZ
+    uint32_t base_begin = std::numeric_limits<uint32_t>::max();
+    uint32_t base_end = 0;
+    state->NextActive.clear();
+    for (uint32_t m = 0; m < m_Morphs.size(); ++m) {
+        const auto& morph = m_Morphs[m];
+        if (weights[m] == 0.0f || morph.EntryNum == 0) {
+            continue;
+        }
+        state->NextActive.push_back(m);
+        base_begin = std::min(base_begin, morph.BaseBegin);
+        base_end = std::max(base_end, morph.BaseEnd);
+    }
+    for (uint32_t m : state->ActiveMorphs) {
+        base_begin = std::min(base_begin, m_Morphs[m].BaseBegin);
+        base_end = std::max(base_end, m_Morphs[m].BaseEnd);
+    }
+    state->ActiveMorphs.swap(state->NextActive);
+
+    if (base_begin >= base_end) {
+        return DirtyRange{ 0, 0 };
+    }
+
+    float* acc_x = state->AccX.data();
+    float* acc_y = state->AccY.data();
+    float* acc_z = state->AccZ.data();
+    std::fill(acc_x + base_begin, acc_x + base_end, 0.0f);
+    std::fill(acc_y + base_begin, acc_y + base_end, 0.0f);
+    std::fill(acc_z + base_begin, acc_z + base_end, 0.0f);
+
+    // ItZbg~EFCg4vfvZAbase ɑ
+    DirectX::XMFLOAT4 dx, dy, dz;
+    for (uint32_t m : state->ActiveMorphs) {
+        const auto& morph = m_Morphs[m];
+        const DirectX::XMVECTOR w = DirectX::XMVectorReplicate(weights[m]);
+        const uint32_t entry_end = morph.EntryBegin + morph.EntryNum;
+        for (uint32_t i = morph.EntryBegin; i < entry_end; i += k_SimdWidth) {
+            DirectX::XMStoreFloat4(&dx, DirectX::XMVectorMultiply(LoadSimd(&m_OffsetX[i]), w));
+            DirectX::XMStoreFloat4(&dy, DirectX::XMVectorMultiply(LoadSimd(&m_OffsetY[i]), w));
+            DirectX::XMStoreFloat4(&dz, DirectX::XMVectorMultiply(LoadSimd(&m_OffsetZ[i]), w));
+
+            const uint32_t* idx = &m_EntryBaseIdx[i];
+            acc_x[idx[0]] += dx.x;  acc_y[idx[0]] += dy.x;  acc_z[idx[0]] += dz.x;
+            acc_x[idx[1]] += dx.y;  acc_y[idx[1]] += dy.y;  acc_z[idx[1]] += dz.y;
+            acc_x[idx[2]] += dx.z;  acc_y[idx[2]] += dy.z;  acc_z[idx[2]] += dz.z;
+            acc_x[idx[3]] += dx.w;  acc_y[idx[3]] += dy.w;  acc_z[idx[3]] += dz.w;
+        }
+    }
+
+    // W{ItZbgv4vfvZA_f[^֏߂
+    DirectX::XMFLOAT4 px, py, pz;
+    for (uint32_t k = base_begin & ~(k_SimdWidth - 1); k < base_end; k += k_SimdWidth) {
+        DirectX::XMStoreFloat4(&px, DirectX::XMVectorAdd(LoadSimd(&m_BasePosX[k]), LoadSimd(acc_x + k)));
+        DirectX::XMStoreFloat4(&py, DirectX::XMVectorAdd(LoadSimd(&m_BasePosY[k]), LoadSimd(acc_y + k)));
+        DirectX::XMStoreFloat4(&pz, DirectX::XMVectorAdd(LoadSimd(&m_BasePosZ[k]), LoadSimd(acc_z + k)));
+
+        const float lane_x[k_SimdWidth] = { px.x, px.y, px.z, px.w };
+        const float lane_y[k_SimdWidth] = { py.x, py.y, py.z, py.w };
+        const float lane_z[k_SimdWidth] = { pz.x, pz.y, pz.z, pz.w };
+        for (uint32_t lane = 0; lane < k_SimdWidth; ++lane) {
+            const uint32_t b = k + lane;
+            if (b < base_begin || b >= base_end) {
+                continue;
+            }
+            float* pos = reinterpret_cast<float*>(vertices + static_cast<size_t>(m_BaseVertexIdx[b]) * stride);
+            pos[0] = lane_x[lane];
+            pos[1] = lane_y[lane];
+            pos[2] = lane_z[lane];
+        }
+    }
+
+    // base ͒_ԍȂ̂ŁA͈̗͂[̂܂܏_͈͂ɂȂ
+    return DirtyRange{ m_BaseVertexIdx[base_begin], m_BaseVertexIdx[base_end - 1] + 1 };
+}
+
+void MorphSet::CalcMaxDisplacement(uint32_t vertex_num, std::vector<float>* displacement) const
+{
+    displacement->assign(vertex_num, 0.0f);
+
+    // lߕ̗vf̓ItZbg 0 Ȃ̂ŋʂɑĂ悢
+    for (size_t i = 0; i < m_EntryBaseIdx.size(); ++i) {
+        const uint32_t vertex_idx = m_BaseVertexIdx[m_EntryBaseIdx[i]];
+        const float len = std::sqrt(m_OffsetX[i] * m_OffsetX[i] + m_OffsetY[i] * m_OffsetY[i] + m_OffsetZ[i] * m_OffsetZ[i]);
+        (*displacement)[vertex_idx] += len;
+    }
+}
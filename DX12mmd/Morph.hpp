@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// \[tiPMD́uXLvj
+//
+// PMD̃XL basei0jeS_̔ԍƊWA
+// ȊÕXL base ̔ԍƃItZbgB
+// ǂݍݎɂȉ̌`ɕϊĂB
+//  - base: _ԍɕבւ_ԍƊWix, y, z ʂ̔zj
+//  - e[t: base ̔ԍƃItZbgix, y, z ʂ̔zB4vfPʂɋlߕj
+// t[̌vZ̓EFCg 0 łȂ[t̃ItZbg4vf܂Ƃ߂ďA
+// _͈̔͂Ԃ̂ŁA͈̔͂GPUɓ]΂悢B
+class MorphSet
+{
+public:
+
+    static constexpr uint32_t k_InvalidMorphIdx = 0xFFFFFFFF;
+    static constexpr uint32_t k_SimdWidth = 4;
+
+    enum MorphType : uint8_t
+    {
+        k_Base = 0,             // base
+        k_Eyebrow,              // 
+        k_Eye,                  // 
+        k_Lip,                  // bv
+        k_Other,                // ̑
+    };
+
+    struct MorphInfo
+    {
+        std::string Name;           // [t
+        uint8_t     Type;           // ʁiMorphTypej
+        uint32_t    EntryBegin;     // ItZbgz̐擪
+        uint32_t    EntryNum;       // ItZbgi4̔{ɋlߕς݁j
+        uint32_t    BaseBegin;      // e base ԍ͈̔
+        uint32_t    BaseEnd;
+    };
+
+    // _͈̔ [Begin, End)
+    struct DirtyRange
+    {
+        uint32_t Begin;
+        uint32_t End;
+
+        bool empty() const { return Begin >= End; }
+    };
+
+    // AN^[̌vZp̍Ɨ̈
+    struct State
+    {
+        std::vector<float>    AccX;             // base ̃ItZbgv
+        std::vector<float>    AccY;
+        std::vector<float>    AccZ;
+        std::vector<uint32_t> ActiveMorphs;     // OEFCg 0 łȂ[t
+        std::vector<uint32_t> NextActive;
+    };
+
+public:
+
+    MorphSet();
+
+    // @brief PMD̃XLZNVϊ
+    // @param data       XLZNV̐擪iXL̒j
+    // @param size       XLZNṼoCg
+    // @param skin_num   XL
+    // @param vertex_num f̒_i͈͊O̒_ԍ̓G[j
+    // @param read_size  XLZNVƂēǂ񂾃oCgisvȂ nullptrj
+    //                   base ȂǂŎsꍇAZNVŌ܂œǂ߂Ăΐݒ肷
+    bool Create(const uint8_t* data, uint64_t size, uint16_t skin_num, uint32_t vertex_num, uint64_t* read_size = nullptr);
+
+    // @brief XLZNV base ̒_ԍtւi_בւꍇɎgj
+    // @param remap ̒_ԍ -> V_ԍ
+    static bool RemapBaseVertices(uint8_t* data, uint64_t size, uint16_t skin_num, const std::vector<uint32_t>& remap);
+
+    // @brief ϊς݂ base ̒_ԍtւiCreate ɍς܂j
+    // @param remap ̒_ԍ -> V_ԍ
+    void RemapVertices(const std::vector<uint32_t>& remap);
+
+    uint32_t MorphNum() const;                  // base [t
+    const MorphInfo& GetMorph(uint32_t idx) const;
+    uint32_t FindMorphIndex(const std::string& name) const;
+
+    // @brief Ɨ̈
+    void InitState(State* state) const;
+
+    // @brief EFCgKpW𒸓_f[^ɏ
+    // @param weights  [t̃EFCgiMorphNum j
+    // @param state    InitState Ɨ̈
+    // @param vertices _f[^ie_̐擪ɍW float3 j
+    // @param stride   1_̃oCg
+    // @retval _͈̔
+    DirtyRange Apply(const float* weights, State* state, uint8_t* vertices, uint32_t stride) const;
+
+    // @brief S[tEFCg1ŏd˂ꍇ́A_̍őړʂ߂iE̊gpj
+    // @param vertex_num   f̒_
+    // @param displacement _̈ړʂ̏
+    void CalcMaxDisplacement(uint32_t vertex_num, std::vector<float>* displacement) const;
+
+private:
+
+    void SortBase();
+
+    std::vector<uint32_t>  m_BaseVertexIdx;     // base ԍ -> _ԍij
+    std::vector<float>     m_BasePosX;          // base ̊W
+    std::vector<float>     m_BasePosY;
+    std::vector<float>     m_BasePosZ;
+
+    std::vector<uint32_t>  m_EntryBaseIdx;      // ItZbg base ԍ
+    std::vector<float>     m_OffsetX;           // ItZbg
+    std::vector<float>     m_OffsetY;
+    std::vector<float>     m_OffsetZ;
+
+    std::vector<MorphInfo> m_Morphs;
+    std::unordered_map<std::string, uint32_t> m_MorphIndexTable;
+};
@@ -1,10 +1,12 @@
 
 #include "PMD.hpp"
+#include "PMDCache.hpp"
 
 #include "windows.h"
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
-#include <sstream>
 
 
 //
@@ -17,8 +19,7 @@ BoneTree::BoneNode::BoneNode()
     BoneType(0),
     ParentBone(0),
     IkParentBone(0),
-    BoneStartPos(),
-    m_Childlen()
+    BoneStartPos()
 {}
 
 BoneTree::BoneNode::BoneNode(int idx, const PMDBone& bone)
@@ -27,186 +28,252 @@ BoneTree::BoneNode::BoneNode(int idx, const PMDBone& bone)
     BoneType(bone.BoneType),
     ParentBone(bone.ParentBoneNo),
     IkParentBone(bone.IkBoneNo),
-    BoneStartPos(bone.Pos),
-    m_Childlen()
+    BoneStartPos(bone.Pos)
 {}
 
-void BoneTree::BoneNode::AddChild(const BoneNode* bonenode)
-{
-    m_Childlen.emplace_back(bonenode);
-}
-
-const std::vector<const BoneTree::BoneNode*>& BoneTree::BoneNode::GetChildlen() const
-{
-    return m_Childlen;
-}
-
 BoneTree::BoneTree()
-    : m_RawBonesData(),
-      m_BoneNodes()
+    :
+    m_BoneNodes(),
+    m_BoneIndexTable()
 {}
 
-void BoneTree::Create(const std::vector<PMDBone>& bones)
+void BoneTree::Create(const DataView<PMDBone>& bones)
 {
     CreateBoneTree(bones);
 }
 
-BoneTree::BoneNodeResult BoneTree::GetBoneNode(const std::string& bonename) const
+uint16_t BoneTree::FindBoneIndex(const std::string& bonename) const
 {
-    auto result = std::find_if(
-        m_BoneNodes.begin(),
-        m_BoneNodes.end(),
-        [bonename](const NamedBone& bone) {
-            return bone.BoneName == bonename;
-        }
-    );
-
-    if (result != m_BoneNodes.end()) {
-        return result->Node;
+    auto itr = m_BoneIndexTable.find(bonename);
+    if (itr == m_BoneIndexTable.end()) {
+        return k_InvalidBoneIdx;
     }
+    return itr->second;
+}
 
-    return std::nullopt;
-
-#if 0
-    auto result = m_BoneNodeTable.find(bonename);
-    if (result == m_BoneNodeTable.end()) {
-        return std::nullopt;
-    }
-    return result->second;
-#endif
+const BoneTree::BoneNode* BoneTree::GetBoneNode(const std::string& bonename) const
+{
+    return GetBoneNode(FindBoneIndex(bonename));
 }
 
-BoneTree::BoneNodeResult BoneTree::GetBoneNode(uint16_t idx) const
+const BoneTree::BoneNode* BoneTree::GetBoneNode(uint16_t idx) const
 {
     if (idx >= m_BoneNodes.size()) {
-        return std::nullopt;
+        return nullptr;
     }
 
-    return m_BoneNodes[idx].Node;
+    return &(m_BoneNodes[idx].Node);
 }
 
-std::string BoneTree::GetBoneNameFromIdx(uint16_t idx) const
+const std::string& BoneTree::GetBoneNameFromIdx(uint16_t idx) const
 {
+    static const std::string empty_name;
     if (idx >= m_BoneNodes.size()) {
-        return "";
+        return empty_name;
     }
     return m_BoneNodes[idx].BoneName;
-#if 0
-    auto itr = std::find_if(
-        m_BoneNodeTable.begin(),
-        m_BoneNodeTable.end(),
-        [idx](const std::pair<std::string, BoneNode>& pair) {
-            return pair.second.BoneIdx == idx;
-        }
-    );
-
-    if (itr != m_BoneNodeTable.end()) {
-        return itr->first;
-    }
-
-    return "";
-#endif
 }
 
-void BoneTree::CreateBoneTree(const std::vector<PMDBone>& bones)
+uint32_t BoneTree::BoneNum() const
 {
-    m_RawBonesData = bones;
+    return static_cast<uint32_t>(m_BoneNodes.size());
+}
 
+void BoneTree::CreateBoneTree(const DataView<PMDBone>& bones)
+{
     // {[m[h}bv
+    // {[20byte傤ǂ̏ꍇI[̂ŁA𐧌ĕ񉻂
     m_BoneNodes.resize(bones.size());
-    for (int idx = 0; idx < m_RawBonesData.size(); ++idx) {
+    m_BoneIndexTable.clear();
+    m_BoneIndexTable.reserve(bones.size());
+    for (int idx = 0; idx < bones.size(); ++idx) {
         m_BoneNodes[idx] = NamedBone(
-            std::string(bones[idx].BoneName),
+            std::string(bones[idx].BoneName, strnlen(bones[idx].BoneName, sizeof(bones[idx].BoneName))),
             BoneNode(idx, bones[idx])
         );
-    }
-
-    // eq֌W\z
-    for (int idx = 0; idx < bones.size(); ++idx) {
-        // eCfbNX`FbNi肦ȂԍȂ΂j
-        if (bones[idx].ParentBoneNo >= bones.size()) {
-            continue;
-        }
-
-        // em[hɑ΂āAqm[hƂĒǉ
-        auto& parent_bone = m_BoneNodes[bones[idx].ParentBoneNo];
-        parent_bone.Node.AddChild(&(m_BoneNodes[idx].Node));
+        // ̃{[ꍇ́A`TĂƓ擪̂̂g
+        m_BoneIndexTable.emplace(m_BoneNodes[idx].BoneName, static_cast<uint16_t>(idx));
     }
 }
 
 PMDData::PMDData()
     :
+    m_File(),
     m_PMDHeader(),
     m_VertexNum(0),
     m_VerticesBuff(),
+    m_VertexData(nullptr),
     m_IndexNum(0),
     m_IndicesBuff(),
+    m_IndicesView(nullptr),
+    m_MeshOptimized(false),
+    m_MeshOptimizeStats(),
+    m_Lods(),
+    m_LodIndicesBuff(),
+    m_LodIndicesView(nullptr),
+    m_LodIndexNum(0),
     m_MaterialNum(0),
-    m_MaterialBuff(),
+    m_MaterialView(),
+    m_Materials(),
+    m_TexturePaths(),
+    m_ShaderMaterialsBuff(),
+    m_ShaderMaterialData(nullptr),
     m_BoneNum(0),
-    m_BonesBuff(),
+    m_BonesView(),
     m_KneeIndexes(),
-    m_BoneTree()
+    m_BoneTree(),
+    m_Skeleton(),
+    m_IkNum(0),
+    m_PMDIkData(),
+    m_SkinNum(0),
+    m_SkinBuff(),
+    m_SkinData(nullptr),
+    m_SkinDataSize(0),
+    m_Morphs(),
+    m_Clusters()
 {}
 
-bool PMDData::Open(const std::filesystem::path& filename)
+bool PMDData::Open(const std::filesystem::path& filename, bool use_cache, bool optimize_mesh)
 {
-    char signature[3]{};
+    std::filesystem::path cache_path = PMDCache::CachePath(filename);
+
+    // LbVLȂ炻g
+    if (use_cache && PMDCache::Load(cache_path, filename, optimize_mesh, this)) {
+        return BuildClusters();
+    }
 
-    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
-    if (!ifs) {
+    if (!OpenPMD(filename, optimize_mesh)) {
+        return false;
+    }
+    if (!BuildClusters()) {
         return false;
     }
 
-    ifs.read(reinterpret_cast<char*>(&signature), sizeof(signature));
-    ifs.read(reinterpret_cast<char*>(&m_PMDHeader), sizeof(m_PMDHeader));
+    // NpɃLbV쐬isĂǂݍݎ̂͐j
+    if (use_cache && !PMDCache::Save(cache_path, filename, *this)) {
+        ::OutputDebugStringA("PMD cache could not be written.\n");
+    }
 
-    ifs.read(reinterpret_cast<char*>(&m_VertexNum), sizeof(m_VertexNum));
-    m_VerticesBuff.resize(VertexBuffSize());
+    return true;
+}
 
-    //std::ostringstream os;
-    //os << "VertexNum: " << m_VertexNum << std::endl;
+bool PMDData::OpenPMD(const std::filesystem::path& filename, bool optimize_mesh)
+{
+    // t@Cۂƃ}bvAeZNV̓}bvŒډ͂
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(filename)) {
+        return false;
+    }
+    MappedFileReader reader(file->Data(), file->Size());
+
+    char signature[3]{};
+    if (!reader.Read(&signature) || !reader.Read(&m_PMDHeader)) {
+        return false;
+    }
 
     // _obt@ǂݍ
-    char* ptr = reinterpret_cast<char*>(&m_VerticesBuff[0]);
+    // t@C1_38byteȂ̂ŁA40byte(PMDVertex)1ł܂Ƃ߂ĕϊ
+    if (!reader.Read(&m_VertexNum)) {
+        return false;
+    }
+    const uint8_t* src_vertices = reader.Bytes(static_cast<uint64_t>(m_VertexNum) * PMDVertex::k_PMDVertexSize);
+    if (src_vertices == nullptr) {
+        return false;
+    }
+    m_VerticesBuff.resize(VertexBuffSize());
+    uint8_t* dst_vertices = m_VerticesBuff.data();
     for (uint32_t i = 0; i < m_VertexNum; ++i) {
-        ifs.read(ptr, PMDVertex::k_PMDVertexSize);
+        std::memcpy(dst_vertices, src_vertices, PMDVertex::k_PMDVertexSize);
+        src_vertices += PMDVertex::k_PMDVertexSize;
+        dst_vertices += sizeof(PMDVertex);
+    }
+    m_VertexData = m_VerticesBuff.data();
 
-        PMDVertex* vtx = reinterpret_cast<PMDVertex*>(ptr);
-        //os << "Vertex (" << i << ") : pos_x[" << vtx->Pos.x << "], pos_y[" << vtx->Pos.y << "], pos_z[" << vtx->Pos.z << "]" << std::endl;
+    // _CfbNXǂݍ
+    // t@C 283 + 4 + 38 * _ + 4 ̊ItZbgɂAuint16_t ƂĒڂ͓ǂ߂Ȃ̂ŃRs[
+    if (!reader.Read(&m_IndexNum)) {
+        return false;
+    }
+    const uint8_t* src_indices = reader.Bytes(IndexBuffSize());
+    if (src_indices == nullptr) {
+        return false;
+    }
+    m_IndicesBuff.resize(m_IndexNum);
+    if (m_IndexNum > 0) {
+        std::memcpy(m_IndicesBuff.data(), src_indices, IndexBuffSize());
+    }
+    m_IndicesView = reinterpret_cast<const uint8_t*>(m_IndicesBuff.data());
+    // ͈͊O̒_ԍƁAבւȗ_Ŋmۂz̊OĜŁAŒeĂ
+    if (!IsIndexInRange(reinterpret_cast<const uint16_t*>(m_IndicesView), m_IndexNum, m_VertexNum)) {
+        return false;
+    }
+    m_MeshOptimized = false;
+    m_MeshOptimizeStats = MeshOptimizeStats();
 
-        ptr += sizeof(PMDVertex);
+    // }eAǂݍ݁iRs[t@C𒼐ڎQƁj
+    if (!reader.Read(&m_MaterialNum)) {
+        return false;
+    }
+    if (!reader.View(m_MaterialNum, &m_MaterialView)) {
+        return false;
     }
-    //::OutputDebugStringA(os.str().c_str());
 
-    // _CfbNXǂݍ
-    ifs.read(reinterpret_cast<char*>(&m_IndexNum), sizeof(m_IndexNum));
-    m_IndicesBuff.resize(IndexBuffSize());
-    ifs.read(reinterpret_cast<char*>(m_IndicesBuff.data()), m_IndicesBuff.size());
-
-    // }eAǂݍ
-    ifs.read(reinterpret_cast<char*>(&m_MaterialNum), sizeof(m_MaterialNum));
-    m_MaterialBuff.resize(MaterialNum());
-    ifs.read(reinterpret_cast<char*>(m_MaterialBuff.data()), MaterialBuffSize());
-
-    // {[ǂݍ
-    ifs.read(reinterpret_cast<char*>(&m_BoneNum), sizeof(m_BoneNum));
-    m_BonesBuff.resize(m_BoneNum);
-    ifs.read(reinterpret_cast<char*>(m_BonesBuff.data()), BoneBuffSize());
-    m_BoneTree.Create(m_BonesBuff);
-    // IK̃{[L^
-    for (int idx = 0; idx < m_BonesBuff.size(); ++idx) {
-        const std::string& bone_name = m_BoneTree.GetBoneNameFromIdx(idx);
-        if (bone_name.find("Ђ") != std::string::npos) {
-            m_KneeIndexes.emplace_back(idx);
-        }
+    // {[ǂݍ݁iRs[t@C𒼐ڎQƁj
+    if (!reader.Read(&m_BoneNum)) {
+        return false;
+    }
+    if (!reader.View(m_BoneNum, &m_BonesView)) {
+        return false;
     }
+    SetupBones();
 
     // IKǂݍ
-    ifs.read(reinterpret_cast<char*>(&m_IkNum), sizeof(m_IkNum));
-    ReadIKData(ifs);
+    if (!reader.Read(&m_IkNum)) {
+        return false;
+    }
+    if (!ReadIKData(reader)) {
+        return false;
+    }
+
+    // \iXLjǂݍ
+    // Âf[^ŃXLZNV̂ꍇ͕\ƂĈ
+    m_SkinNum = 0;
+    m_SkinBuff.clear();
+    m_SkinData = nullptr;
+    m_SkinDataSize = 0;
+    if (reader.Remaining() > 0) {
+        if (!reader.Read(&m_SkinNum)) {
+            return false;
+        }
+        m_SkinData = file->Data() + reader.Offset();
+        if (!m_Morphs.Create(m_SkinData, reader.Remaining(), m_SkinNum, m_VertexNum, &m_SkinDataSize)) {
+            // XL̃f[^̂rŐ؂Ăꍇ͓ǂݍݎs
+            if (m_SkinDataSize == 0) {
+                return false;
+            }
+            // base ȂǕ\ƂĎgȂȂA\̃fƂēǂݍ
+            ::OutputDebugStringA("PMD skins are invalid. Morphs are disabled.\n");
+            reader.Skip(m_SkinDataSize);
+            m_Morphs = MorphSet();
+            m_SkinNum = 0;
+            m_SkinData = nullptr;
+            m_SkinDataSize = 0;
+        }
+        else {
+            reader.Skip(m_SkinDataSize);
+        }
+    }
+
+    if (optimize_mesh) {
+        OptimizeMesh();
+    }
 
     CopyMaterialsData();
+    BuildShaderMaterials();
+    ResolveTexturePaths(filename);
+    BuildLods();
+
+    m_File = file;
 
     return true;
 }
@@ -228,7 +295,7 @@ uint64_t PMDData::VertexBuffSize() const
 
 const uint8_t* PMDData::GetVertexData() const
 {
-    return m_VerticesBuff.data();
+    return m_VertexData;
 }
 
 uint32_t PMDData::IndexNum() const
@@ -243,7 +310,32 @@ uint64_t PMDData::IndexBuffSize() const
 
 const uint8_t* PMDData::GetIndexData() const
 {
-    return m_IndicesBuff.data();
+    return m_IndicesView;
+}
+
+const MeshOptimizeStats& PMDData::GetMeshOptimizeStats() const
+{
+    return m_MeshOptimizeStats;
+}
+
+uint32_t PMDData::LodNum() const
+{
+    return static_cast<uint32_t>(m_Lods.size());
+}
+
+const MeshLod& PMDData::GetLod(uint32_t idx) const
+{
+    return m_Lods[idx];
+}
+
+uint32_t PMDData::LodIndexNum() const
+{
+    return m_LodIndexNum;
+}
+
+const uint8_t* PMDData::GetLodIndexData() const
+{
+    return m_LodIndicesView;
 }
 uint32_t PMDData::MaterialNum() const
 {
@@ -260,6 +352,26 @@ const std::vector<Material>& PMDData::GetMaterialData() const
     return m_Materials;
 }
 
+const DataView<PMDMaterial>& PMDData::GetRawMaterialData() const
+{
+    return m_MaterialView;
+}
+
+const std::vector<TexturePath>& PMDData::GetTexturePaths() const
+{
+    return m_TexturePaths;
+}
+
+uint64_t PMDData::ShaderMaterialBuffSize() const
+{
+    return static_cast<uint64_t>(MaterialNum()) * k_ShaderMaterialAlignedSize;
+}
+
+const uint8_t* PMDData::GetShaderMaterialData() const
+{
+    return m_ShaderMaterialData;
+}
+
 uint32_t PMDData::BoneNum() const
 {
     return m_BoneNum;
@@ -270,12 +382,17 @@ uint64_t PMDData::BoneBuffSize() const
     return static_cast<uint64_t>(BoneNum()) * sizeof(PMDBone);
 }
 
-BoneTree::BoneNodeResult PMDData::GetBoneFromName(const std::string& bonename) const
+uint16_t PMDData::FindBoneIndex(const std::string& bonename) const
+{
+    return m_BoneTree.FindBoneIndex(bonename);
+}
+
+const BoneTree::BoneNode* PMDData::GetBoneFromName(const std::string& bonename) const
 {
     return m_BoneTree.GetBoneNode(bonename);
 }
 
-BoneTree::BoneNodeResult PMDData::GetBoneFromIndex(uint16_t idx) const
+const BoneTree::BoneNode* PMDData::GetBoneFromIndex(uint16_t idx) const
 {
     return m_BoneTree.GetBoneNode(idx);
 }
@@ -285,86 +402,269 @@ const std::vector<uint32_t>& PMDData::GetBoneIndexes() const
     return m_KneeIndexes;
 }
 
-std::string PMDData::GetBoneName(uint16_t idx) const
+const std::string& PMDData::GetBoneName(uint16_t idx) const
 {
     return m_BoneTree.GetBoneNameFromIdx(idx);
 }
 
+const Skeleton& PMDData::GetSkeleton() const
+{
+    return m_Skeleton;
+}
+
+const MorphSet& PMDData::GetMorphs() const
+{
+    return m_Morphs;
+}
+
+const MeshClusterSet& PMDData::GetClusters() const
+{
+    return m_Clusters;
+}
+
 uint32_t PMDData::IKNum() const
 {
     return m_IkNum;
 }
 
-const std::vector<PMDIK> PMDData::GetPMDIKData() const
+const std::vector<PMDIK>& PMDData::GetPMDIKData() const
 {
     return m_PMDIkData;
 }
 
 
 
-void PMDData::CopyMaterialsData()
+void PMDData::SetupBones()
 {
-    m_Materials.resize(m_MaterialNum);
+    m_BoneTree.Create(m_BonesView);
+    m_Skeleton.Create(m_BonesView);
 
-    for (int i = 0; i < m_MaterialNum; ++i) {
-        m_Materials[i].IndicesNum = m_MaterialBuff[i].IndicesNum;
-        m_Materials[i].MaterialForShader.Diffuse = m_MaterialBuff[i].Diffuse;
-        m_Materials[i].MaterialForShader.Alpha = m_MaterialBuff[i].Alpha;
-        m_Materials[i].MaterialForShader.Specular = m_MaterialBuff[i].Specular;
-        m_Materials[i].MaterialForShader.Specularity = m_MaterialBuff[i].Specularity;
-        m_Materials[i].MaterialForShader.Ambient = m_MaterialBuff[i].Ambient;
+    // IK̃{[L^
+    m_KneeIndexes.clear();
+    for (int idx = 0; idx < m_BonesView.size(); ++idx) {
+        const std::string& bone_name = m_BoneTree.GetBoneNameFromIdx(idx);
+        if (bone_name.find("Ђ") != std::string::npos) {
+            m_KneeIndexes.emplace_back(idx);
+        }
+    }
+}
 
-        m_Materials[i].Additional.TexturePath += m_MaterialBuff[i].TexFilePath;
-        m_Materials[i].Additional.ToonIdx = m_MaterialBuff[i].ToonIdx;
-        //std::copy_n(m_MaterialBuff[i].TexFilePath, PMDMaterial::k_TextureFilePathLen, m_Materials[i].Additional.TexturePath.begin());
+bool PMDData::IsIndexInRange(const uint16_t* indices, uint32_t index_num, uint32_t vertex_num)
+{
+    for (uint32_t i = 0; i < index_num; ++i) {
+        if (indices[i] >= vertex_num) {
+            return false;
+        }
     }
+    return true;
 }
 
-void PMDData::ReadIKData( std::ifstream& ifs )
+bool PMDData::SetupMorphs()
 {
-    m_PMDIkData.resize(m_IkNum);
+    return m_Morphs.Create(m_SkinData, m_SkinDataSize, m_SkinNum, m_VertexNum);
+}
 
-    for (auto& ik : m_PMDIkData) {
-        ifs.read(reinterpret_cast<char*>(&ik.BoneIdx), sizeof(ik.BoneIdx));
-        ifs.read(reinterpret_cast<char*>(&ik.TargetIdx), sizeof(ik.TargetIdx));
+bool PMDData::BuildClusters()
+{
+    // \œ_́ÄړʂELĂ
+    std::vector<float> inflate;
+    m_Morphs.CalcMaxDisplacement(m_VertexNum, &inflate);
 
-        uint8_t chain_len = 0;      // Ԃɂm[h邩H
-        ifs.read(reinterpret_cast<char*>(&chain_len), sizeof(chain_len));
-        ik.NodeIdxes.resize(chain_len);
-        ifs.read(reinterpret_cast<char*>(&ik.Iterations), sizeof(ik.Iterations));
-        ifs.read(reinterpret_cast<char*>(&ik.Limit), sizeof(ik.Limit));
+    std::vector<uint32_t> material_index_nums(m_Materials.size());
+    for (size_t i = 0; i < m_Materials.size(); ++i) {
+        material_index_nums[i] = m_Materials[i].IndicesNum;
+    }
+
+    if (!m_Clusters.Build(
+        reinterpret_cast<const uint16_t*>(m_IndicesView),
+        m_IndexNum,
+        reinterpret_cast<const PMDVertex*>(m_VertexData),
+        m_VertexNum,
+        material_index_nums,
+        &inflate
+    )) {
+        return false;
+    }
+
+    return true;
+}
+
+void PMDData::BuildLods()
+{
+    m_Lods.clear();
+    m_LodIndicesBuff.clear();
+    m_LodIndicesView = nullptr;
+    m_LodIndexNum = 0;
+    if (m_VertexNum == 0 || m_IndexNum == 0) {
+        return;
+    }
+
+    // 덷̏̓f̑傫iAABB̑ΊpjɌ߂
+    const PMDVertex* vertices = reinterpret_cast<const PMDVertex*>(m_VertexData);
+    DirectX::XMFLOAT3 aabb_min = vertices[0].Pos;
+    DirectX::XMFLOAT3 aabb_max = vertices[0].Pos;
+    for (uint32_t i = 1; i < m_VertexNum; ++i) {
+        const auto& pos = vertices[i].Pos;
+        aabb_min = DirectX::XMFLOAT3(std::min(aabb_min.x, pos.x), std::min(aabb_min.y, pos.y), std::min(aabb_min.z, pos.z));
+        aabb_max = DirectX::XMFLOAT3(std::max(aabb_max.x, pos.x), std::max(aabb_max.y, pos.y), std::max(aabb_max.z, pos.z));
+    }
+    const float dx = aabb_max.x - aabb_min.x;
+    const float dy = aabb_max.y - aabb_min.y;
+    const float dz = aabb_max.z - aabb_min.z;
+    const float max_error = std::sqrt(dx * dx + dy * dy + dz * dz) * k_LodMaxErrorRatio;
+
+    // 1O̒iɁA}eAɎOp`炵Ă
+    const uint16_t* src_indices = reinterpret_cast<const uint16_t*>(m_IndicesView);
+    std::vector<uint16_t> prev_indices(src_indices, src_indices + m_IndexNum);
+    std::vector<uint32_t> prev_material_nums(m_MaterialNum);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < m_MaterialNum; ++i) {
+        prev_material_nums[i] = std::min<uint32_t>(m_MaterialView[i].IndicesNum, m_IndexNum - offset);
+        offset += prev_material_nums[i];
+    }
+    float prev_error = 0.0f;
+
+    std::vector<uint16_t> lod_indices;
+    std::vector<uint16_t> simplified;
+    for (uint32_t level = 0; level < k_MaxLodNum; ++level) {
+        MeshLod lod;
+        lod.IndexOffset = static_cast<uint32_t>(m_LodIndicesBuff.size());
+        lod.MaterialIndexNums.resize(m_MaterialNum);
+
+        lod_indices.clear();
+        float error = 0.0f;
+        offset = 0;
+        for (uint32_t i = 0; i < m_MaterialNum; ++i) {
+            const uint32_t count = prev_material_nums[i];
+            const uint32_t target = static_cast<uint32_t>(count / 3 * k_LodReduceRatio) * 3;
+            error = std::max(error, MeshSimplifier::Simplify(
+                &prev_indices[offset], count, vertices, m_VertexNum, target, max_error, &simplified
+            ));
+            if (m_MeshOptimized) {
+                MeshOptimizer::OptimizeVertexCache(simplified.data(), static_cast<uint32_t>(simplified.size()), m_VertexNum);
+            }
+            lod.MaterialIndexNums[i] = static_cast<uint32_t>(simplified.size());
+            lod_indices.insert(lod_indices.end(), simplified.begin(), simplified.end());
+            offset += count;
+        }
 
-        if (chain_len == 0) {
-            continue;
+        // قƂǌȂȂ炻ȏ͍Ȃ
+        if (lod_indices.size() * 10 > prev_indices.size() * 9) {
+            break;
         }
-        ifs.read(reinterpret_cast<char*>(ik.NodeIdxes.data()), sizeof(ik.NodeIdxes[0]) * chain_len);
+
+        lod.IndexNum = static_cast<uint32_t>(lod_indices.size());
+        lod.Error = prev_error + error;
+        m_LodIndicesBuff.insert(m_LodIndicesBuff.end(), lod_indices.begin(), lod_indices.end());
+
+        prev_indices.swap(lod_indices);
+        prev_material_nums = lod.MaterialIndexNums;
+        prev_error = lod.Error;
+        m_Lods.emplace_back(std::move(lod));
+    }
+
+    m_LodIndexNum = static_cast<uint32_t>(m_LodIndicesBuff.size());
+    m_LodIndicesView = reinterpret_cast<const uint8_t*>(m_LodIndicesBuff.data());
+}
+
+void PMDData::OptimizeMesh()
+{
+    // CfbNX͓ǂݍݎ m_IndicesBuff ɃRs[Ă̂ŁȀŕבւ
+    m_MeshOptimizeStats.AcmrBefore = MeshOptimizer::CalcACMR(m_IndicesBuff.data(), m_IndexNum, m_VertexNum);
+
+    // }eA̋؂܂Ȃ悤A}eAɎOp`בւ
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < m_MaterialNum; ++i) {
+        const uint32_t count = std::min<uint32_t>(m_MaterialView[i].IndicesNum, m_IndexNum - offset);
+        MeshOptimizer::OptimizeVertexCache(&m_IndicesBuff[offset], count, m_VertexNum);
+        offset += count;
+    }
+    // _tFb`œK͒_ԍtւ邾ŁAACMR ͕ςȂ
+    m_MeshOptimizeStats.AcmrAfter = MeshOptimizer::CalcACMR(m_IndicesBuff.data(), m_IndexNum, m_VertexNum);
+
+    // _QƏɕבւA_ԍf[^iXL basejtւ
+    std::vector<uint32_t> remap;
+    MeshOptimizer::OptimizeVertexFetch(
+        m_IndicesBuff.data(), m_IndexNum, m_VerticesBuff.data(), m_VertexNum, VertexStrideByte(), &remap
+    );
+    if (m_SkinDataSize > 0) {
+        m_SkinBuff.assign(m_SkinData, m_SkinData + m_SkinDataSize);
+        MorphSet::RemapBaseVertices(m_SkinBuff.data(), m_SkinBuff.size(), m_SkinNum, remap);
+        m_SkinData = m_SkinBuff.data();
+        // ϊς݂̕\͍蒼Abase ̒_ԍtւ
+        m_Morphs.RemapVertices(remap);
+    }
+    m_MeshOptimized = true;
+}
+
+void PMDData::CopyMaterialsData()
+{
+    m_Materials.resize(m_MaterialNum);
+
+    for (int i = 0; i < m_MaterialNum; ++i) {
+        m_Materials[i].IndicesNum = m_MaterialView[i].IndicesNum;
+        m_Materials[i].MaterialForShader.Diffuse = m_MaterialView[i].Diffuse;
+        m_Materials[i].MaterialForShader.Alpha = m_MaterialView[i].Alpha;
+        m_Materials[i].MaterialForShader.Specular = m_MaterialView[i].Specular;
+        m_Materials[i].MaterialForShader.Specularity = m_MaterialView[i].Specularity;
+        m_Materials[i].MaterialForShader.Ambient = m_MaterialView[i].Ambient;
+
+        m_Materials[i].Additional.TexturePath.assign(
+            m_MaterialView[i].TexFilePath,
+            strnlen(m_MaterialView[i].TexFilePath, PMDMaterial::k_TextureFilePathLen)
+        );
+        m_Materials[i].Additional.ToonIdx = m_MaterialView[i].ToonIdx;
+        //std::copy_n(m_MaterialView[i].TexFilePath, PMDMaterial::k_TextureFilePathLen, m_Materials[i].Additional.TexturePath.begin());
     }
+}
 
-    DebugPrintIKData();
+void PMDData::BuildShaderMaterials()
+{
+    // 萔obt@ɂ̂܂܏߂悤A256byte PʂŕׂĂ
+    m_ShaderMaterialsBuff.assign(ShaderMaterialBuffSize(), 0);
+
+    uint8_t* dst = m_ShaderMaterialsBuff.data();
+    for (const auto& m : m_Materials) {
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(&m.MaterialForShader);
+        std::copy_n(src, k_ShaderMaterialSize, dst);
+        dst += k_ShaderMaterialAlignedSize;
+    }
+    m_ShaderMaterialData = m_ShaderMaterialsBuff.data();
 }
 
-void PMDData::DebugPrintIKData()
+void PMDData::ResolveTexturePaths(const std::filesystem::path& model_path)
 {
+    m_TexturePaths.resize(m_Materials.size());
+    for (size_t i = 0; i < m_Materials.size(); ++i) {
+        std::filesystem::path filepath = m_Materials[i].Additional.TexturePath;
+        m_TexturePaths[i] = GetTexturePathFromModelAndTexPath(model_path, filepath);
+    }
+}
+
+bool PMDData::ReadIKData(MappedFileReader& reader)
+{
+    m_PMDIkData.resize(m_IkNum);
 
     for (auto& ik : m_PMDIkData) {
-        std::ostringstream oss;
-        oss << "IKBoneNum = " << ik.BoneIdx
-            << ":" << m_BoneTree.GetBoneNameFromIdx(ik.BoneIdx) << std::endl;
-        oss << "IKBoneTarget = " << ik.TargetIdx
-            << ":" << m_BoneTree.GetBoneNameFromIdx(ik.TargetIdx) << std::endl;
-
-        auto bone = m_BoneTree.GetBoneNode(ik.BoneIdx);
-        if (bone) {
-            uint32_t parent_bone_idx = bone.value().IkParentBone;
-            oss << "IKBoneParent = " << parent_bone_idx
-                << ":" << m_BoneTree.GetBoneNameFromIdx(parent_bone_idx) << std::endl;
-        }
-        
-        for (auto& node : ik.NodeIdxes) {
-            oss << "\tNodeBone = " << node
-                << ":" << m_BoneTree.GetBoneNameFromIdx(ik.BoneIdx) << std::endl;
+        uint8_t chain_len = 0;      // Ԃɂm[h邩H
+        if (!reader.Read(&ik.BoneIdx) ||
+            !reader.Read(&ik.TargetIdx) ||
+            !reader.Read(&chain_len) ||
+            !reader.Read(&ik.Iterations) ||
+            !reader.Read(&ik.Limit)) {
+            return false;
         }
 
-        ::OutputDebugStringA(oss.str().c_str());
+        DataView<uint16_t> nodes;
+        if (!reader.View(chain_len, &nodes)) {
+            return false;
+        }
+        // t@C̈ʒu̓ACĂȂ̂ memcpy ŃRs[
+        ik.NodeIdxes.resize(chain_len);
+        if (chain_len > 0) {
+            std::memcpy(ik.NodeIdxes.data(), nodes.data(), sizeof(ik.NodeIdxes[0]) * chain_len);
+        }
     }
+
+    return true;
 }
\ No newline at end of file
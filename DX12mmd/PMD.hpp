@@ -3,12 +3,20 @@
 #include <cstdint>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <optional>
 #include <filesystem>
 #include <DirectXMath.h>
 
 #include "Matrix.hpp"
+#include "MappedFile.hpp"
+#include "FilePath.hpp"
+#include "Skeleton.hpp"
+#include "Morph.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshCluster.hpp"
+#include "MeshSimplifier.hpp"
 
 struct PMDHeader
 {
@@ -60,6 +68,21 @@ struct PMDBone
 };
 #pragma pack()
 
+#pragma pack(1)
+struct PMDSkinHeader
+{
+    char     SkinName[20];              // XL
+    uint32_t SkinVertexNum;             // XL̒_
+    uint8_t  SkinType;                  // XL̎ށi0:base, 1:܂, 2:, 3:bv, 4:̑j
+};
+
+struct PMDSkinVertex
+{
+    uint32_t SkinVertexIdx;             // base ͒_ԍAȊO base ̔ԍ
+    DirectX::XMFLOAT3 SkinVertexPos;    // base ͍WAȊO base ̃ItZbg
+};
+#pragma pack()
+
 enum class BoneType : uint32_t 
 {
     Rotation   = 0,         // ]
@@ -82,19 +105,13 @@ public:
         BoneNode();
         BoneNode(int boneidx, const PMDBone& bone);
 
-        void AddChild(const BoneNode* bonenode);
-        const std::vector<const BoneNode*>& GetChildlen() const;
-
         uint32_t          BoneIdx;           // {[CfbNX
         uint32_t          BoneType;          // {[
         uint32_t          ParentBone;        // e{[
         uint32_t          IkParentBone;      // IKe{[
         DirectX::XMFLOAT3 BoneStartPos;      // {[_i]̒Sj
         //DirectX::XMFLOAT3 BoneEndPos;        // {[[_iۂ̃XLjOɂ͉eȂj
-
-    private:
-
-        std::vector<const BoneNode*> m_Childlen;   // qm[h
+        // eq֌W Skeleton RzŎ
     };
 
     struct NamedBone {
@@ -105,23 +122,29 @@ public:
         std::string BoneName;
         BoneNode    Node;
     };
-    typedef std::optional<BoneTree::BoneNode> BoneNodeResult;
+
+    static constexpr uint16_t k_InvalidBoneIdx = 0xFFFF;
 
 public:
 
     BoneTree();
 
-    void Create(const std::vector<PMDBone>& bones);
-    BoneNodeResult GetBoneNode(const std::string& bonename) const;
-    BoneNodeResult GetBoneNode(uint16_t idx) const;
-    std::string GetBoneNameFromIdx(uint16_t idx) const;
+    void Create(const DataView<PMDBone>& bones);
+
+    // {[͓̌ǂݍݎɍnbV\
+    // t[̏ł̓CfbNXgƁirmۂȂj
+    uint16_t FindBoneIndex(const std::string& bonename) const;       // Ȃ k_InvalidBoneIdx
+    const BoneNode* GetBoneNode(const std::string& bonename) const;  // Ȃ nullptr
+    const BoneNode* GetBoneNode(uint16_t idx) const;                 // ͈͊OȂ nullptr
+    const std::string& GetBoneNameFromIdx(uint16_t idx) const;       // ͈͊OȂ󕶎
+    uint32_t BoneNum() const;
 
 private:
 
-    void CreateBoneTree(const std::vector<PMDBone>& bones);
+    void CreateBoneTree(const DataView<PMDBone>& bones);
 
-    std::vector<PMDBone>      m_RawBonesData;
     std::vector<NamedBone>    m_BoneNodes;
+    std::unordered_map<std::string, uint16_t> m_BoneIndexTable;     // {[ -> {[CfbNX
 };
 
 struct PMDIK
@@ -163,13 +186,21 @@ class PMDData
 {
 public:
     static constexpr uint32_t k_ShaderMaterialSize = sizeof(MaterialForHlsl);
+    static constexpr uint32_t k_ShaderMaterialAlignedSize = (k_ShaderMaterialSize + 0xFF) & ~0xFF;    // 萔obt@1̃TCY
     static constexpr uint32_t k_PMDBoneMetricesNum = k_BoneMetricesNum;
+    static constexpr uint32_t k_MaxLodNum = 3;                  // ̃bVȊOɍLOD̐
+    static constexpr float    k_LodReduceRatio = 0.5f;          // LOD1iɎcOp`̊
+    static constexpr float    k_LodMaxErrorRatio = 0.02f;       // LOD1iŋ덷if̑傫ɑ΂銄j
 
 public:
 
     PMDData();
 
-    bool Open(const std::filesystem::path& filename);
+    // @brief PMDt@CJ
+    // @param filename  PMDt@CpX
+    // @param use_cache true Ȃ烂fƓꏊ .pmdc LbVgiEÂꍇ͍蒼j
+    // @param optimize_mesh true Ȃ璸_LbVE_tFb`ɃCfbNXƒ_בւ
+    bool Open(const std::filesystem::path& filename, bool use_cache = true, bool optimize_mesh = true);
 
     uint32_t VertexNum() const;             // _
     uint32_t VertexStrideByte() const;      // 1_̃oCg
@@ -179,45 +210,97 @@ public:
     uint32_t IndexNum() const;
     uint64_t IndexBuffSize() const;
     const uint8_t* GetIndexData() const;
+    // בւO ACMRiבւĂȂELbVǂ񂾏ꍇ 0j
+    const MeshOptimizeStats& GetMeshOptimizeStats() const;
+
+    // LODiCfbNXobt@ł͌̃CfbNX̌ɑĒuj
+    uint32_t LodNum() const;                                     // ̃bVLOD̐
+    const MeshLod& GetLod(uint32_t idx) const;
+    uint32_t LodIndexNum() const;                                // SLOD̃CfbNX
+    const uint8_t* GetLodIndexData() const;
 
     uint32_t MaterialNum() const;
     uint64_t MaterialBuffSize() const;
     const std::vector<Material>& GetMaterialData() const;
+    const DataView<PMDMaterial>& GetRawMaterialData() const;
+    const std::vector<TexturePath>& GetTexturePaths() const;      // }eẢς݃eNX`pX
+    uint64_t ShaderMaterialBuffSize() const;
+    const uint8_t* GetShaderMaterialData() const;                // 256byte ACꂽVF[_[p}eA
 
     uint32_t BoneNum() const;
     uint64_t BoneBuffSize() const;
-    BoneTree::BoneNodeResult GetBoneFromName(const std::string& bonename) const;
-    BoneTree::BoneNodeResult GetBoneFromIndex(uint16_t idx) const;
+    uint16_t FindBoneIndex(const std::string& bonename) const;
+    const BoneTree::BoneNode* GetBoneFromName(const std::string& bonename) const;
+    const BoneTree::BoneNode* GetBoneFromIndex(uint16_t idx) const;
     const std::vector<uint32_t>& GetBoneIndexes() const;
-    std::string GetBoneName(uint16_t idx) const;
+    const std::string& GetBoneName(uint16_t idx) const;
+    const Skeleton& GetSkeleton() const;
 
     uint32_t IKNum() const;
-    const std::vector<PMDIK> GetPMDIKData() const;
+    const std::vector<PMDIK>& GetPMDIKData() const;
+
+    const MorphSet& GetMorphs() const;
+
+    const MeshClusterSet& GetClusters() const;                  // }eÃNX^iJOpj
 
 private:
 
+    friend class PMDCache;
+
+    bool OpenPMD(const std::filesystem::path& filename, bool optimize_mesh);
+    void OptimizeMesh();
+    void SetupBones();
+    bool SetupMorphs();
+    static bool IsIndexInRange(const uint16_t* indices, uint32_t index_num, uint32_t vertex_num);
+    bool BuildClusters();
+    void BuildLods();
     void CopyMaterialsData();
-    void ReadIKData(std::ifstream& ifs);
-    void DebugPrintIKData();
+    void BuildShaderMaterials();
+    void ResolveTexturePaths(const std::filesystem::path& model_path);
+    bool ReadIKData(MappedFileReader& reader);
+
+    MappedFilePtr m_File;                                 // }bvPMDt@C܂ .pmdc LbViCfbNXE}eAE{[͂𒼐ڎQƁj
 
     PMDHeader m_PMDHeader;
     uint32_t  m_VertexNum;
-    std::vector<uint8_t> m_VerticesBuff;
+    std::vector<uint8_t> m_VerticesBuff;                  // 38byte -> 40byte ɕϊ_f[^
+    const uint8_t* m_VertexData;                          // _f[^im_VerticesBuff ܂̓LbVwj
 
     uint32_t  m_IndexNum;
-    std::vector<uint8_t> m_IndicesBuff;
+    std::vector<uint16_t> m_IndicesBuff;                  // PMDǂ񂾃CfbNXf[^it@C̓ACĂȂ̂ŃRs[j
+    const uint8_t* m_IndicesView;                         // CfbNXf[^im_IndicesBuff ܂̓LbVwj
+    bool      m_MeshOptimized;                            // CfbNXE_בւς݂
+    MeshOptimizeStats m_MeshOptimizeStats;                // בւO ACMR
+
+    std::vector<MeshLod>  m_Lods;                         // LOD̃CfbNX͈̔
+    std::vector<uint16_t> m_LodIndicesBuff;               // SLOD̃CfbNXi쐬ꍇ̂݁j
+    const uint8_t* m_LodIndicesView;                      // SLOD̃CfbNXim_LodIndicesBuff ܂̓LbVwj
+    uint32_t  m_LodIndexNum;
     
     uint32_t  m_MaterialNum;
-    std::vector<PMDMaterial> m_MaterialBuff;
+    DataView<PMDMaterial> m_MaterialView;                 // }eAf[^i}bvt@Cwj
     std::vector<Material> m_Materials;
+    std::vector<TexturePath> m_TexturePaths;              // }eẢς݃eNX`pX
+    std::vector<uint8_t> m_ShaderMaterialsBuff;           // VF[_[p}eAi256byteACj
+    const uint8_t* m_ShaderMaterialData;                  // VF[_[p}eAim_ShaderMaterialsBuff ܂̓LbVwj
 
     // {[Ǘpϐ
     uint16_t  m_BoneNum;                                  // {[
-    std::vector<PMDBone>  m_BonesBuff;                    // {[ۑpobt@
+    DataView<PMDBone>     m_BonesView;                    // {[f[^i}bvt@Cwj
     std::vector<uint32_t> m_KneeIndexes;                  // Ђ{[̃Xg(IKŎgp)
     BoneTree  m_BoneTree;                                 // {[ǗNX
+    Skeleton  m_Skeleton;                                 // R{[Kwit[̍svZpj
 
     // IKǗpϐ
     uint16_t  m_IkNum;                                    // IK
     std::vector<PMDIK>   m_PMDIkData;                     // IKǂݏof[^
+
+    // \iXLjǗpϐ
+    uint16_t  m_SkinNum;                                  // XLibase ܂ށj
+    std::vector<uint8_t> m_SkinBuff;                      // _ԍtւXLZNViœKꍇ̂݁j
+    const uint8_t* m_SkinData;                            // XLZNVi}bvt@C܂ m_SkinBuff wj
+    uint64_t  m_SkinDataSize;                             // XLZNṼoCg
+    MorphSet  m_Morphs;                                   // ϊς݂̃[t
+
+    MeshClusterSet m_Clusters;                            // }eÃNX^iǂݍݖɍ蒼j
 };
\ No newline at end of file
@@ -1,25 +1,42 @@
 #include <sstream>
-#include <array>
 #include <algorithm>
+#include <cmath>
 
 #include "PMDActor.hpp"
 #include "FilePath.hpp"
-
-#pragma comment(lib, "winmm.lib")
+#include "Hash.hpp"
 
 namespace
 {
     void WriteMaterial(void* srcdata, uint8_t* dst)
     {
+        // VF[_[p}eA͓ǂݍݎ256byteACŕׂĂ̂ŁA܂Ƃ߂ăRs[
         PMDData* data = reinterpret_cast<PMDData*>(srcdata);
-        const auto& material_data = data->GetMaterialData();
-        uint32_t material_buff_size = (PMDData::k_ShaderMaterialSize + 0xFF) & ~0xFF;
+        std::copy_n(data->GetShaderMaterialData(), data->ShaderMaterialBuffSize(), dst);
+    }
 
-        for (const auto& itr : material_data) {
-            const uint8_t* src = reinterpret_cast<const uint8_t*>(&itr.MaterialForShader);
-            std::copy_n(src, PMDData::k_ShaderMaterialSize, dst);
-            dst += material_buff_size;
-        }
+    // gD[eNX`̃pX쐬
+    std::filesystem::path ToonTexturePath(const Material& material)
+    {
+        std::ostringstream os;
+        std::filesystem::path filepath;
+
+        // ۂtoonԍ L^ꂽԍ+1iuint8_t TCYWrapj
+        uint8_t toonidx = (material.Additional.ToonIdx + 1);
+        filepath += L"toon/toon";
+        os << std::setfill('0') << std::right << std::setw(2) << static_cast<int>(toonidx);
+
+        // string  wstring ɕϊ
+        // ASCII gĂȂƒfł̂ł̂悤ɂĂ
+        std::string number_str = os.str();
+        std::vector<wchar_t> wstr;
+        std::copy(number_str.begin(), number_str.end(), std::back_inserter(wstr));
+        wstr.push_back(L'\0');
+
+        filepath += wstr.data();
+        filepath += L".bmp";
+
+        return filepath;
     }
 }
 
@@ -30,10 +47,37 @@ PMDActor::PMDActor()
     m_ModelName(),
     m_ResourceManager(nullptr),
     m_PMDData(),
+    m_VMDData(),
+    m_MotionSampler(),
+    m_MotionSamples(),
+    m_UnmatchedMotionBones(),
+    m_IKEnable(),
+    m_BakedMotion(),
+    m_MotionStream(),
+    m_LocalPose(),
+    m_SkeletonPose(),
+    m_IKSolver(),
+    m_PoseLayers(),
     m_VertBuff(std::make_shared<VertexBufferPMD>()),
     m_IdxBuff(),
     m_MaterialBuff(),
-    m_BoneMetricesForMotion()
+    m_BoneMetricesForMotion(),
+    m_MorphTracks(),
+    m_MorphWeights(),
+    m_MorphState(),
+    m_MorphedVertices(),
+    m_MorphedVertexStride(0),
+    m_VertexUploadRange{ 0, 0 },
+    m_LodLevel(0),
+    m_DrawRanges(),
+    m_MaterialDrawRangeBegin(),
+    m_Clock(std::make_shared<HighResolutionClock>()),
+    m_AnimeStartTime(0.0),
+    m_LayerStartTime(0.0),
+    m_PoseEvaluated(false),
+    m_EvaluatedFrame(0.0f),
+    m_EvaluatedLayerFrame(0.0f),
+    m_EvaluatedLayerRevision(0)
 {}
 
 bool PMDActor::Create(
@@ -43,17 +87,62 @@ bool PMDActor::Create(
     const std::filesystem::path& vmd_filepath
 )
 {
-    if (!m_PMDData.Open(pmd_filepath)) {
+    if (!LoadModel(pmd_filepath)) {
+        return false;
+    }
+    if (!LoadMotion(vmd_filepath)) {
+        return false;
+    }
+
+    return CreateResources(resource_manager, model_name);
+}
+
+bool PMDActor::LoadModel(const std::filesystem::path& pmd_filepath, bool optimize_mesh, bool decode_textures)
+{
+    if (!m_PMDData.Open(pmd_filepath, true, optimize_mesh)) {
         return false;
     }
+    m_PMDModelPath = pmd_filepath;
+
+    if (decode_textures) {
+        DecodeTextures();
+    }
+
+    return true;
+}
+
+bool PMDActor::LoadMotion(const std::filesystem::path& vmd_filepath, const MotionCompressionSettings* compression)
+{
     if (!m_VMDData.Open(vmd_filepath)) {
         return false;
     }
+    // kłȂꍇAkÕ[Vł̂܂܍ĐłiGetVMDMotionTable().IsCompressed() ŊmFłj
+    if (compression) {
+        m_VMDData.Compress(*compression);
+    }
+    m_VMDMotionPath = vmd_filepath;
+
+    return true;
+}
+
+bool PMDActor::LoadMotionStream(const std::filesystem::path& vmd_filepath, ThreadPool* pool)
+{
+    // \EJȂǂ͏̂őSǂݍ݁A{[[VXg[~O
+    if (!m_VMDData.Open(vmd_filepath, false)) {
+        return false;
+    }
+    if (!m_MotionStream.Open(vmd_filepath, pool)) {
+        return false;
+    }
+    m_VMDMotionPath = vmd_filepath;
+
+    return true;
+}
 
+bool PMDActor::CreateResources(ResourceManager* resource_manager, const std::string& model_name)
+{
     m_ResourceManager = resource_manager;
     m_TextureManager.SetShaderResource(m_ResourceManager);
-    m_PMDModelPath = pmd_filepath;
-    m_VMDMotionPath = vmd_filepath;
     m_ModelName = model_name;
 
     auto vertbuff = std::make_shared<VertexBufferPMD>();
@@ -84,16 +173,42 @@ bool PMDActor::Create(
     ConstantBuffer::WriterFunc func = WriteMaterial;
     m_MaterialBuff->Write((void*)&m_PMDData, func);
 
-    // GPU]p{[sobt@
-    m_BoneMetricesForMotion.resize(k_BoneMetricesNum);
-    std::fill(m_BoneMetricesForMotion.begin(), m_BoneMetricesForMotion.end(), DirectX::XMMatrixIdentity());
+    // \GPUɓ]̂ƓtH[}bg̒_f[^
+    SetupMotion();
+    BindMorphs(m_VertBuff->GetVertexData(), m_VertBuff->VertexNum(), m_VertBuff->VertexStrideByte());
 
     CreateTextures();
 
+    // GPU֓]ÎŁAfR[hς݂̉摜͔j
+    m_DecodedImages.clear();
+
     return true;
 }
 
-VertexBufferPtr PMDActor::GetVertexBuffer()
+void PMDActor::CreateMotionOnly()
+{
+    // _obt@̂ŁA\̓f̒_f[^̎ʂ
+    SetupMotion();
+    BindMorphs(m_PMDData.GetVertexData(), m_PMDData.VertexNum(), m_PMDData.VertexStrideByte());
+    m_DecodedImages.clear();
+}
+
+void PMDActor::SetupMotion()
+{
+    // GPU]p{[sobt@
+    m_BoneMetricesForMotion.resize(k_BoneMetricesNum);
+    std::fill(m_BoneMetricesForMotion.begin(), m_BoneMetricesForMotion.end(), DirectX::XMMatrixIdentity());
+
+    // fƃ[V̗̂ŁA{[Ήt
+    BindMotion();
+    m_LocalPose.Resize(m_PMDData.GetSkeleton().BoneNum());
+    m_SkeletonPose.Bind(m_PMDData.GetSkeleton());
+    m_IKSolver.Bind(m_PMDData);
+    m_PoseLayers.Bind(m_PMDData);
+    m_LayerStartTime = m_Clock->Now();
+}
+
+VertexBufferPMDPtr PMDActor::GetVertexBuffer()
 {
     return m_VertBuff;
 }
@@ -118,88 +233,381 @@ const VMDMotionTable& PMDActor::GetVMDMotionTable() const
     return m_VMDData;
 }
 
-void PMDActor::RecursiveMatrixMultiply(
-    const BoneTree::BoneNode* node, const DirectX::XMMATRIX& mat
-)
+PMDActor::BoneMatrixBuffer& PMDActor::GetBoneMetricesForMotion()
+{
+    return m_BoneMetricesForMotion;
+}
+
+void PMDActor::SetClock(AnimationClockPtr clock)
+{
+    // ̋N_ς̂ŁAĐʒu͐V̎擾ōŏɂ
+    m_Clock = clock ? clock : std::make_shared<HighResolutionClock>();
+    m_AnimeStartTime = m_Clock->Now();
+    m_LayerStartTime = m_AnimeStartTime;
+    m_PoseEvaluated = false;
+}
+
+void PMDActor::PlayAnimation()
+{
+    m_AnimeStartTime = m_Clock->Now();
+    m_PoseEvaluated = false;
+}
+
+bool PMDActor::MotionUpdate()
+{
+    const double now = m_Clock->Now();
+    float frame = static_cast<float>((now - m_AnimeStartTime) * k_MotionFps);
+
+    // Ō̃L[t[̎̃t[Ő擪ɖ߂i͂ݏo͎̎Ɏzj
+    const float length = static_cast<float>(MaxKeyFrameNo() + 1);
+    if (frame >= length) {
+        const double loops = std::floor(frame / length);
+        m_AnimeStartTime += loops * length / k_MotionFps;
+        frame = static_cast<float>((now - m_AnimeStartTime) * k_MotionFps);
+        frame = std::clamp(frame, 0.0f, std::nextafter(length, 0.0f));
+    }
+    frame = std::max(frame, 0.0f);
+
+    const bool use_layers = !m_PoseLayers.IsEmpty();
+    const float layer_frame = static_cast<float>((now - m_LayerStartTime) * k_MotionFps);
+
+    // \̃t[[g[V荂ĂAiłȂΑO̎p̂܂
+    if (m_PoseEvaluated && frame == m_EvaluatedFrame &&
+        (!use_layers || (layer_frame == m_EvaluatedLayerFrame && m_PoseLayers.Revision() == m_EvaluatedLayerRevision))) {
+        return false;
+    }
+
+    bool pose_changed = true;
+    if (m_BakedMotion.IsValid() && !use_layers) {
+        // Ăݍς݂ȂÕt[Ԃ邾
+        m_BakedMotion.Sample(frame, m_BoneMetricesForMotion.data());
+        // {[s𒼐ڏ̂ŁAɎpvZƂ͑S蒼
+        m_SkeletonPose.Invalidate();
+    }
+    else {
+        pose_changed = EvaluatePose(frame, use_layers ? &layer_frame : nullptr);
+    }
+
+    MorphUpdate(frame);
+
+    m_PoseEvaluated = true;
+    m_EvaluatedFrame = frame;
+    m_EvaluatedLayerFrame = layer_frame;
+    m_EvaluatedLayerRevision = m_PoseLayers.Revision();
+
+    return pose_changed;
+}
+
+bool PMDActor::EvaluatePose(float frame, const float* layer_frame)
+{
+    // L[t[̑I͐Aԓ̕Ԃ͏܂Ŏg
+    const uint32_t frame_no = static_cast<uint32_t>(frame);
+    const bool streaming = m_MotionStream.IsOpen();
+    const uint32_t motion_num = streaming ?
+        m_MotionStream.Sample(frame_no, m_MotionSamples.data()) :
+        m_MotionSampler.Sample(frame_no, m_MotionSamples.data());
+    const auto& easing = streaming ? m_MotionStream.GetEasing() : m_VMDData.GetEasing();
+
+    // ]Eʒû܂܏dˍ킹āAŌ1񂾂sɂ
+    m_LocalPose.Reset();
+    m_LocalPose.Sample(m_MotionSamples.data(), motion_num, frame, easing);
+    if (layer_frame) {
+        // C[̓AN^[̃[VƂ͕ʂ̎ōĐ
+        m_PoseLayers.Apply(*layer_frame, &m_LocalPose);
+    }
+
+    // ͂̎pLIKOƓȂAIǨʂ܂߂đO̎p̂܂
+    const bool source_changed = m_SkeletonPose.SetSource(m_LocalPose);
+    const bool ik_changed = m_IKSolver.SetEnabled(m_IKEnable.Enabled(frame_no));
+    if (!source_changed && !ik_changed) {
+        return false;
+    }
+
+    // ς؂[hpvZȀIKĂAς{[̍s񂾂
+    m_SkeletonPose.UpdateWorld();
+    m_IKSolver.Solve(&m_SkeletonPose);
+    return m_SkeletonPose.WriteMatrices(m_BoneMetricesForMotion.data(), static_cast<uint32_t>(m_BoneMetricesForMotion.size()));
+}
+
+bool PMDActor::UseBakedMotion()
+{
+    // ĂݒɃ{[ŝŁA MotionUpdate ł͕KvZ
+    m_PoseEvaluated = false;
+
+    const uint32_t bone_num = std::min<uint32_t>(m_PMDData.GetSkeleton().BoneNum(), k_BoneMetricesNum);
+    const uint64_t hash = PoseSourceHash();
+    const std::filesystem::path baked_path = BakedMotion::BakedPath(m_VMDMotionPath, hash);
+    if (m_BakedMotion.Load(baked_path, m_VMDMotionPath, hash, bone_num)) {
+        return true;
+    }
+
+    // St[̎pʏ̍ĐƓ菇ŌvZďĂ
+    const uint32_t frame_num = MaxKeyFrameNo() + 1;
+    BakedMotion baked;
+    baked.Create(hash, bone_num, frame_num);
+    m_MotionSampler.Reset();
+    m_IKEnable.Reset();
+    m_IKSolver.ResetWarmStart();
+    for (uint32_t frame_no = 0; frame_no < frame_num; ++frame_no) {
+        EvaluatePose(static_cast<float>(frame_no), nullptr);
+        baked.SetFrame(frame_no, m_BoneMetricesForMotion.data());
+    }
+    m_MotionSampler.Reset();
+    m_IKEnable.Reset();
+    m_IKSolver.ResetWarmStart();
+    m_SkeletonPose.Invalidate();
+    if (!baked.IsValid()) {
+        return false;
+    }
+
+    // ۑɎsĂAĂ񂾎p͂̂܂܎gi܂Ăނj
+    baked.Save(baked_path, m_VMDMotionPath);
+    m_BakedMotion = std::move(baked);
+
+    return true;
+}
+
+bool PMDActor::IsBakedMotion() const
+{
+    return m_BakedMotion.IsValid();
+}
+
+bool PMDActor::IsStreamingMotion() const
 {
-    if (!node) {
+    return m_MotionStream.IsOpen();
+}
+
+PoseBlender& PMDActor::GetPoseLayers()
+{
+    return m_PoseLayers;
+}
+
+IKSolver& PMDActor::GetIKSolver()
+{
+    return m_IKSolver;
+}
+
+uint32_t PMDActor::MaxKeyFrameNo() const
+{
+    // Xg[~O VMDMotionTable Ƀ{[[V̂ŁA\Ȃǂ̍őƍ킹
+    return std::max(m_VMDData.MaxKeyFrameNo(), m_MotionStream.MaxKeyFrameNo());
+}
+
+uint64_t PMDActor::PoseSourceHash() const
+{
+    // IK̃`F[EςĂp͕ς̂ŁAXPg̃nbVɑČvZ
+    uint64_t hash = m_PMDData.GetSkeleton().Hash();
+    for (const auto& ik : m_PMDData.GetPMDIKData()) {
+        hash = HashFNV1a(&ik.BoneIdx, sizeof(ik.BoneIdx), hash);
+        hash = HashFNV1a(&ik.TargetIdx, sizeof(ik.TargetIdx), hash);
+        hash = HashFNV1a(&ik.Iterations, sizeof(ik.Iterations), hash);
+        hash = HashFNV1a(&ik.Limit, sizeof(ik.Limit), hash);
+        hash = HashFNV1a(ik.NodeIdxes.data(), ik.NodeIdxes.size() * sizeof(uint16_t), hash);
+    }
+    return hash;
+}
+
+void PMDActor::UpdateDrawRanges(const DirectX::XMMATRIX& world_view_proj, float proj_scale_y, float screen_height)
+{
+    DirectX::XMFLOAT4 bounds;
+    const uint32_t visible_num = m_PMDData.GetClusters().Cull(
+        world_view_proj,
+        m_BoneMetricesForMotion.data(),
+        static_cast<uint32_t>(m_BoneMetricesForMotion.size()),
+        &m_DrawRanges,
+        &m_MaterialDrawRangeBegin,
+        &bounds
+    );
+
+    // f̈ԎO̓_܂ł̋ŁAeLOĎ덷ʏŉsNZɂȂ邩
+    m_LodLevel = 0;
+    if (visible_num > 0 && m_PMDData.LodNum() > 0) {
+        const DirectX::XMVECTOR center = DirectX::XMVectorSet(bounds.x, bounds.y, bounds.z, 1.0f);
+        const float depth = DirectX::XMVectorGetW(DirectX::XMVector4Transform(center, world_view_proj)) - bounds.w;
+        if (depth > 0.0f) {
+            const float pixel_per_unit = proj_scale_y * screen_height * 0.5f / depth;
+            for (uint32_t i = 0; i < m_PMDData.LodNum(); ++i) {
+                if (m_PMDData.GetLod(i).Error * pixel_per_unit > k_LodPixelError) {
+                    break;
+                }
+                m_LodLevel = i + 1;
+            }
+        }
+    }
+    if (m_LodLevel == 0) {
         return;
     }
 
-    m_BoneMetricesForMotion[node->BoneIdx] *= mat;
-    
-    for (const auto child_node : node->GetChildlen())
-    {
-        RecursiveMatrixMultiply(child_node, m_BoneMetricesForMotion[node->BoneIdx]);
+    // LODł̓NX^Pʂł͂ȂAĂNX^}eA܂Ƃ߂ĕ`悷
+    // LOD̃CfbNX̓CfbNXobt@Ō̃CfbNX̌ɂ
+    const MeshLod& lod = m_PMDData.GetLod(m_LodLevel - 1);
+    const uint32_t material_num = static_cast<uint32_t>(m_MaterialDrawRangeBegin.size()) - 1;
+    uint32_t offset = m_PMDData.IndexNum() + lod.IndexOffset;
+    uint32_t write = 0;
+    for (uint32_t i = 0; i < material_num; ++i) {
+        const bool visible = m_MaterialDrawRangeBegin[i + 1] > m_MaterialDrawRangeBegin[i];
+        const uint32_t index_num = i < lod.MaterialIndexNums.size() ? lod.MaterialIndexNums[i] : 0;
+        m_MaterialDrawRangeBegin[i] = write;
+        if (visible && index_num > 0) {
+            m_DrawRanges[write++] = MeshClusterSet::DrawRange{ offset, index_num };
+        }
+        offset += index_num;
     }
+    m_MaterialDrawRangeBegin[material_num] = write;
+    m_DrawRanges.resize(write);
 }
 
-std::vector<DirectX::XMMATRIX>& PMDActor::GetBoneMetricesForMotion()
+uint32_t PMDActor::GetLodLevel() const
 {
-    return m_BoneMetricesForMotion;
+    return m_LodLevel;
 }
 
-void PMDActor::PlayAnimation()
+const MeshClusterSet::DrawRange* PMDActor::GetDrawRanges(uint32_t material_idx, uint32_t* range_num) const
+{
+    if (material_idx + 1 >= m_MaterialDrawRangeBegin.size()) {
+        *range_num = 0;
+        return nullptr;
+    }
+    const uint32_t begin = m_MaterialDrawRangeBegin[material_idx];
+    *range_num = m_MaterialDrawRangeBegin[material_idx + 1] - begin;
+    return m_DrawRanges.data() + begin;
+}
+
+void PMDActor::BindMotion()
 {
-    m_AnimeStartTimeMs = timeGetTime();
+    // {[̃gbNA{[ԍňl߂zɕג
+    // fɓ̃{[gbN m_UnmatchedMotionBones ɖOcĎ̂Ă
+    if (m_MotionStream.IsOpen()) {
+        m_MotionStream.Bind(m_PMDData, &m_UnmatchedMotionBones);
+        m_MotionSamples.resize(m_MotionStream.BoundTrackNum());
+    }
+    else {
+        m_MotionSampler.Bind(m_VMDData, m_PMDData, &m_UnmatchedMotionBones);
+        m_MotionSamples.resize(m_MotionSampler.BoundTrackNum());
+    }
+    // IK؂ւf[^̓Xg[~O VMDMotionTable ɓǂݍł
+    m_IKEnable.Bind(m_VMDData, m_PMDData);
 }
 
-void PMDActor::MotionUpdate()
+const std::vector<std::string>& PMDActor::GetUnmatchedMotionBones() const
 {
-    DWORD elapsed_time = timeGetTime() - m_AnimeStartTimeMs;
-    DWORD frame_no = 30 * (elapsed_time / 1000.0f);
+    return m_UnmatchedMotionBones;
+}
 
-    if (frame_no > m_VMDData.MaxKeyFrameNo()) {
-        PlayAnimation();
-        elapsed_time = 0;
+void PMDActor::BindMorphs(const uint8_t* vertices, uint32_t vertex_num, uint32_t stride)
+{
+    const MorphSet& morphs = m_PMDData.GetMorphs();
+    m_MorphTracks.clear();
+    if (morphs.MorphNum() == 0) {
+        return;
     }
 
-    std::fill(m_BoneMetricesForMotion.begin(), m_BoneMetricesForMotion.end(), DirectX::XMMatrixIdentity());
-    VMDMotionTable::NowMotionListPtr motions = m_VMDData.GetNowMotionList(frame_no);
-
-    for (const auto& motion : *motions) {
-        auto node = m_PMDData.GetBoneFromName(motion.Name);
-        if (node) {
-            auto idx = node.value().BoneIdx;
-            auto& pos = node.value().BoneStartPos;
-
-            DirectX::XMMATRIX rotation;
-            DirectX::XMVECTOR offset;
-            motion.Slerp(frame_no, &rotation, &offset);
-            auto mat =
-                DirectX::XMMatrixTranslation(-pos.x, -pos.y, -pos.z) *
-                rotation *
-                DirectX::XMMatrixTranslation(pos.x, pos.y, pos.z);
-
-            m_BoneMetricesForMotion[idx] = mat * DirectX::XMMatrixTranslationFromVector(offset);
+    // Oł̑Ήt͓ǂݍݎ1񂾂sAt[͔ԍŏ
+    for (const auto& morph_motion : m_VMDData.GetMorphTable()) {
+        uint32_t idx = morphs.FindMorphIndex(morph_motion.first);
+        if (idx != MorphSet::k_InvalidMorphIdx) {
+            m_MorphTracks.push_back(MorphTrack{ idx, &morph_motion.second });
         }
     }
 
-    auto root_bone = m_PMDData.GetBoneFromName("Z^[");
-    if (root_bone) {
-        RecursiveMatrixMultiply(&(root_bone.value()), DirectX::XMMatrixIdentity());
+    m_MorphWeights.assign(morphs.MorphNum(), 0.0f);
+    morphs.InitState(&m_MorphState);
+    m_MorphedVertices.assign(vertices, vertices + static_cast<size_t>(vertex_num) * stride);
+    m_MorphedVertexStride = stride;
+}
+
+void PMDActor::MorphUpdate(float frame)
+{
+    if (m_MorphWeights.empty()) {
+        return;
+    }
+
+    std::fill(m_MorphWeights.begin(), m_MorphWeights.end(), 0.0f);
+    for (const auto& track : m_MorphTracks) {
+        m_MorphWeights[track.MorphIdx] = VMDMotionTable::GetMorphWeight(*track.KeyFrames, frame);
+    }
+
+    // ω_͈̔͂oĂAUploadVertices ł܂Ƃ߂ē]
+    const MorphSet::DirtyRange range = m_PMDData.GetMorphs().Apply(
+        m_MorphWeights.data(), &m_MorphState, m_MorphedVertices.data(), m_MorphedVertexStride
+    );
+    if (range.empty()) {
+        return;
+    }
+    if (m_VertexUploadRange.empty()) {
+        m_VertexUploadRange = range;
+    }
+    else {
+        m_VertexUploadRange.Begin = std::min(m_VertexUploadRange.Begin, range.Begin);
+        m_VertexUploadRange.End = std::max(m_VertexUploadRange.End, range.End);
+    }
+}
+
+void PMDActor::UploadVertices()
+{
+    // CreateMotionOnly ŗpӂAN^[ɂ͓]悪
+    if (m_VertexUploadRange.empty() || m_ResourceManager == nullptr) {
+        return;
     }
 
-    IKSolve(frame_no);
+    const uint32_t stride = m_MorphedVertexStride;
+    const size_t offset = static_cast<size_t>(m_VertexUploadRange.Begin) * stride;
+    const size_t size = static_cast<size_t>(m_VertexUploadRange.End - m_VertexUploadRange.Begin) * stride;
+    m_VertBuff->UpdateVertexBuffer(m_MorphedVertices.data() + offset, offset, size);
+    m_VertexUploadRange = MorphSet::DirtyRange{ 0, 0 };
+}
+
+void PMDActor::DecodeTextures()
+{
+    const auto& materials = m_PMDData.GetMaterialData();
+    const auto& texture_paths = m_PMDData.GetTexturePaths();
+
+    auto decode = [this](const std::filesystem::path& filepath) {
+        if (filepath.empty() || m_DecodedImages.count(filepath.wstring()) > 0) {
+            return;
+        }
+        auto image = TextureGroup::DecodeImage(filepath);
+        if (image) {
+            m_DecodedImages[filepath.wstring()] = image;
+        }
+    };
+
+    for (size_t i = 0; i < materials.size(); ++i) {
+        decode(texture_paths[i].TexPath);
+        decode(texture_paths[i].SphereMapPath);
+        decode(texture_paths[i].AddSphereMapPath);
+
+        std::error_code ec;
+        auto toon_path = ToonTexturePath(materials[i]);
+        if (std::filesystem::exists(toon_path, ec) && !ec) {
+            decode(toon_path);
+        }
+    }
+}
+
+DecodedImagePtr PMDActor::FindDecodedImage(const std::filesystem::path& filepath) const
+{
+    auto itr = m_DecodedImages.find(filepath.wstring());
+    return itr == m_DecodedImages.end() ? nullptr : itr->second;
 }
 
 void PMDActor::CreateTextures()
 {
     const auto& materials = m_PMDData.GetMaterialData();
+    const auto& texture_paths = m_PMDData.GetTexturePaths();
     auto shader_resource_handle = m_ResourceManager->ResourceHandle(m_ModelName);
 
-    for (const auto& m : materials) {
-        std::filesystem::path filepath = m.Additional.TexturePath;
+    for (size_t i = 0; i < materials.size(); ++i) {
+        const auto& m = materials[i];
+        const TexturePath& texture_path = texture_paths[i];
         TexturePtr texture_handle;
-        TexturePath texture_path;
-
-        texture_path = GetTexturePathFromModelAndTexPath(m_PMDModelPath, filepath);
         
         shader_resource_handle.Offset += 1;
         if (!texture_path.TexPath.empty()) {
             m_TextureManager.CreateTextures(
                 texture_path.TexPath,
-                &texture_handle
+                &texture_handle,
+                FindDecodedImage(texture_path.TexPath)
             );
             m_TextureManager.CreateShaderResourceView(texture_handle, m_ResourceManager, shader_resource_handle);
             m_Textures.push_back(texture_handle);
@@ -217,7 +625,8 @@ void PMDActor::CreateTextures()
         if (!texture_path.SphereMapPath.empty()) {
             m_TextureManager.CreateTextures(
                 texture_path.SphereMapPath,
-                &texture_handle
+                &texture_handle,
+                FindDecodedImage(texture_path.SphereMapPath)
             );
             m_TextureManager.CreateShaderResourceView(texture_handle, m_ResourceManager, shader_resource_handle);
             m_Textures.push_back(texture_handle);
@@ -235,7 +644,8 @@ void PMDActor::CreateTextures()
         if (!texture_path.AddSphereMapPath.empty()) {
             m_TextureManager.CreateTextures(
                 texture_path.AddSphereMapPath,
-                &texture_handle
+                &texture_handle,
+                FindDecodedImage(texture_path.AddSphereMapPath)
             );
             m_TextureManager.CreateShaderResourceView(texture_handle, m_ResourceManager, shader_resource_handle);
             m_Textures.push_back(texture_handle);
@@ -259,23 +669,7 @@ void PMDActor::CreateTextures()
 
 void PMDActor::ReadToonTexture(const Material& material, const ResourceDescHandle& handle)
 {
-    std::ostringstream os;
-    std::filesystem::path filepath;
-
-    // ۂtoonԍ L^ꂽԍ+1iuint8_t TCYWrapj
-    uint8_t toonidx = (material.Additional.ToonIdx + 1);
-    filepath += L"toon/toon";
-    os << std::setfill('0') << std::right << std::setw(2) << static_cast<int>(toonidx);
-
-    // string  wstring ɕϊ
-    // ASCII gĂȂƒfł̂ł̂悤ɂĂ
-    std::string number_str = os.str();
-    std::vector<wchar_t> wstr;
-    std::copy(number_str.begin(), number_str.end(), std::back_inserter(wstr));
-    wstr.push_back(L'\0');
-
-    filepath += wstr.data();
-    filepath += L".bmp";
+    std::filesystem::path filepath = ToonTexturePath(material);
 
     std::error_code ec;
     bool result = std::filesystem::exists(filepath, ec);
@@ -283,7 +677,8 @@ void PMDActor::ReadToonTexture(const Material& material, const ResourceDescHandl
     if (!ec && result) {
         m_TextureManager.CreateTextures(
             filepath,
-            &texture_handle
+            &texture_handle,
+            FindDecodedImage(filepath)
         );
         m_TextureManager.CreateShaderResourceView(texture_handle, m_ResourceManager, handle);
         m_Textures.push_back(texture_handle);
@@ -297,328 +692,3 @@ void PMDActor::ReadToonTexture(const Material& material, const ResourceDescHandl
         m_Textures.push_back(texture_handle);
     }
 }
-
-// @brief Z̕Ɍs쐬
-// @param up    xNg
-// @param right ExNg
-XMMATRIX PMDActor::CreateLookAtMatrixZ(
-    const XMVECTOR& lookat,
-    const XMFLOAT3& up,
-    const XMFLOAT3& right
-)
-{
-    // (Z)
-    XMVECTOR vz = lookat;
-
-    // Ƃ́AYxNg
-    XMVECTOR vy_tmp = DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&up));
-
-    // O1ځBYgāAƂ̖{X, YxNgvZ
-    // 1. ZƉYOςāA܂XvZ
-    XMVECTOR vx = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(vy_tmp, vz));
-    // O2
-    // 2. ZXOςāA{YvZ
-    XMVECTOR vy = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(vz, vx));
-
-    // LookatupĂrightɂč蒼
-    if ((std::abs(DirectX::XMVector3Dot(vy, vz).m128_f32[0]) - 1.0f) < std::numeric_limits<float>::epsilon()) {
-        // {XvZB܂ right=XƂ
-        XMVECTOR vx_tmp = DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&right));
-
-        // O1 ZƉXOςāAYvZ
-        vy = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(vz, vx_tmp));
-        // O2 ZYOςāA{XvZ
-        vx = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(vy, vz));
-    }
-
-    XMMATRIX ret = DirectX::XMMatrixIdentity();
-    ret.r[0] = vx;
-    ret.r[1] = vy;
-    ret.r[2] = vz;
-
-    return ret;
-}
-
-XMMATRIX PMDActor::CreateLookAtMatrix(
-    const XMVECTOR& origin,
-    const XMVECTOR& lookat,
-    const XMFLOAT3& up,
-    const XMFLOAT3& right
-)
-{
-    // 1. ZCӂ̃xNgɌsvZ
-    // 2. 1.ō쐬s̋ts쐬iZtrans)
-    // 3. Z̕Ɍs쐬 (Zlookat)
-    // 4. 1(Ztrans)4(Zlookat)ō쐬sZBƁACӂ̃xNg(origin) Ztrans -> Zlookat ɉ]s񂪂łB
-    //    Ztrans -> Zlookat ɐ񂷂xNg쐬ĂC[W
-    return DirectX::XMMatrixTranspose(CreateLookAtMatrixZ(origin, up, right)) * CreateLookAtMatrixZ(lookat, up, right);
-}
-
-void PMDActor::IKSolve(uint32_t frame_no)
-{
-    const auto& iks = m_PMDData.GetPMDIKData();
-    for (const auto& ik : iks) {
-        // IK ON/OFFf[^mF
-        auto ik_enable_list = m_VMDData.GetIKEnable(frame_no);
-        if (ik_enable_list) {
-            auto itr = ik_enable_list->IkEnableTable.find(m_PMDData.GetBoneName(ik.BoneIdx));
-            if (itr != ik_enable_list->IkEnableTable.end()) {
-                // OFFȂÃ{[IKȂ
-                if (!itr->second) {
-                    continue;
-                }
-            }
-        }
-
-        auto children_nodes_count = ik.NodeIdxes.size();
-
-        switch (children_nodes_count) {
-        case 0:     // Ԃ̃{[0(肦Ȃ)
-            assert(0);
-            break;
-        case 1:     // Ԃ̃{[1̎LookAt
-            SolveLookAt(ik);
-            break;
-        case 2:     // Ԃ̃{[2̎͗]藝IK
-            SolveCosineIK(ik);
-            break;
-        default:
-            SolveCCDIK(ik);
-            break;
-        }
-    }
-}
-
-void PMDActor::SolveLookAt(const PMDIK& ik)
-{
-    // ̊֐ɗ_Ńm[h͂ЂƂȂA`F[ɓĂm[hԍ
-    // IK̃[gm[ĥ̂Ȃ̂ŁÃ[gm[h^[QbgɌxNgl΂悢
-    auto root_node = m_PMDData.GetBoneFromIndex(ik.NodeIdxes[0]);
-    auto target_node = m_PMDData.GetBoneFromIndex(ik.TargetIdx);    // [{[
-    assert(root_node && target_node);
-
-    // IK𓮂Õ[g->[̃xNg擾
-    auto rootpos1 = DirectX::XMLoadFloat3(&(root_node->BoneStartPos));
-    auto targetpos1 = DirectX::XMLoadFloat3(&(target_node->BoneStartPos));
-
-    // IK𓮂̃[g->[iڕW{[j̃xNg擾iڕWʒuւ̈ړj
-    auto rootpos2 = DirectX::XMVector3TransformCoord(rootpos1, m_BoneMetricesForMotion[ik.NodeIdxes[0]]);   // Wϊ̃[gm[h̍W擾
-    auto targetpos2 = DirectX::XMVector3TransformCoord(targetpos1, m_BoneMetricesForMotion[ik.BoneIdx]);    // Wϊ̖ڕW{[̍W擾B
-                                                                                                            // WϊsIK{[̍sp邱ƂŁA[ڕWֈړB
-
-    // IKňړxNgvZ
-    auto origin_vec = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(targetpos1, rootpos1));
-    auto target_vec = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(targetpos2, rootpos2));
-
-    // IKňړ]s쐬
-    m_BoneMetricesForMotion[ik.NodeIdxes[0]] =
-        DirectX::XMMatrixTranslationFromVector(-rootpos2) *
-        CreateLookAtMatrix(origin_vec, target_vec, DirectX::XMFLOAT3(0.f, 1.f, 0.f), DirectX::XMFLOAT3(1.f, 0.f, 0.f)) *
-        DirectX::XMMatrixTranslationFromVector(rootpos2);
-}
-
-void PMDActor::SolveCosineIK(const PMDIK& ik)
-{
-    // IK\_ۑ
-    std::vector<XMVECTOR> positions;
-    // IK̂ꂼ̃{[Ԃ̋ۑ
-    std::array<float, 2> edge_lens;
-
-    // WϊIK{[̍W擾
-    // ^[Qbgi[{[ł͂ȂA[{[߂ÂڕW{[̍W擾j
-    auto target_node = m_PMDData.GetBoneFromIndex(ik.BoneIdx);
-    assert(target_node);
-    auto target_pos = DirectX::XMVector3Transform(
-        DirectX::XMLoadFloat3(&(target_node->BoneStartPos)),
-        m_BoneMetricesForMotion[ik.BoneIdx]
-    );
-
-    // IK`F[͖[t@CɋL^Ă̂ŁAtɂĂ
-    // [{[
-    auto end_node = m_PMDData.GetBoneFromIndex(ik.TargetIdx);
-    assert(end_node);
-    positions.emplace_back(DirectX::XMLoadFloat3(&(end_node->BoneStartPos)));
-    // ԋyу[g{[
-    for (auto& chain_bone_idx : ik.NodeIdxes) {
-        auto bone_node = m_PMDData.GetBoneFromIndex(chain_bone_idx);
-        assert(bone_node);
-        positions.emplace_back(DirectX::XMLoadFloat3(&(bone_node->BoneStartPos)));
-    }
-    // [g疖[̏
-    std::reverse(positions.begin(), positions.end());
-
-    // xNǧX̒𑪂Ă
-    edge_lens[0] = DirectX::XMVector3Length(DirectX::XMVectorSubtract(positions[1], positions[0])).m128_f32[0];
-    edge_lens[1] = DirectX::XMVector3Length(DirectX::XMVectorSubtract(positions[2], positions[1])).m128_f32[0];
-
-    // [g{[WϊitɂȂĂ̂ŁAgpCfbNXɒӁj
-    positions[0] = DirectX::XMVector3Transform(positions[0], m_BoneMetricesForMotion[ik.NodeIdxes[1]]);
-    // ^񒆂͎vẐŌvZȂ
-    // positions[1];
-    // [{[Wϊ
-    positions[2] = DirectX::XMVector3Transform(positions[2], m_BoneMetricesForMotion[ik.BoneIdx]);  // IK{[̍Wϊswi[IKɒǏ]̂Łj
-
-    // [g[ւ̃xNgĂ
-    auto linear_vec = DirectX::XMVectorSubtract(positions[2], positions[0]);
-
-    double A = DirectX::XMVector3Length(linear_vec).m128_f32[0];
-    double B = edge_lens[0];
-    double C = edge_lens[1];
-    double Apow2 = A * A;
-    double Bpow2 = B * B;
-    double Cpow2 = C * C;
-
-    if( (A < std::numeric_limits<double>::epsilon()) ||
-        (B < std::numeric_limits<double>::epsilon()) ||
-        (C < std::numeric_limits<double>::epsilon()) ) {
-        // ǂꂩӂ0ɋ߂̂Ńf[^BȂB
-        return;
-    }
-
-    linear_vec = DirectX::XMVector3Normalize(linear_vec);
-
-    // [g^񒆂ւ̊pxvZ
-    double theta1 = std::acos((Apow2 + Bpow2 - Cpow2) / (2 * A * B));
-    // ^񒆂^[Qbgւ̊pxvZ
-    double theta2 = std::acos((Bpow2 + Cpow2 - Apow2) / (2 * B * C));
-
-    // ߂
-    // ^񒆂uЂvłꍇAIX]Ƃ
-    XMVECTOR axis;
-    const auto& knee_indexes = m_PMDData.GetBoneIndexes();
-    if (std::find(knee_indexes.begin(), knee_indexes.end(), ik.NodeIdxes[0]) == knee_indexes.end()) {
-        // uЂvłȂꍇ
-        // [g -> [ xNgƁA[g -> ڕW(IKړ) xNĝȂʂlÅOσxNgƂ
-        auto vm = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(positions[2], positions[0]));
-        auto vt = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(target_pos, positions[0]));
-        axis = DirectX::XMVector3Cross(vm, vt);
-    }
-    else {
-        // uЂv̏ꍇ
-        auto right = DirectX::XMFLOAT3(1, 0, 0);
-        axis = DirectX::XMLoadFloat3(&right);
-    }
-
-    // TODO: pxĂȂ̂ŁAЂƂȕɋȂ\L
-    // ӓ_FIK`F[̓[gɌĐ̂ŁA1[gɋ߂
-    // [g -> ԓ_ 񂷍s
-    auto mat1 = DirectX::XMMatrixTranslationFromVector(-positions[0]);
-    mat1 *= DirectX::XMMatrixRotationAxis(axis, theta1);
-    mat1 *= DirectX::XMMatrixTranslationFromVector(positions[0]);
-    // ԓ_ -> [ 񂷍s
-    auto mat2 = DirectX::XMMatrixTranslationFromVector(-positions[1]);
-    mat2 *= DirectX::XMMatrixRotationAxis(axis, theta2-DirectX::XM_PI);     // (180 - theta2) t]
-    mat2 *= DirectX::XMMatrixTranslationFromVector(positions[1]);
-
-    // [g
-    m_BoneMetricesForMotion[ik.NodeIdxes[1]] *= mat1;
-    // ԓ_(ɒԓ_񂵂ĂA[g񂳂ȂƁAԓ_̉]̒ŜŒ)
-    m_BoneMetricesForMotion[ik.NodeIdxes[0]] = mat2 * m_BoneMetricesForMotion[ik.NodeIdxes[1]];
-    // [
-    m_BoneMetricesForMotion[ik.TargetIdx] = m_BoneMetricesForMotion[ik.NodeIdxes[0]];
-}
-
-void PMDActor::SolveCCDIK(const PMDIK& ik)
-{
-    // ^[Qbgi[{[ł͂ȂA[{[߂ÂڕW{[̍W擾j
-    auto target_bone_node = m_PMDData.GetBoneFromIndex(ik.BoneIdx);
-    assert(target_bone_node);
-    auto target_origin_pos = DirectX::XMLoadFloat3(&(target_bone_node->BoneStartPos));
-    // eIKm[h̍WϊvZ̎זȂ̂ŁAtsł񖳌
-    // (PMDf[^ƁALookAt, ]藝IK̏ꍇ͐eIKm[h݂Ȃ̂ŁAeIKm[h̍Wϊ͍lKvȂ
-    // CCDIK̏ꍇ͐eIKm[hȂ炸݂̂ŁAe̕ϊs񖳌ĂKvj
-    auto parent_bone_idx = m_PMDData.GetBoneFromIndex(ik.BoneIdx)->IkParentBone;
-    assert(parent_bone_idx < m_BoneMetricesForMotion.size());
-    auto parent_mat = m_BoneMetricesForMotion[parent_bone_idx];
-    DirectX::XMVECTOR det;
-    auto inv_parent_mat = DirectX::XMMatrixInverse(&det, parent_mat);
-    auto target_next_pos = DirectX::XMVector3Transform(
-        target_origin_pos, m_BoneMetricesForMotion[ik.BoneIdx] * inv_parent_mat
-    );
-
-    // e{[̌ݍWۑ
-    std::vector<XMVECTOR> bone_positions;
-    // [m[h
-    auto end_node = m_PMDData.GetBoneFromIndex(ik.TargetIdx);
-    assert(end_node);
-    auto end_pos = DirectX::XMLoadFloat3(&(end_node->BoneStartPos));
-    // ԃm[h
-    for (auto cidx : ik.NodeIdxes) {
-        const auto& n = m_PMDData.GetBoneFromIndex(cidx);
-        assert(n);
-        bone_positions.emplace_back(
-            DirectX::XMLoadFloat3(&(n->BoneStartPos))
-        );
-    }
-
-    // ]sLĂ
-    std::vector<XMMATRIX> mats(bone_positions.size(), DirectX::XMMatrixIdentity());
-    const auto ik_limit = ik.Limit * DirectX::XM_PI;    // x@180ŊlL^ĂH WAƂĎgp̂ŁAXM_PI
-
-    constexpr double epsilon = 0.0005;
-    // IKɐݒ肳Ă鎎s񐔂JԂ
-    for (int c = 0; c < ik.Iterations; ++c) {
-        // ^[QbgƂقڈv甲
-        if (DirectX::XMVector3Length(DirectX::XMVectorSubtract(end_pos, target_next_pos)).m128_f32[0] <= epsilon) {
-            break;
-        }
-
-        // ꂼ̃{[̂ڂȂ
-        // pxɈȂ悤ɋȂĂ
-        for (int bidx = 0; bidx < bone_positions.size(); ++bidx) {
-            // ܋Ȃ悤ƂĂ{[ʒu
-            const auto& pos = bone_positions[bidx];
-
-            // Ώۃm[h疖[m[h܂łƁA
-            // Ώۃm[h^[Qbg܂ł̃xNg쐬
-            auto vec_to_end = DirectX::XMVectorSubtract(end_pos, pos);              // [
-            auto vec_to_target = DirectX::XMVectorSubtract(target_next_pos, pos);   // ^[Qbg
-            // K
-            vec_to_end = DirectX::XMVector3Normalize(vec_to_end);
-            vec_to_target = DirectX::XMVector3Normalize(vec_to_target);
-
-            // قړxNgɂȂĂ܂ꍇ
-            // OςłȂ̂ŁÃ{[Ɉn
-            auto cross = DirectX::XMVectorSubtract(vec_to_end, vec_to_target);
-            if (DirectX::XMVector3Length(cross).m128_f32[0] <= epsilon) {
-                continue;
-            }
-
-            // OόvZyъpxvZ
-            auto cross_normalized = DirectX::XMVector3Normalize(cross);
-            float angle = DirectX::XMVector3AngleBetweenNormals(vec_to_end, vec_to_target).m128_f32[0];
-
-            // ]E𒴂Ă܂Ƃ͌Elɕ␳
-            angle = std::min<float>(angle, ik_limit);
-            DirectX::XMMATRIX rot = DirectX::XMMatrixRotationAxis(cross_normalized, angle);
-
-            // _Sł͂ȂAposSɉ]
-            auto mat = DirectX::XMMatrixTranslationFromVector(-pos) *
-                rot *
-                DirectX::XMMatrixTranslationFromVector(pos);
-
-            // ]sێĂiZŉ]dˊ|Ăj
-            mats[bidx] *= mat;
-
-            // ΏۂƂȂ_ׂĉ]i݂̓_猩Ė[]j
-            for (auto idx = bidx - 1; idx >= 0; --idx) {
-                bone_positions[idx] = DirectX::XMVector3Transform(bone_positions[idx], mat);
-            }
-            end_pos = DirectX::XMVector3Transform(end_pos, mat);
-
-            // ɋ߂烋[v𔲂
-            if (DirectX::XMVector3Length(DirectX::XMVectorSubtract(end_pos, target_next_pos)).m128_f32[0] <= epsilon) {
-                break;
-            }
-        }
-    }
-
-    // {[sɔf
-    int i = 0;
-    for (auto cidx : ik.NodeIdxes) {
-        m_BoneMetricesForMotion[cidx] = mats[i];
-        ++i;
-    }
-    auto root_node = m_PMDData.GetBoneFromIndex(ik.NodeIdxes.back());
-    RecursiveMatrixMultiply(&(root_node.value()), parent_mat);
-}
\ No newline at end of file
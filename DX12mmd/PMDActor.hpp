@@ -3,14 +3,27 @@
 #include <filesystem>
 #include "PMD.hpp"
 #include "VMD.hpp"
+#include "BakedMotion.hpp"
+#include "VMDStream.hpp"
+#include "PoseBlend.hpp"
+#include "SkeletonPose.hpp"
+#include "IKSolver.hpp"
+#include "AnimationClock.hpp"
 #include "VertexBuffer.hpp"
 #include "IndexBuffer.hpp"
 #include "ConstantBuffer.hpp"
 #include "Texture.hpp"
 #include "Resource.hpp"
+#include "AlignedAllocator.hpp"
 
 class PMDActor
 {
+public:
+
+    static constexpr float k_MotionFps = 30.0f;     // VMD ̃t[[g
+
+    using BoneMatrixBuffer = CacheAlignedVector<DirectX::XMMATRIX>;
+
 public:
 
     PMDActor();
@@ -22,53 +35,96 @@ public:
         const std::filesystem::path& vmd_filepath
     );
 
-    VertexBufferPtr GetVertexBuffer();
+    // ǂݍ݂ CPU ŊiKi[J[XbhŎsj
+    // GPU \[X쐬iKi`XbhŎsjɕĂ
+    // Create ͂ɌĂяo
+    // @param decode_textures false ȂeNX`ǂ܂ȂiCreateResources Ă΂ȂAXV̌vp̃AN^[j
+    bool LoadModel(const std::filesystem::path& pmd_filepath, bool optimize_mesh = true, bool decode_textures = true);
+    // @param compression {[[Vkꍇ̐ݒikȂȂ nullptrj
+    //                    kłȂꍇǂݍ݂͐AkÔ܂܍Đ
+    bool LoadMotion(const std::filesystem::path& vmd_filepath, const MotionCompressionSettings* compression = nullptr);
+    // @brief {[[VSǂݍ܂AĐʒu̎̃`NǂݍōĐi[Vj
+    // @param pool `N̐ǂ݂ɎgXbhv[inullptr ȂKvɂȂƂɓǂݍށj
+    bool LoadMotionStream(const std::filesystem::path& vmd_filepath, ThreadPool* pool);
+    bool CreateResources(ResourceManager* resource_manager, const std::string& model_name);
+    // @brief GPU \[X炸ɁA[V̍XVɕKvȂ̂pӂiCreateResources ̑ɌĂԁj
+    //        XV̌vpŁA` UploadVertices ͂łȂ
+    void CreateMotionOnly();
+
+    VertexBufferPMDPtr GetVertexBuffer();
     IndexBufferPtr GetIndexBuffer();
     ConstantBufferPtr GetMaterialBuffer();
     const PMDData& GetPMDData() const;
     const VMDMotionTable& GetVMDMotionTable() const;
+    const std::vector<std::string>& GetUnmatchedMotionBones() const;   // fɖ[Ṽ{[
 
-    void RecursiveMatrixMultiply(
-        const BoneTree::BoneNode* node, const DirectX::XMMATRIX& mat
-    );
-    std::vector<DirectX::XMMATRIX>& GetBoneMetricesForMotion();
+    BoneMatrixBuffer& GetBoneMetricesForMotion();
+
+    // @brief [VĂ񂾎pōĐ悤ɂiCreateResources ̌ɌĂԁj
+    //        Ă݃t@Ci.<XPg̃nbV>.vmdbjg΂ǂݍ݁AΑSt[vZĕۑ
+    // @retval Ă݂Ɏsꍇ falseiʏ̍Đ̂܂܁j
+    bool UseBakedMotion();
+    bool IsBakedMotion() const;
+    bool IsStreamingMotion() const;
+
+    // @brief AN^[̃[V̏ɏd˂郂[ṼC[iCreateResources ̌Ɏgj
+    //        C[ōĐ̃[VԂ́AĂ񂾎p͎g킸ɖt[vZ
+    PoseBlender& GetPoseLayers();
+
+    // @brief IKiʂ GetStats / ResetStats `[jOɎgj
+    IKSolver& GetIKSolver();
+
+    // @brief [V̎̎擾ݒ肷i͍\^C}[BeXgł ManualClock gj
+    void SetClock(AnimationClockPtr clock);
 
     void PlayAnimation();
-    void MotionUpdate();
+
+    // @brief ݂̎̃t[ʒuigjŎpE\vZ
+    //        AN^[g̃{[sE_f[^AGPU ̃\[Xɂ͐GȂiʃXbhĂł悢j
+    // @retval OƓt[ʒuEC[\ŁApςȂꍇ falsei{[sE_͑Ô܂܁j
+    bool MotionUpdate();
+
+    // @brief MotionUpdate ŕ\_͈̔͂𒸓_obt@ɓ]
+    //        i_obt@}bv̂ŁAMotionUpdate SIĂ`XbhŌĂԁj
+    void UploadVertices();
+
+    // @brief ݂̎pŃNX^JOAʏ̑傫LODIŃ}eA̕`͈͂
+    //        iMotionUpdate ̌ɌĂԁj
+    // @param world_view_proj [hEr[EvWFNVs
+    // @param proj_scale_y    vWFNVs Y ̊g嗦i_22j
+    // @param screen_height   ʂ̍isNZj
+    void UpdateDrawRanges(const DirectX::XMMATRIX& world_view_proj, float proj_scale_y, float screen_height);
+
+    // @brief UpdateDrawRanges őILODi0 ͌̃bVj
+    uint32_t GetLodLevel() const;
+
+    // @brief UpdateDrawRanges ō}eA̕`͈
+    // @param material_idx }eAԍ
+    // @param range_num    `͈͂̐
+    // @retval `͈͂̐擪
+    const MeshClusterSet::DrawRange* GetDrawRanges(uint32_t material_idx, uint32_t* range_num) const;
 
 private:
 
+    void DecodeTextures();
+    DecodedImagePtr FindDecodedImage(const std::filesystem::path& filepath) const;
     void CreateTextures();
     void ReadToonTexture(const Material& material, const ResourceDescHandle& handle );
 
-    // @brief Z̕Ɍs쐬
-    // @param lookat 
-    // @param up     xNg
-    // @param right  ExNg
-    // @retval Z̕Ɍ邽߂̍s
-    XMMATRIX CreateLookAtMatrixZ(
-        const XMVECTOR& lookat,
-        const XMFLOAT3& up,
-        const XMFLOAT3& right
-    );
+    void BindMotion();
+    // @param vertices \ŏ钸_f[^iGPUɓ]̂ƓtH[}bgj
+    void BindMorphs(const uint8_t* vertices, uint32_t vertex_num, uint32_t stride);
+    void SetupMotion();     // fƃ[VΉtAp̌vZp̗̈pӂ
 
-    // @brief Cӂ̃xNg̕Ɍs쐬
-    // @param origin 𑀍삵Cӂ̃xNg
-    // @param lookat 
-    // @param up    xNg
-    // @param right ExNg
-    // @retval  origin ̕lookatɌ邽߂̍s
-    XMMATRIX CreateLookAtMatrix(
-        const XMVECTOR& origin,
-        const XMVECTOR& lookat,
-        const XMFLOAT3& up,
-        const XMFLOAT3& right
-    );
+    // @brief L[t[̕ԁEC[̍EFKEIK ŁAt[̃{[s m_BoneMetricesForMotion ɌvZ
+    // @param frame       t[ʒuiL[t[͐őIсAŕԂj
+    // @param layer_frame C[̃t[ʒuinullptr Ȃ烌C[d˂ȂBĂݎ̓AN^[̃[Vɂj
+    // @retval {[s񂪕ςi͂̎pELIKOƓȂ牽vZȂj
+    bool EvaluatePose(float frame, const float* layer_frame);
+    uint64_t PoseSourceHash() const;        // Ă񂾎pɉe郂ff[^iXPgEIKj̃nbV
+    uint32_t MaxKeyFrameNo() const;         // {[[VE\Ȃǂ킹őL[t[ԍ
+    void MorphUpdate(float frame);
 
-    void IKSolve(uint32_t frame_no);
-    void SolveLookAt(const PMDIK& ik);
-    void SolveCosineIK(const PMDIK& ik);
-    void SolveCCDIK(const PMDIK& ik);
 
     std::filesystem::path m_PMDModelPath;
     std::filesystem::path m_VMDMotionPath;
@@ -76,15 +132,56 @@ private:
     ResourceManager*  m_ResourceManager;
     PMDData           m_PMDData;
     VMDMotionTable    m_VMDData;
-    VertexBufferPtr   m_VertBuff;
+    VMDMotionSampler  m_MotionSampler;                       // gbÑJ[\ŃL[t[
+    std::vector<VMDMotionTable::MotionInterpolater> m_MotionSamples;   // ݃t[̃L[t[iΉtgbNj
+    std::vector<std::string> m_UnmatchedMotionBones;         // fɖ[Ṽ{[
+    IKEnableTimeline  m_IKEnable;                            // IKԍ ON/OFF ̎n
+    BakedMotion       m_BakedMotion;                         // Ă񂾎piLȂ炱ōĐj
+    VMDMotionStream   m_MotionStream;                        // Xg[~OĐ{[[ViJĂ΂gj
+    LocalPose         m_LocalPose;                           // {[̃[JpisɂOɃC[d˂j
+    SkeletonPose      m_SkeletonPose;                        // [JE[hpiς؂FKj
+    IKSolver          m_IKSolver;
+    PoseBlender       m_PoseLayers;                          // d˂郂[ṼC[
+    VertexBufferPMDPtr m_VertBuff;
     IndexBufferPtr    m_IdxBuff;
     ConstantBufferPtr m_MaterialBuff;
 
-    // todo: ACݒv
-    std::vector<DirectX::XMMATRIX> m_BoneMetricesForMotion;  // [Vp{[s
+    // ̃AN^[ʁX̃XbhōXVĂÃAN^[̍sƃLbVCLȂ悤
+    BoneMatrixBuffer  m_BoneMetricesForMotion;               // [Vp{[s
+
+    // \
+    struct MorphTrack
+    {
+        uint32_t MorphIdx;                                   // f̃[tԍ
+        const std::vector<MorphKeyFrame>* KeyFrames;         // [ṼL[t[
+    };
+    std::vector<MorphTrack> m_MorphTracks;                   // [V̕\ƃ[t̑Ήiǂݍݎɍj
+    std::vector<float>      m_MorphWeights;                  // [t̃EFCg
+    MorphSet::State         m_MorphState;                    // [tvZp̍Ɨ̈
+    std::vector<uint8_t>    m_MorphedVertices;               // \Kp̒_f[^iGPU]j
+    uint32_t                m_MorphedVertexStride;           // m_MorphedVertices 1_̃oCg
+    MorphSet::DirtyRange    m_VertexUploadRange;             // ܂]ĂȂ_͈̔
+
+    // LOD̑Iiʏ̌덷̃sNZȉɂȂԑeLODgj
+    static constexpr float k_LodPixelError = 1.0f;
+
+    // NX^JOELODI
+    uint32_t                m_LodLevel;                      // gpLODi0 ͌̃bVj
+    std::vector<MeshClusterSet::DrawRange> m_DrawRanges;     // `悷CfbNX͈̔́i}eAj
+    std::vector<uint32_t>   m_MaterialDrawRangeBegin;        // }eA m_DrawRanges ̐擪
 
     TextureGroup      m_TextureManager;
     std::vector<TexturePtr> m_Textures;
-
-    DWORD             m_AnimeStartTimeMs;                    // [VJñ~b
-};
\ No newline at end of file
+    std::map<std::wstring, DecodedImagePtr> m_DecodedImages;   // GPU]҂̃fR[hς݉摜
+
+    AnimationClockPtr m_Clock;                               // [V̎̎擾
+    double            m_AnimeStartTime;                      // [VJn̎ibj
+    double            m_LayerStartTime;                      // C[̎̋N_i[Ṽ[vł͖߂Ȃj
+
+    // OvZp̃t[ʒuiȂvZȂj
+    bool              m_PoseEvaluated;
+    float             m_EvaluatedFrame;
+    float             m_EvaluatedLayerFrame;
+    uint32_t          m_EvaluatedLayerRevision;
+};
+using PMDActorPtr = std::shared_ptr<PMDActor>;
\ No newline at end of file
@@ -0,0 +1,406 @@
+#include "PMDCache.hpp"
+#include "FilePath.hpp"
+#include "Hash.hpp"
+
+#include "windows.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    const uint8_t* SectionData(const MappedFile& file, const PMDCacheHeader& header, PMDCacheHeader::Section section)
+    {
+        return file.Data() + header.Sections[section].Offset;
+    }
+
+    // ZNVACĒǉ
+    void AppendSection(
+        std::vector<uint8_t>* blob,
+        PMDCacheHeader* header,
+        PMDCacheHeader::Section section,
+        const void* data,
+        uint64_t size
+    )
+    {
+        uint64_t offset = (blob->size() + PMDCache::k_SectionAlign - 1) & ~(PMDCache::k_SectionAlign - 1);
+        blob->resize(offset + size, 0);
+        if (size > 0) {
+            std::memcpy(blob->data() + offset, data, size);
+        }
+
+        header->Sections[section].Offset = offset;
+        header->Sections[section].Size = size;
+    }
+}
+
+std::filesystem::path PMDCache::CachePath(const std::filesystem::path& pmd_path)
+{
+    std::filesystem::path cache_path = pmd_path;
+    cache_path.replace_extension(L".pmdc");
+    return cache_path;
+}
+
+bool PMDCache::Load(
+    const std::filesystem::path& cache_path,
+    const std::filesystem::path& pmd_path,
+    bool optimize_mesh,
+    PMDData* pmd
+)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(cache_path, ec) || ec) {
+        return false;
+    }
+
+    // }bvOɃwb_[ǂŁAt@CςĂȂmF
+    PMDCacheHeader header{};
+    {
+        std::ifstream ifs(cache_path, std::ios::in | std::ios::binary);
+        if (!ifs.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            return false;
+        }
+    }
+    int64_t write_time = 0;
+    if (!IsHeaderUsable(header, optimize_mesh) || !IsSourceUpToDate(header, pmd_path, &write_time)) {
+        return false;
+    }
+    // XVςĂĒgȂA񂩂nbVvZȂčςނ悤Ă
+    // ĩAN^[LbV}bvĂԂ͏߂ȂBnbVŔ肳邾Ȃ̂œǂݍ݂͑j
+    if (write_time != header.SourceWriteTime && !UpdateSourceWriteTime(cache_path, write_time)) {
+        ::OutputDebugStringA("PMD cache write time could not be updated.\n");
+    }
+
+    // LbV1}bv邾ŁAȍ~͊eZNV𒼐ڎQƂ
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(cache_path)) {
+        return false;
+    }
+
+    // mFĂ}bv܂łɒuĂȂA}bṽwb_[łmF
+    MappedFileReader reader(file->Data(), file->Size());
+    if (!reader.Read(&header) || !IsHeaderUsable(header, optimize_mesh)) {
+        return false;
+    }
+
+    // ZNVt@CɎ܂Ă邩mF
+    for (const auto& section : header.Sections) {
+        if (section.Offset > file->Size() || section.Size > file->Size() - section.Offset) {
+            return false;
+        }
+    }
+
+    const auto& sections = header.Sections;
+    if (sections[PMDCacheHeader::k_Vertices].Size != static_cast<uint64_t>(header.VertexNum) * sizeof(PMDVertex) ||
+        sections[PMDCacheHeader::k_Indices].Size != static_cast<uint64_t>(header.IndexNum) * sizeof(uint16_t) ||
+        sections[PMDCacheHeader::k_RawMaterials].Size != static_cast<uint64_t>(header.MaterialNum) * sizeof(PMDMaterial) ||
+        sections[PMDCacheHeader::k_ShaderMaterials].Size != static_cast<uint64_t>(header.MaterialNum) * PMDData::k_ShaderMaterialAlignedSize ||
+        sections[PMDCacheHeader::k_TexturePaths].Size != static_cast<uint64_t>(header.MaterialNum) * sizeof(PMDCacheTexturePath) ||
+        sections[PMDCacheHeader::k_Bones].Size != static_cast<uint64_t>(header.BoneNum) * sizeof(PMDBone) ||
+        sections[PMDCacheHeader::k_IKs].Size != static_cast<uint64_t>(header.IkNum) * sizeof(PMDCacheIK) ||
+        sections[PMDCacheHeader::k_Lods].Size != static_cast<uint64_t>(header.LodNum) * sizeof(PMDCacheLod) ||
+        sections[PMDCacheHeader::k_LodMaterialIndexNums].Size != static_cast<uint64_t>(header.LodNum) * header.MaterialNum * sizeof(uint32_t)) {
+        return false;
+    }
+
+    // eZNV̈ʒu|C^ɒu
+    pmd->m_PMDHeader = header.ModelHeader;
+
+    pmd->m_VertexNum = header.VertexNum;
+    pmd->m_VerticesBuff.clear();
+    pmd->m_VertexData = SectionData(*file, header, PMDCacheHeader::k_Vertices);
+
+    pmd->m_IndexNum = header.IndexNum;
+    pmd->m_IndicesBuff.clear();
+    pmd->m_MeshOptimized = (header.Flags & PMDCacheHeader::k_FlagOptimizedMesh) != 0;
+    pmd->m_MeshOptimizeStats = MeshOptimizeStats();
+    pmd->m_IndicesView = SectionData(*file, header, PMDCacheHeader::k_Indices);
+    if (!PMDData::IsIndexInRange(reinterpret_cast<const uint16_t*>(pmd->m_IndicesView), header.IndexNum, header.VertexNum)) {
+        return false;
+    }
+
+    // LOD
+    const PMDCacheLod* lods = reinterpret_cast<const PMDCacheLod*>(SectionData(*file, header, PMDCacheHeader::k_Lods));
+    const uint32_t* lod_material_nums = reinterpret_cast<const uint32_t*>(
+        SectionData(*file, header, PMDCacheHeader::k_LodMaterialIndexNums)
+    );
+    const uint64_t lod_index_num = sections[PMDCacheHeader::k_LodIndices].Size / sizeof(uint16_t);
+
+    pmd->m_Lods.resize(header.LodNum);
+    for (uint16_t i = 0; i < header.LodNum; ++i) {
+        if (static_cast<uint64_t>(lods[i].IndexOffset) + lods[i].IndexNum > lod_index_num) {
+            return false;
+        }
+
+        // }eÃCfbNX̍vLOD̃CfbNXƍȂ΁A`͈͂̂ŎgȂ
+        const uint32_t* material_nums = lod_material_nums + static_cast<size_t>(i) * header.MaterialNum;
+        uint64_t material_index_sum = 0;
+        for (uint32_t m = 0; m < header.MaterialNum; ++m) {
+            material_index_sum += material_nums[m];
+        }
+        if (material_index_sum != lods[i].IndexNum) {
+            return false;
+        }
+
+        auto& lod = pmd->m_Lods[i];
+        lod.IndexOffset = lods[i].IndexOffset;
+        lod.IndexNum = lods[i].IndexNum;
+        lod.Error = lods[i].Error;
+        lod.MaterialIndexNums.assign(
+            lod_material_nums + static_cast<size_t>(i) * header.MaterialNum,
+            lod_material_nums + static_cast<size_t>(i + 1) * header.MaterialNum
+        );
+    }
+    pmd->m_LodIndicesBuff.clear();
+    pmd->m_LodIndicesView = SectionData(*file, header, PMDCacheHeader::k_LodIndices);
+    if (!PMDData::IsIndexInRange(reinterpret_cast<const uint16_t*>(pmd->m_LodIndicesView), static_cast<uint32_t>(lod_index_num), header.VertexNum)) {
+        return false;
+    }
+    pmd->m_LodIndexNum = static_cast<uint32_t>(lod_index_num);
+
+    pmd->m_MaterialNum = header.MaterialNum;
+    pmd->m_MaterialView = DataView<PMDMaterial>(
+        reinterpret_cast<const PMDMaterial*>(SectionData(*file, header, PMDCacheHeader::k_RawMaterials)),
+        header.MaterialNum
+    );
+    uint64_t material_index_sum = 0;
+    for (const auto& material : pmd->m_MaterialView) {
+        material_index_sum += material.IndicesNum;
+    }
+    if (material_index_sum != header.IndexNum) {
+        return false;
+    }
+    pmd->m_ShaderMaterialsBuff.clear();
+    pmd->m_ShaderMaterialData = SectionData(*file, header, PMDCacheHeader::k_ShaderMaterials);
+    pmd->CopyMaterialsData();
+
+    // eNX`pX̓f̃tH_̑΃pXŎĂ̂ŁAŌ
+    const wchar_t* strings = reinterpret_cast<const wchar_t*>(SectionData(*file, header, PMDCacheHeader::k_Strings));
+    const uint64_t string_len = sections[PMDCacheHeader::k_Strings].Size / sizeof(wchar_t);
+    const PMDCacheTexturePath* tex_paths = reinterpret_cast<const PMDCacheTexturePath*>(
+        SectionData(*file, header, PMDCacheHeader::k_TexturePaths)
+    );
+    const std::filesystem::path model_dir = pmd_path.parent_path();
+
+    pmd->m_TexturePaths.resize(header.MaterialNum);
+    for (uint32_t i = 0; i < header.MaterialNum; ++i) {
+        std::filesystem::path* dst[3] = {
+            &pmd->m_TexturePaths[i].TexPath,
+            &pmd->m_TexturePaths[i].SphereMapPath,
+            &pmd->m_TexturePaths[i].AddSphereMapPath
+        };
+        for (int k = 0; k < 3; ++k) {
+            uint64_t offset = tex_paths[i].Offset[k];
+            uint64_t length = tex_paths[i].Length[k];
+            if (offset + length > string_len) {
+                return false;
+            }
+            *dst[k] = length == 0 ? std::filesystem::path() : model_dir / std::wstring(strings + offset, length);
+        }
+    }
+
+    // {[
+    pmd->m_BoneNum = header.BoneNum;
+    pmd->m_BonesView = DataView<PMDBone>(
+        reinterpret_cast<const PMDBone*>(SectionData(*file, header, PMDCacheHeader::k_Bones)),
+        header.BoneNum
+    );
+    pmd->SetupBones();
+
+    // IK
+    const PMDCacheIK* iks = reinterpret_cast<const PMDCacheIK*>(SectionData(*file, header, PMDCacheHeader::k_IKs));
+    const uint16_t* ik_nodes = reinterpret_cast<const uint16_t*>(SectionData(*file, header, PMDCacheHeader::k_IKNodes));
+    const uint64_t ik_node_num = sections[PMDCacheHeader::k_IKNodes].Size / sizeof(uint16_t);
+
+    pmd->m_IkNum = header.IkNum;
+    pmd->m_PMDIkData.resize(header.IkNum);
+    for (uint16_t i = 0; i < header.IkNum; ++i) {
+        const auto& src = iks[i];
+        if (static_cast<uint64_t>(src.NodeOffset) + src.NodeNum > ik_node_num) {
+            return false;
+        }
+
+        auto& ik = pmd->m_PMDIkData[i];
+        ik.BoneIdx = src.BoneIdx;
+        ik.TargetIdx = src.TargetIdx;
+        ik.Iterations = src.Iterations;
+        ik.Limit = src.Limit;
+        ik.NodeIdxes.assign(ik_nodes + src.NodeOffset, ik_nodes + src.NodeOffset + src.NodeNum);
+    }
+
+    // \
+    pmd->m_SkinNum = header.SkinNum;
+    pmd->m_SkinBuff.clear();
+    pmd->m_SkinData = SectionData(*file, header, PMDCacheHeader::k_Skins);
+    pmd->m_SkinDataSize = sections[PMDCacheHeader::k_Skins].Size;
+    if (!pmd->SetupMorphs()) {
+        return false;
+    }
+
+    pmd->m_File = file;
+
+    return true;
+}
+
+bool PMDCache::Save(
+    const std::filesystem::path& cache_path,
+    const std::filesystem::path& pmd_path,
+    const PMDData& pmd
+)
+{
+    if (!pmd.m_File) {
+        return false;
+    }
+
+    PMDCacheHeader header{};
+    std::memcpy(header.Magic, k_Magic, sizeof(k_Magic));
+    header.Version = k_Version;
+    header.Flags = pmd.m_MeshOptimized ? PMDCacheHeader::k_FlagOptimizedMesh : 0;
+    if (!GetFileStamp(pmd_path, &header.SourceSize, &header.SourceWriteTime)) {
+        return false;
+    }
+    header.SourceHash = HashFNV1a(pmd.m_File->Data(), pmd.m_File->Size());
+
+    header.ModelHeader = pmd.m_PMDHeader;
+    header.VertexNum = pmd.m_VertexNum;
+    header.IndexNum = pmd.m_IndexNum;
+    header.MaterialNum = pmd.m_MaterialNum;
+    header.BoneNum = pmd.m_BoneNum;
+    header.IkNum = pmd.m_IkNum;
+    header.SkinNum = pmd.m_SkinNum;
+    header.LodNum = static_cast<uint16_t>(pmd.m_Lods.size());
+
+    // eNX`pX̓f̃tH_̑΃pXɂĕۑ
+    const std::filesystem::path model_dir = pmd_path.parent_path();
+    std::vector<wchar_t> strings;
+    std::vector<PMDCacheTexturePath> tex_paths(pmd.m_TexturePaths.size());
+    for (size_t i = 0; i < pmd.m_TexturePaths.size(); ++i) {
+        const std::filesystem::path* src[3] = {
+            &pmd.m_TexturePaths[i].TexPath,
+            &pmd.m_TexturePaths[i].SphereMapPath,
+            &pmd.m_TexturePaths[i].AddSphereMapPath
+        };
+        for (int k = 0; k < 3; ++k) {
+            // ʂ̃hCuȂǑ΃pXɂłȂꍇ͋ɂȂ̂ŁA΃pX̂܂܎
+            // iǂݍݎɃf̃tH_ƌĂA΃pX͂̂܂܎cj
+            std::wstring relative;
+            if (!src[k]->empty()) {
+                relative = src[k]->lexically_relative(model_dir).wstring();
+                if (relative.empty()) {
+                    relative = std::filesystem::absolute(*src[k]).wstring();
+                }
+            }
+            tex_paths[i].Offset[k] = static_cast<uint32_t>(strings.size());
+            tex_paths[i].Length[k] = static_cast<uint32_t>(relative.size());
+            strings.insert(strings.end(), relative.begin(), relative.end());
+        }
+    }
+
+    // IK͉ϒȂ̂ŁAm[hԍʃZNVɂ܂Ƃ߂
+    std::vector<PMDCacheIK> iks(pmd.m_PMDIkData.size());
+    std::vector<uint16_t> ik_nodes;
+    for (size_t i = 0; i < pmd.m_PMDIkData.size(); ++i) {
+        const auto& ik = pmd.m_PMDIkData[i];
+        iks[i].BoneIdx = ik.BoneIdx;
+        iks[i].TargetIdx = ik.TargetIdx;
+        iks[i].Iterations = ik.Iterations;
+        iks[i].NodeNum = static_cast<uint16_t>(ik.NodeIdxes.size());
+        iks[i].Limit = ik.Limit;
+        iks[i].NodeOffset = static_cast<uint32_t>(ik_nodes.size());
+        ik_nodes.insert(ik_nodes.end(), ik.NodeIdxes.begin(), ik.NodeIdxes.end());
+    }
+
+    // LOD̓}eÃCfbNXʃZNVɂ܂Ƃ߂
+    std::vector<PMDCacheLod> lods(pmd.m_Lods.size());
+    std::vector<uint32_t> lod_material_nums;
+    for (size_t i = 0; i < pmd.m_Lods.size(); ++i) {
+        const auto& lod = pmd.m_Lods[i];
+        lods[i].IndexOffset = lod.IndexOffset;
+        lods[i].IndexNum = lod.IndexNum;
+        lods[i].Error = lod.Error;
+        lod_material_nums.insert(lod_material_nums.end(), lod.MaterialIndexNums.begin(), lod.MaterialIndexNums.end());
+    }
+
+    std::vector<uint8_t> blob(sizeof(PMDCacheHeader), 0);
+    AppendSection(&blob, &header, PMDCacheHeader::k_Vertices, pmd.GetVertexData(), pmd.VertexBuffSize());
+    AppendSection(&blob, &header, PMDCacheHeader::k_Indices, pmd.GetIndexData(), pmd.IndexBuffSize());
+    AppendSection(&blob, &header, PMDCacheHeader::k_RawMaterials, pmd.m_MaterialView.data(), pmd.MaterialBuffSize());
+    AppendSection(&blob, &header, PMDCacheHeader::k_ShaderMaterials, pmd.GetShaderMaterialData(), pmd.ShaderMaterialBuffSize());
+    AppendSection(&blob, &header, PMDCacheHeader::k_TexturePaths, tex_paths.data(), tex_paths.size() * sizeof(PMDCacheTexturePath));
+    AppendSection(&blob, &header, PMDCacheHeader::k_Bones, pmd.m_BonesView.data(), pmd.BoneBuffSize());
+    AppendSection(&blob, &header, PMDCacheHeader::k_IKs, iks.data(), iks.size() * sizeof(PMDCacheIK));
+    AppendSection(&blob, &header, PMDCacheHeader::k_IKNodes, ik_nodes.data(), ik_nodes.size() * sizeof(uint16_t));
+    AppendSection(&blob, &header, PMDCacheHeader::k_Strings, strings.data(), strings.size() * sizeof(wchar_t));
+    AppendSection(&blob, &header, PMDCacheHeader::k_Skins, pmd.m_SkinData, pmd.m_SkinDataSize);
+    AppendSection(&blob, &header, PMDCacheHeader::k_LodIndices, pmd.GetLodIndexData(), static_cast<uint64_t>(pmd.LodIndexNum()) * sizeof(uint16_t));
+    AppendSection(&blob, &header, PMDCacheHeader::k_Lods, lods.data(), lods.size() * sizeof(PMDCacheLod));
+    AppendSection(&blob, &header, PMDCacheHeader::k_LodMaterialIndexNums, lod_material_nums.data(), lod_material_nums.size() * sizeof(uint32_t));
+    std::memcpy(blob.data(), &header, sizeof(header));
+
+    // ݓr̃t@Cǂ܂Ȃ悤Aꎞt@CɏĂu
+    // f𕡐Xbhœǂݍ񂾏ꍇɔāAꎞt@C̓Xbhɕς
+    std::filesystem::path tmp_path = cache_path;
+    tmp_path += L"." + std::to_wstring(std::hash<std::thread::id>()(std::this_thread::get_id())) + L".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+        ofs.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+        if (!ofs) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, cache_path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool PMDCache::IsHeaderUsable(const PMDCacheHeader& header, bool optimize_mesh)
+{
+    if (std::memcmp(header.Magic, k_Magic, sizeof(k_Magic)) != 0 || header.Version != k_Version) {
+        return false;
+    }
+    return ((header.Flags & PMDCacheHeader::k_FlagOptimizedMesh) != 0) == optimize_mesh;
+}
+
+bool PMDCache::IsSourceUpToDate(const PMDCacheHeader& header, const std::filesystem::path& pmd_path, int64_t* write_time)
+{
+    uint64_t size = 0;
+    if (!GetFileStamp(pmd_path, &size, write_time)) {
+        return false;
+    }
+    if (size != header.SourceSize) {
+        return false;
+    }
+    if (*write_time == header.SourceWriteTime) {
+        return true;
+    }
+
+    // XVςĂꍇ́Ag̃nbVŔ肷
+    MappedFile source;
+    if (!source.Open(pmd_path)) {
+        return false;
+    }
+    return HashFNV1a(source.Data(), source.Size()) == header.SourceHash;
+}
+
+bool PMDCache::UpdateSourceWriteTime(const std::filesystem::path& cache_path, int64_t write_time)
+{
+    std::fstream fs(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!fs) {
+        return false;
+    }
+    fs.seekp(offsetof(PMDCacheHeader, SourceWriteTime));
+    fs.write(reinterpret_cast<const char*>(&write_time), sizeof(write_time));
+    return static_cast<bool>(fs);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "PMD.hpp"
+
+// .pmdc t@CiGPUɂ̂܂ܓn`ɕϊς݂PMDLbVj̃tH[}bg
+//
+// [PMDCacheHeader][eZNVi256byteACj]
+// wb_[ɂ͌PMDt@C̃nbVAt@CςĂLbV蒼B
+// ǂݍݎ̓t@C}bvAeZNV̈ʒu|C^ɒu邾ŎgB
+struct PMDCacheSection
+{
+    uint64_t Offset;        // t@C擪̃ItZbg
+    uint64_t Size;          // ZNṼoCg
+};
+
+struct PMDCacheHeader
+{
+    enum Section
+    {
+        k_Vertices,             // _iPMDVertex, 40byte/_j
+        k_Indices,              // CfbNXiuint16_tj
+        k_RawMaterials,         // PMDMaterial
+        k_ShaderMaterials,      // VF[_[p}eAi256byteACAWriteMaterial Ɠсj
+        k_TexturePaths,         // PMDCacheTexturePathi}eAj
+        k_Bones,                // PMDBone
+        k_IKs,                  // PMDCacheIK
+        k_IKNodes,              // IK`F[̃m[hԍiuint16_tj
+        k_Strings,              // eNX`pXiwchar_tj
+        k_Skins,                // XLZNViPMDt@CƓ`j
+        k_LodIndices,           // SLOD̃CfbNXiuint16_tj
+        k_Lods,                 // PMDCacheLod
+        k_LodMaterialIndexNums, // LODE}eÃCfbNXiuint32_tj
+        k_SectionNum,
+    };
+
+    enum Flag : uint32_t
+    {
+        k_FlagOptimizedMesh = 1 << 0,   // CfbNXE_בւς
+    };
+
+    char      Magic[4];                 // "PMDC"
+    uint32_t  Version;                  // tH[}bgo[W
+    uint32_t  Flags;                    // Flag ̑gݍ킹
+    uint64_t  SourceSize;               // PMDt@C̃TCY
+    int64_t   SourceWriteTime;          // PMDt@C̍XV
+    uint64_t  SourceHash;               // PMDt@C̃nbViFNV-1aj
+
+    PMDHeader ModelHeader;
+    uint32_t  VertexNum;
+    uint32_t  IndexNum;
+    uint32_t  MaterialNum;
+    uint16_t  BoneNum;
+    uint16_t  IkNum;
+    uint16_t  SkinNum;
+    uint16_t  LodNum;
+
+    PMDCacheSection Sections[k_SectionNum];
+};
+
+// eNX`pXif̃tH_̑΃pXB΃pXɂłȂʂ̃hCuȂǂ͐΃pXBk_Strings ̈ʒuƒj
+struct PMDCacheTexturePath
+{
+    uint32_t Offset[3];     // TexPath, SphereMapPath, AddSphereMapPath
+    uint32_t Length[3];
+};
+
+struct PMDCacheIK
+{
+    uint16_t BoneIdx;
+    uint16_t TargetIdx;
+    uint16_t Iterations;
+    uint16_t NodeNum;       // `F[̃m[h
+    float    Limit;
+    uint32_t NodeOffset;    // k_IKNodes ̐擪vfԍ
+};
+
+struct PMDCacheLod
+{
+    uint32_t IndexOffset;   // k_LodIndices ̐擪vfԍ
+    uint32_t IndexNum;
+    float    Error;
+};
+
+class PMDCache
+{
+public:
+
+    static constexpr char     k_Magic[4] = { 'P', 'M', 'D', 'C' };
+    static constexpr uint32_t k_Version = 4;
+    static constexpr uint64_t k_SectionAlign = 256;
+
+    // @brief PMDt@CɑΉLbVt@C̃pXԂ
+    static std::filesystem::path CachePath(const std::filesystem::path& pmd_path);
+
+    // @brief LbVǂݍ
+    // @param cache_path LbVt@CpX
+    // @param pmd_path   PMDt@CpXiXV`FbNƃeNX`pX̉Ɏgj
+    // @param optimize_mesh bVœKς݂̃LbV~
+    // @param pmd        ǂݍݐ
+    // @retval LbVEĂEÂEœK̗LႤꍇ false
+    static bool Load(
+        const std::filesystem::path& cache_path,
+        const std::filesystem::path& pmd_path,
+        bool optimize_mesh,
+        PMDData* pmd
+    );
+
+    // @brief ǂݍݍς݂PMDf[^LbV쐬
+    static bool Save(
+        const std::filesystem::path& cache_path,
+        const std::filesystem::path& pmd_path,
+        const PMDData& pmd
+    );
+
+private:
+
+    // @param write_time PMDt@Č݂̍XV
+    static bool IsSourceUpToDate(const PMDCacheHeader& header, const std::filesystem::path& pmd_path, int64_t* write_time);
+    static bool IsHeaderUsable(const PMDCacheHeader& header, bool optimize_mesh);
+
+    // @brief LbṼwb_[̌PMDt@C̍XV
+    static bool UpdateSourceWriteTime(const std::filesystem::path& cache_path, int64_t write_time);
+};
@@ -0,0 +1,299 @@
+#include "PoseBlend.hpp"
+#include "PMD.hpp"
+#include "Skeleton.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 낦Ă`ԁEKiuh2p͋߂̂ slerp Ƃ̍͏j
+    DirectX::XMVECTOR QuaternionNlerp(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b, float t)
+    {
+        DirectX::XMVECTOR b_aligned = DirectX::XMVectorGetX(DirectX::XMVector4Dot(a, b)) < 0.0f ? DirectX::XMVectorNegate(b) : b;
+        return DirectX::XMQuaternionNormalize(DirectX::XMVectorLerp(a, b_aligned, t));
+    }
+}
+
+void LocalPose::Resize(uint32_t bone_num)
+{
+    Rotations.resize(bone_num);
+    Translations.resize(bone_num);
+    Weights.resize(bone_num);
+    Reset();
+}
+
+uint32_t LocalPose::BoneNum() const
+{
+    return static_cast<uint32_t>(Rotations.size());
+}
+
+void LocalPose::Reset()
+{
+    std::fill(Rotations.begin(), Rotations.end(), DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+    std::fill(Translations.begin(), Translations.end(), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+    std::fill(Weights.begin(), Weights.end(), 0.0f);
+}
+
+void LocalPose::Sample(
+    const VMDMotionTable::MotionInterpolater* samples,
+    uint32_t num,
+    float frame,
+    const BezierEasingTable& easing
+)
+{
+    for (uint32_t i = 0; i < num; ++i) {
+        const auto& motion = samples[i];
+        if (motion.BoneIdx >= BoneNum()) {
+            continue;
+        }
+
+        DirectX::XMVECTOR rotation;
+        DirectX::XMVECTOR offset;
+        motion.Interpolate(frame, easing, &rotation, &offset);
+        DirectX::XMStoreFloat4(&Rotations[motion.BoneIdx], rotation);
+        DirectX::XMStoreFloat3(&Translations[motion.BoneIdx], offset);
+        Weights[motion.BoneIdx] = 1.0f;
+    }
+}
+
+BoneMask CreateSubtreeMask(const Skeleton& skeleton, uint16_t root_idx, float weight)
+{
+    BoneMask mask(skeleton.BoneNum(), 0.0f);
+    std::vector<uint16_t> bones;
+    skeleton.CollectSubtree(root_idx, &bones);
+    for (uint16_t idx : bones) {
+        mask[idx] = weight;
+    }
+    return mask;
+}
+
+PoseBlender::PoseBlender()
+    :
+    m_PMDData(nullptr),
+    m_BoneNum(0),
+    m_Frame(0.0f),
+    m_Revision(0),
+    m_Layers(),
+    m_Samples()
+{}
+
+void PoseBlender::Bind(const PMDData& pmd)
+{
+    m_PMDData = &pmd;
+    m_BoneNum = pmd.GetSkeleton().BoneNum();
+    ++m_Revision;
+    for (auto& layer : m_Layers) {
+        layer.Pose.Resize(m_BoneNum);
+        layer.FadePose.Resize(m_BoneNum);
+    }
+}
+
+uint32_t PoseBlender::AddLayer(const PoseLayerDesc& desc)
+{
+    Layer layer;
+    layer.Desc = desc;
+    layer.Current.StartFrame = 0.0f;
+    layer.Previous.StartFrame = 0.0f;
+    layer.FadeStartFrame = 0.0f;
+    layer.FadeFrames = 0.0f;
+    layer.FadeFromSnapshot = false;
+    layer.Pose.Resize(m_BoneNum);
+    layer.FadePose.Resize(m_BoneNum);
+    m_Layers.emplace_back(std::move(layer));
+    ++m_Revision;
+
+    return static_cast<uint32_t>(m_Layers.size() - 1);
+}
+
+uint32_t PoseBlender::LayerNum() const
+{
+    return static_cast<uint32_t>(m_Layers.size());
+}
+
+bool PoseBlender::IsEmpty() const
+{
+    return std::none_of(m_Layers.begin(), m_Layers.end(), [](const Layer& layer) {
+        return layer.Current.Motion || layer.FadeFrames > 0.0f;
+    });
+}
+
+void PoseBlender::SetLayerWeight(uint32_t layer_idx, float weight)
+{
+    if (layer_idx < m_Layers.size()) {
+        m_Layers[layer_idx].Desc.Weight = weight;
+        ++m_Revision;
+    }
+}
+
+void PoseBlender::SetLayerMask(uint32_t layer_idx, BoneMask mask)
+{
+    if (layer_idx < m_Layers.size()) {
+        m_Layers[layer_idx].Desc.Mask = std::move(mask);
+        ++m_Revision;
+    }
+}
+
+void PoseBlender::Play(uint32_t layer_idx, std::shared_ptr<const VMDMotionTable> motion, float fade_frames)
+{
+    const float frame = m_Frame;
+    if (layer_idx >= m_Layers.size() || !m_PMDData) {
+        return;
+    }
+    ++m_Revision;
+
+    Layer& layer = m_Layers[layer_idx];
+    if (fade_frames <= 0.0f) {
+        layer.Previous = Clip();
+        layer.FadeFrames = 0.0f;
+    }
+    else {
+        const bool fading = layer.FadeFrames > 0.0f && frame - layer.FadeStartFrame < layer.FadeFrames;
+        layer.Previous = Clip();
+        if (fading) {
+            // NXtF[hɐ؂ւꍇ́AÕC[̎p~߂̂tF[h
+            // iǂ炩̃[V̂ĂƁÅ^̕pԁj
+            layer.FadePose = layer.Pose;
+            layer.FadeFromSnapshot = true;
+        }
+        else {
+            // ĐĂȂ Previous ͋Ȃ̂ŁÃC[tF[hC
+            layer.Previous = std::move(layer.Current);
+            layer.FadeFromSnapshot = false;
+        }
+        layer.FadeStartFrame = frame;
+        layer.FadeFrames = fade_frames;
+    }
+
+    layer.Current = Clip();
+    layer.Current.Motion = std::move(motion);
+    layer.Current.StartFrame = frame;
+    if (layer.Current.Motion) {
+        layer.Current.Sampler.Bind(*layer.Current.Motion, *m_PMDData);
+        m_Samples.resize(std::max<size_t>(m_Samples.size(), layer.Current.Sampler.BoundTrackNum()));
+    }
+}
+
+void PoseBlender::Stop(uint32_t layer_idx, float fade_frames)
+{
+    Play(layer_idx, nullptr, fade_frames);
+}
+
+void PoseBlender::Apply(float frame, LocalPose* pose)
+{
+    m_Frame = frame;
+    for (auto& layer : m_Layers) {
+        if (!layer.Current.Motion && layer.FadeFrames <= 0.0f) {
+            continue;
+        }
+
+        layer.Pose.Reset();
+        if (layer.Current.Motion) {
+            SampleClip(layer.Current, layer.Desc.Loop, frame, &layer.Pose);
+        }
+
+        if (layer.FadeFrames > 0.0f) {
+            const float elapsed = frame - layer.FadeStartFrame;
+            if (elapsed < 0.0f || elapsed >= layer.FadeFrames) {
+                // tF[hÎőÕ[V͔j
+                layer.Previous = Clip();
+                layer.FadeFrames = 0.0f;
+                ++m_Revision;
+            }
+            else if (layer.FadeFromSnapshot) {
+                Crossfade(layer.FadePose, elapsed / layer.FadeFrames, &layer.Pose);
+            }
+            else {
+                layer.FadePose.Reset();
+                if (layer.Previous.Motion) {
+                    SampleClip(layer.Previous, layer.Desc.Loop, frame, &layer.FadePose);
+                }
+                Crossfade(layer.FadePose, elapsed / layer.FadeFrames, &layer.Pose);
+            }
+        }
+
+        Blend(layer.Pose, layer.Desc, pose);
+    }
+}
+
+void PoseBlender::SampleClip(Clip& clip, bool loop, float frame, LocalPose* pose)
+{
+    // AN^[̃[VƓAŌ̃L[t[̎̃t[Ő擪ɖ߂
+    const float length = static_cast<float>(clip.Motion->MaxKeyFrameNo() + 1);
+    float local_frame = std::max(frame - clip.StartFrame, 0.0f);
+    local_frame = loop ? std::fmod(local_frame, length) : std::min(local_frame, length - 1.0f);
+
+    // L[t[͐őIсA͕ԂɎg
+    const uint32_t num = clip.Sampler.Sample(static_cast<uint32_t>(local_frame), m_Samples.data());
+    pose->Sample(m_Samples.data(), num, local_frame, clip.Motion->GetEasing());
+}
+
+uint32_t PoseBlender::Revision() const
+{
+    return m_Revision;
+}
+
+void PoseBlender::Crossfade(const LocalPose& from, float t, LocalPose* to)
+{
+    // ɂ{[͕ԂAЕɂ{[͊^tF[h
+    const uint32_t bone_num = to->BoneNum();
+    for (uint32_t i = 0; i < bone_num; ++i) {
+        const float from_weight = from.Weights[i];
+        const float to_weight = to->Weights[i];
+        if (from_weight <= 0.0f) {
+            to->Weights[i] = to_weight * t;
+            continue;
+        }
+        if (to_weight <= 0.0f) {
+            to->Rotations[i] = from.Rotations[i];
+            to->Translations[i] = from.Translations[i];
+            to->Weights[i] = from_weight * (1.0f - t);
+            continue;
+        }
+
+        const DirectX::XMVECTOR rotation = QuaternionNlerp(
+            DirectX::XMLoadFloat4(&from.Rotations[i]), DirectX::XMLoadFloat4(&to->Rotations[i]), t);
+        const DirectX::XMVECTOR translation = DirectX::XMVectorLerp(
+            DirectX::XMLoadFloat3(&from.Translations[i]), DirectX::XMLoadFloat3(&to->Translations[i]), t);
+        DirectX::XMStoreFloat4(&to->Rotations[i], rotation);
+        DirectX::XMStoreFloat3(&to->Translations[i], translation);
+        to->Weights[i] = from_weight + (to_weight - from_weight) * t;
+    }
+}
+
+void PoseBlender::Blend(const LocalPose& layer_pose, const PoseLayerDesc& desc, LocalPose* pose)
+{
+    const uint32_t bone_num = std::min(layer_pose.BoneNum(), pose->BoneNum());
+    const bool masked = !desc.Mask.empty();
+    const DirectX::XMVECTOR identity = DirectX::XMQuaternionIdentity();
+    for (uint32_t i = 0; i < bone_num; ++i) {
+        float weight = desc.Weight * layer_pose.Weights[i];
+        if (masked) {
+            weight *= i < desc.Mask.size() ? desc.Mask[i] : 0.0f;
+        }
+        if (weight <= 0.0f) {
+            continue;
+        }
+
+        const DirectX::XMVECTOR base_rotation = DirectX::XMLoadFloat4(&pose->Rotations[i]);
+        const DirectX::XMVECTOR base_translation = DirectX::XMLoadFloat3(&pose->Translations[i]);
+        const DirectX::XMVECTOR layer_rotation = DirectX::XMLoadFloat4(&layer_pose.Rotations[i]);
+        const DirectX::XMVECTOR layer_translation = DirectX::XMLoadFloat3(&layer_pose.Translations[i]);
+
+        DirectX::XMVECTOR rotation;
+        DirectX::XMVECTOR translation;
+        if (desc.Mode == PoseBlendMode::Override) {
+            rotation = QuaternionNlerp(base_rotation, layer_rotation, weight);
+            translation = DirectX::XMVectorLerp(base_translation, layer_translation, weight);
+        }
+        else {
+            // C[̉]{[̃[JԂŐɊ|
+            const DirectX::XMVECTOR delta = QuaternionNlerp(identity, layer_rotation, weight);
+            rotation = DirectX::XMQuaternionNormalize(DirectX::XMQuaternionMultiply(delta, base_rotation));
+            translation = DirectX::XMVectorMultiplyAdd(layer_translation, DirectX::XMVectorReplicate(weight), base_translation);
+        }
+        DirectX::XMStoreFloat4(&pose->Rotations[i], rotation);
+        DirectX::XMStoreFloat3(&pose->Translations[i], translation);
+        pose->Weights[i] = std::max(pose->Weights[i], weight);
+    }
+}
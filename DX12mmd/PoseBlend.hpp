@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "VMD.hpp"
+
+class PMDData;
+class Skeleton;
+
+// {[̃[Jpivf̔zŎj
+//
+// ]Eʒu̓{[_𒆐SƂAf̏p̕ωʁiVMD ̃L[t[ƓjB
+// uhׂ͂Ă̌`̂܂܍sAsɂ͍̂Ō1񂾂ɂB
+struct LocalPose
+{
+    std::vector<DirectX::XMFLOAT4> Rotations;       // ]iNH[^jIj
+    std::vector<DirectX::XMFLOAT3> Translations;    // ʒu
+    std::vector<float>             Weights;         // {[̊^iL[t[̖{[ 0j
+
+    void Resize(uint32_t bone_num);
+    uint32_t BoneNum() const;
+
+    // @brief S{[pi]ȂEړȂE^ 0jɖ߂
+    void Reset();
+
+    // @brief L[t[Ԃpށi񂾃{[̊^ 1j
+    // @param samples  ÕL[t[
+    // @param num      samples ̐
+    // @param frame    t[ʒuisamples ͐őI񂾂́j
+    // @param easing   L[t[̕ԋȐ
+    void Sample(
+        const VMDMotionTable::MotionInterpolater* samples,
+        uint32_t num,
+        float frame,
+        const BezierEasingTable& easing
+    );
+};
+
+// C[̏d˕
+enum class PoseBlendMode
+{
+    Override,       // ̃C[̎pƃC[̎pEFCgŕԂ
+    Additive,       // ̃C[̎pɃC[̎pip̕ωʁjEFCg
+};
+
+// {[̃C[̃EFCgiȂS{[ 1j
+using BoneMask = std::vector<float>;
+
+// @brief {[ȉ̕؂ weight ɂ}XN
+// @param skeleton XPg
+// @param root_idx ؂̃[g̃{[ԍ
+// @param weight   ؂̃{[̃EFCgiȊÕ{[ 0j
+BoneMask CreateSubtreeMask(const Skeleton& skeleton, uint16_t root_idx, float weight = 1.0f);
+
+struct PoseLayerDesc
+{
+    PoseBlendMode Mode = PoseBlendMode::Override;
+    float         Weight = 1.0f;        // C[Ŝ̃EFCg
+    BoneMask      Mask;                 // {[̃EFCgiȂS{[j
+    bool          Loop = true;          // [V̍Ō܂ŗ擪ɖ߂邩ifalse ȂŌ̎p̂܂܁j
+};
+
+// AN^[̃[V̏ɁÃ[VC[Ƃďd˂NX
+//
+// C[͒ǉɉd˂BeC[͍Đ̃[V1A
+// [V؂ւƂ͎wt[đÕ[VNXtF[hB
+// NXtF[h́Ã[Vɂ{[͕ԂAЕɂ{[
+// ̃{[̊^tF[hĉ̃C[ƍ̂ŁA؂ւŎp΂ȂB
+// NXtF[hɂɐ؂ւꍇ́A̎_̎p~߂̂V[VփtF[hB
+// [ṼTv[̓C[Ɏ̂ŁA[V𕡐̃AN^[EC[ŋLłB
+class PoseBlender
+{
+public:
+
+    PoseBlender();
+
+    // @brief C[ōĐ郂fݒ肷if̃{[ƃ[V̑ΉtɎgj
+    // @param pmd fĩNX蒷邱Ɓj
+    void Bind(const PMDData& pmd);
+
+    // @brief C[ǉ
+    // @retval C[ԍ
+    uint32_t AddLayer(const PoseLayerDesc& desc);
+    uint32_t LayerNum() const;
+    bool IsEmpty() const;           // Đ̃[V̂郌C[
+
+    void SetLayerWeight(uint32_t layer_idx, float weight);
+    void SetLayerMask(uint32_t layer_idx, BoneMask mask);
+
+    // @brief C[̃[V؂ւiO Apply ̃t[ʒuĐj
+    // @param layer_idx   C[ԍ
+    // @param motion      Đ郂[Vinullptr Ȃ~j
+    // @param fade_frames Õ[ṼNXtF[hɂt[i0 Ȃ瑦ɐ؂ւj
+    void Play(uint32_t layer_idx, std::shared_ptr<const VMDMotionTable> motion, float fade_frames);
+    void Stop(uint32_t layer_idx, float fade_frames);
+
+    // @brief C[珇Ɏpɏd˂
+    // @param frame C[̃t[ʒuiAN^[̃[Ṽ[vł͖߂ȂAPlj
+    // @param pose  d˂̎piAN^[̃[V̎pj
+    void Apply(float frame, LocalPose* pose);
+
+    // @brief C[̍\EEFCgEĐ̃[VύXxɑԍ
+    //        t[ʒuƍ킹āAOƓpɂȂ邩̔Ɏg
+    uint32_t Revision() const;
+
+private:
+
+    // C[ōĐ̃[V
+    struct Clip
+    {
+        std::shared_ptr<const VMDMotionTable> Motion;
+        VMDMotionSampler Sampler;
+        float            StartFrame;        // Đn߂C[̃t[ʒu
+    };
+
+    struct Layer
+    {
+        PoseLayerDesc Desc;
+        Clip          Current;
+        Clip          Previous;             // NXtF[h̑Õ[V
+        float         FadeStartFrame;
+        float         FadeFrames;           // 0 ȂNXtF[hĂȂ
+        bool          FadeFromSnapshot;     // FadePosei؂ւ̃C[̎pjtF[h
+        LocalPose     Pose;                 // C[̎piO Apply ̌ʁj
+        LocalPose     FadePose;             // Õ[V̎p
+    };
+
+    void SampleClip(Clip& clip, bool loop, float frame, LocalPose* pose);
+    static void Crossfade(const LocalPose& from, float t, LocalPose* to);
+    static void Blend(const LocalPose& layer_pose, const PoseLayerDesc& desc, LocalPose* pose);
+
+    const PMDData*             m_PMDData;
+    uint32_t                   m_BoneNum;
+    float                      m_Frame;            // O Apply ̃t[ʒu
+    uint32_t                   m_Revision;
+    std::vector<Layer>         m_Layers;
+    std::vector<VMDMotionTable::MotionInterpolater> m_Samples;   // TvO̍Ɨ̈
+};
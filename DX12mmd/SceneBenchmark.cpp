@@ -0,0 +1,85 @@
+#include "SceneBenchmark.hpp"
+#include "ActorScene.hpp"
+#include "AnimationClock.hpp"
+#include "ThreadPool.hpp"
+
+#include <memory>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+namespace
+{
+    void SetSceneClock(ActorScene* scene, const AnimationClockPtr& clock, ThreadPool* pool)
+    {
+        for (uint32_t i = 0; i < scene->ActorNum(); ++i) {
+            const PMDActorPtr& actor = scene->GetActor(i);
+            actor->SetClock(clock);
+            actor->GetIKSolver().SetThreadPool(pool);
+            // Ȏ̉n߂ƁAɑXbhقǗLɂȂ̂Ŏ̂ĂĂ
+            actor->GetIKSolver().ResetWarmStart();
+        }
+    }
+}
+
+std::vector<SceneBenchmarkResult> RunSceneBenchmark(ActorScene* scene, const std::vector<uint32_t>& thread_nums, uint32_t frame_num)
+{
+    std::vector<SceneBenchmarkResult> results;
+    HighResolutionClock timer;
+
+    for (uint32_t thread_num : thread_nums) {
+        if (thread_num == 0) {
+            continue;
+        }
+
+        // ĂяoXbhXV̂ŁA[J[1ȂĂ悢
+        std::unique_ptr<ThreadPool> pool;
+        if (thread_num >= 2) {
+            pool = std::make_unique<ThreadPool>(thread_num - 1);
+        }
+
+        // ǂ̃Xbhłt[ʒu̗XV
+        auto clock = std::make_shared<ManualClock>(1.0 / PMDActor::k_MotionFps);
+        SetSceneClock(scene, clock, pool.get());
+        scene->Update(pool.get());      // ̑S{[̌vZ͑Ȃ
+
+        const double start = timer.Now();
+        for (uint32_t frame = 0; frame < frame_num; ++frame) {
+            clock->Advance();
+            scene->Update(pool.get());
+        }
+        const double seconds = timer.Now() - start;
+
+        SceneBenchmarkResult result;
+        result.ThreadNum = thread_num;
+        result.FrameNum = frame_num;
+        result.Seconds = seconds;
+        result.ActorUpdatesPerSecond = seconds > 0.0 ?
+            static_cast<double>(frame_num) * scene->ActorNum() / seconds : 0.0;
+        result.Speedup = (!results.empty() && results.front().ActorUpdatesPerSecond > 0.0) ?
+            result.ActorUpdatesPerSecond / results.front().ActorUpdatesPerSecond : 1.0;
+        results.push_back(result);
+
+        // Xbhv[jOɁAAN^[OĂ
+        SetSceneClock(scene, nullptr, nullptr);
+    }
+
+    return results;
+}
+
+void ReportSceneBenchmark(const std::vector<SceneBenchmarkResult>& results, uint32_t actor_num)
+{
+    std::ostringstream oss;
+    oss << "Actor update benchmark: " << actor_num << " actors" << std::endl;
+    oss << "  threads   frames/s   actors/s  speedup" << std::endl;
+    for (const auto& result : results) {
+        const double frames_per_second = result.Seconds > 0.0 ? result.FrameNum / result.Seconds : 0.0;
+        oss << "  " << std::setw(7) << result.ThreadNum
+            << std::fixed << std::setprecision(1)
+            << "  " << std::setw(9) << frames_per_second
+            << "  " << std::setw(9) << result.ActorUpdatesPerSecond
+            << std::setprecision(2)
+            << "  " << std::setw(7) << result.Speedup << std::endl;
+    }
+    std::cout << oss.str() << std::flush;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class ActorScene;
+
+// AN^[̍XṼX[vbg̑茋ʁiXbhj
+struct SceneBenchmarkResult
+{
+    uint32_t ThreadNum;                 // XVɎgXbhiĂяoXbh܂ށj
+    uint32_t FrameNum;                  // XVt[
+    double   Seconds;                   // St[̍XVɂ
+    double   ActorUpdatesPerSecond;     // 1b̃AN^[̍XV
+    double   Speedup;                   // ŏɑXbhɑ΂鑬x
+};
+
+// @brief AN^[̍XṼX[vbgAXbhςđ
+//        AN^[̎ ManualClock ɍւAt[pς悤 1/30 bi߂B
+//        IK ̃Xbh̃Xbhv[ŉB
+//        GPU ւ̓]iActorScene::Uploadj͂Ȃ̂ŁAPMDActor::CreateMotionOnly ŗpӂAN^[B
+//        ́AAN^[̎̎擾͍\^C}[ɁAIK ̃Xbhv[͖ɂȂ
+// @param scene       AN^[
+// @param thread_nums Xbhi1 ȂXbhv[g킸AĂяoXbhōXVj
+// @param frame_num   XbhɍXVt[
+std::vector<SceneBenchmarkResult> RunSceneBenchmark(ActorScene* scene, const std::vector<uint32_t>& thread_nums, uint32_t frame_num);
+
+// @brief 茋ʂ\ɂĕWo͂ɏo
+void ReportSceneBenchmark(const std::vector<SceneBenchmarkResult>& results, uint32_t actor_num);
@@ -0,0 +1,384 @@
+#include "SceneTrack.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    bool SameFloat3(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    bool SameCamera(const SceneCamera& a, const SceneCamera& b)
+    {
+        return SameFloat3(a.Target, b.Target) && SameFloat3(a.Rotation, b.Rotation) &&
+            a.Distance == b.Distance && a.FoV == b.FoV && a.Perspective == b.Perspective;
+    }
+
+    bool SameLight(const SceneLight& a, const SceneLight& b)
+    {
+        return SameFloat3(a.Color, b.Color) && SameFloat3(a.Direction, b.Direction);
+    }
+
+    bool SameShadow(const SceneShadow& a, const SceneShadow& b)
+    {
+        return a.Mode == b.Mode && a.Distance == b.Distance;
+    }
+
+    float Lerp(float a, float b, float t)
+    {
+        return a + (b - a) * t;
+    }
+
+    // L[t[t[ԍ̏ɕׂYit[ԍ̓t@C̏̂܂܁j
+    template <typename T>
+    std::vector<uint32_t> SortedOrder(const std::vector<T>& keys)
+    {
+        std::vector<uint32_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(
+            order.begin(), order.end(),
+            [&keys](uint32_t a, uint32_t b) {
+                return keys[a].FrameNo < keys[b].FrameNo;
+            }
+        );
+        return order;
+    }
+}
+
+//
+// Implements struct SceneCamera
+//
+
+DirectX::XMFLOAT3 SceneCamera::Eye() const
+{
+    // _ Z ɋꂽ_A_𒆐Sɉ]
+    const DirectX::XMMATRIX rotation = DirectX::XMMatrixRotationRollPitchYaw(Rotation.x, Rotation.y, Rotation.z);
+    const DirectX::XMVECTOR offset = DirectX::XMVector3TransformNormal(DirectX::XMVectorSet(0.0f, 0.0f, Distance, 0.0f), rotation);
+
+    DirectX::XMFLOAT3 eye;
+    DirectX::XMStoreFloat3(&eye, DirectX::XMVectorAdd(DirectX::XMLoadFloat3(&Target), offset));
+    return eye;
+}
+
+DirectX::XMMATRIX SceneCamera::ViewMatrix() const
+{
+    //  0 ł܂悤ɁA_ł͂Ȃ] Z 
+    const DirectX::XMMATRIX rotation = DirectX::XMMatrixRotationRollPitchYaw(Rotation.x, Rotation.y, Rotation.z);
+    const DirectX::XMVECTOR forward = rotation.r[2];
+    const DirectX::XMVECTOR up = rotation.r[1];
+    const DirectX::XMFLOAT3 eye = Eye();
+
+    return DirectX::XMMatrixLookToLH(DirectX::XMLoadFloat3(&eye), forward, up);
+}
+
+DirectX::XMMATRIX SceneCamera::ProjectionMatrix(float aspect, float near_z, float far_z) const
+{
+    if (Perspective) {
+        return DirectX::XMMatrixPerspectiveFovLH(FoV, aspect, near_z, far_z);
+    }
+
+    // séA_̈ʒuœeƓ͈͂f傫ɂ
+    const float height = std::max(std::abs(Distance) * std::tan(FoV * 0.5f) * 2.0f, 1.0e-3f);
+    return DirectX::XMMatrixOrthographicLH(height * aspect, height, near_z, far_z);
+}
+
+//
+// Implements class SceneTrackEvaluator
+//
+
+SceneTrackEvaluator::SceneTrackEvaluator()
+    :
+    m_Easing(),
+    m_CameraFrameNos(),
+    m_CameraKeys(),
+    m_LightFrameNos(),
+    m_LightKeys(),
+    m_ShadowFrameNos(),
+    m_ShadowKeys(),
+    m_CameraCursor(),
+    m_LightCursor(),
+    m_ShadowCursor(),
+    m_LastFrameNo(0),
+    m_ForceDirty(true),
+    m_Camera{ DirectX::XMFLOAT3(0.0f, 10.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), -45.0f, DirectX::XMConvertToRadians(30.0f), true },
+    m_Light{ DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f), DirectX::XMFLOAT3(1.0f, -1.0f, 1.0f) },
+    m_Shadow{ 0, 0.0f }
+{
+    Reset();
+}
+
+void SceneTrackEvaluator::SetDefault(const SceneCamera& camera, const SceneLight& light, const SceneShadow& shadow)
+{
+    m_Camera = camera;
+    m_Light = light;
+    m_Shadow = shadow;
+    Reset();
+}
+
+void SceneTrackEvaluator::Bind(const VMDMotionTable& table)
+{
+    m_Easing = BezierEasingTable();
+
+    // J
+    // ԃp[^ X, Y, Z, ], , p ̏ 4byte  x1, x2, y1, y2 ł
+    const auto& cameras = table.GetCameraList();
+    m_CameraFrameNos.clear();
+    m_CameraKeys.clear();
+    m_CameraFrameNos.reserve(cameras.size());
+    m_CameraKeys.reserve(cameras.size());
+    for (uint32_t idx : SortedOrder(cameras)) {
+        const VMDCamera& camera = cameras[idx];
+
+        CameraKey key;
+        key.Value.Target = camera.Pos;
+        key.Value.Rotation = camera.EulerAngle;
+        key.Value.Distance = camera.Distance;
+        key.Value.FoV = DirectX::XMConvertToRadians(static_cast<float>(camera.FoV));
+        key.Value.Perspective = camera.PersFlg == 0;
+        for (uint32_t c = 0; c < k_CameraChannelNum; ++c) {
+            const uint8_t* bezier = &camera.Interpolation[c * 4];
+            key.Curves[c] = m_Easing.Register(bezier[0], bezier[2], bezier[1], bezier[3]);
+        }
+
+        m_CameraFrameNos.push_back(camera.FrameNo);
+        m_CameraKeys.push_back(key);
+    }
+
+    // Ɩ
+    const auto& lights = table.GetLightList();
+    m_LightFrameNos.clear();
+    m_LightKeys.clear();
+    m_LightFrameNos.reserve(lights.size());
+    m_LightKeys.reserve(lights.size());
+    for (uint32_t idx : SortedOrder(lights)) {
+        m_LightFrameNos.push_back(lights[idx].FrameNo);
+        m_LightKeys.push_back(SceneLight{ lights[idx].LightRGB, lights[idx].Vector });
+    }
+
+    // ZtVhE
+    const auto& shadows = table.GetSelfShadowList();
+    m_ShadowFrameNos.clear();
+    m_ShadowKeys.clear();
+    m_ShadowFrameNos.reserve(shadows.size());
+    m_ShadowKeys.reserve(shadows.size());
+    for (uint32_t idx : SortedOrder(shadows)) {
+        m_ShadowFrameNos.push_back(shadows[idx].FrameNo);
+        m_ShadowKeys.push_back(SceneShadow{ shadows[idx].Mode, shadows[idx].Distance });
+    }
+
+    Reset();
+}
+
+bool SceneTrackEvaluator::HasCamera() const
+{
+    return !m_CameraKeys.empty();
+}
+
+bool SceneTrackEvaluator::HasLight() const
+{
+    return !m_LightKeys.empty();
+}
+
+bool SceneTrackEvaluator::HasShadow() const
+{
+    return !m_ShadowKeys.empty();
+}
+
+uint32_t SceneTrackEvaluator::MaxKeyFrameNo() const
+{
+    uint32_t max_frame_no = 0;
+    for (const auto* frame_nos : { &m_CameraFrameNos, &m_LightFrameNos, &m_ShadowFrameNos }) {
+        if (!frame_nos->empty()) {
+            max_frame_no = std::max(max_frame_no, frame_nos->back());
+        }
+    }
+    return max_frame_no;
+}
+
+uint32_t SceneTrackEvaluator::Evaluate(float frame)
+{
+    frame = std::max(frame, 0.0f);
+    const uint32_t frame_no = static_cast<uint32_t>(frame);
+    const bool rewound = frame_no < m_LastFrameNo;
+    m_LastFrameNo = frame_no;
+
+    uint32_t dirty = 0;
+    dirty |= EvaluateCamera(frame_no, frame, rewound);
+    dirty |= EvaluateLight(frame_no, frame, rewound);
+    dirty |= EvaluateShadow(frame_no, rewound);
+
+    // L[t[̖gbN͊l̂܂܁iŏ1񂾂ύXƂj
+    if (m_ForceDirty) {
+        dirty = k_DirtyAll;
+        m_ForceDirty = false;
+    }
+    return dirty;
+}
+
+const SceneCamera& SceneTrackEvaluator::Camera() const
+{
+    return m_Camera;
+}
+
+const SceneLight& SceneTrackEvaluator::Light() const
+{
+    return m_Light;
+}
+
+const SceneShadow& SceneTrackEvaluator::Shadow() const
+{
+    return m_Shadow;
+}
+
+void SceneTrackEvaluator::Reset()
+{
+    for (Cursor* cursor : { &m_CameraCursor, &m_LightCursor, &m_ShadowCursor }) {
+        cursor->Key = k_NoKey;
+        cursor->EvaluatedKey = k_NoKey;
+        cursor->EvaluatedStatic = false;
+    }
+    m_LastFrameNo = 0;
+    m_ForceDirty = true;
+}
+
+void SceneTrackEvaluator::Seek(const std::vector<uint32_t>& frame_nos, uint32_t frame_no, bool rewound, Cursor* cursor)
+{
+    const uint32_t key_num = static_cast<uint32_t>(frame_nos.size());
+    if (!rewound) {
+        // J[\珇ɐi߁Ał͂ȂΓ񕪒T
+        uint32_t key = cursor->Key;
+        uint32_t step = 0;
+        while (step < k_LinearSearchNum) {
+            const uint32_t next = key == k_NoKey ? 0 : key + 1;
+            if (next >= key_num || frame_nos[next] > frame_no) {
+                cursor->Key = key;
+                return;
+            }
+            key = next;
+            ++step;
+        }
+        const uint32_t next = key + 1;
+        if (next >= key_num || frame_nos[next] > frame_no) {
+            cursor->Key = key;
+            return;
+        }
+    }
+
+    auto next = std::upper_bound(frame_nos.begin(), frame_nos.end(), frame_no);
+    cursor->Key = next == frame_nos.begin() ? k_NoKey : static_cast<uint32_t>(next - frame_nos.begin() - 1);
+}
+
+bool SceneTrackEvaluator::IsSkippable(const Cursor& cursor)
+{
+    // OƓԂŁA̋Ԃ̒lȂ猋ʂOƓ
+    return cursor.EvaluatedStatic && cursor.EvaluatedKey == cursor.Key;
+}
+
+uint32_t SceneTrackEvaluator::EvaluateCamera(uint32_t frame_no, float frame, bool rewound)
+{
+    if (m_CameraKeys.empty()) {
+        return 0;
+    }
+    Seek(m_CameraFrameNos, frame_no, rewound, &m_CameraCursor);
+    if (IsSkippable(m_CameraCursor)) {
+        return 0;
+    }
+
+    // ŏ̃L[t[O͍ŏ̃L[t[̒l
+    const uint32_t key_num = static_cast<uint32_t>(m_CameraKeys.size());
+    const uint32_t begin_idx = m_CameraCursor.Key == k_NoKey ? 0 : m_CameraCursor.Key;
+    const uint32_t end_idx = m_CameraCursor.Key == k_NoKey || begin_idx + 1 >= key_num ? begin_idx : begin_idx + 1;
+    const CameraKey& begin = m_CameraKeys[begin_idx];
+    const CameraKey& end = m_CameraKeys[end_idx];
+
+    // 1t[̃L[t[̓JbgiBegin ̓t[ʒu̐őIł̂ŁABegin ̂܂܎̃L[t[ɐ؂ւj
+    const uint32_t span = m_CameraFrameNos[end_idx] - m_CameraFrameNos[begin_idx];
+    const bool is_static = span <= 1 || SameCamera(begin.Value, end.Value);
+
+    SceneCamera camera = begin.Value;
+    if (!is_static) {
+        // MMD ƓAEnd ɌԂɂ End ̕ԋȐg
+        const float x = std::clamp((frame - static_cast<float>(m_CameraFrameNos[begin_idx])) / static_cast<float>(span), 0.0f, 1.0f);
+        DirectX::XMFLOAT4 t;
+        DirectX::XMStoreFloat4(&t, m_Easing.Evaluate4(end.Curves, x));
+
+        camera.Target.x = Lerp(begin.Value.Target.x, end.Value.Target.x, t.x);
+        camera.Target.y = Lerp(begin.Value.Target.y, end.Value.Target.y, t.y);
+        camera.Target.z = Lerp(begin.Value.Target.z, end.Value.Target.z, t.z);
+        // ]̓IC[p̂܂ܕԂi1ȏ񂷃J[N̂܂܍Čłj
+        camera.Rotation.x = Lerp(begin.Value.Rotation.x, end.Value.Rotation.x, t.w);
+        camera.Rotation.y = Lerp(begin.Value.Rotation.y, end.Value.Rotation.y, t.w);
+        camera.Rotation.z = Lerp(begin.Value.Rotation.z, end.Value.Rotation.z, t.w);
+        camera.Distance = Lerp(begin.Value.Distance, end.Value.Distance, m_Easing.Evaluate(end.Curves[k_CameraDistance], x));
+        camera.FoV = Lerp(begin.Value.FoV, end.Value.FoV, m_Easing.Evaluate(end.Curves[k_CameraFoV], x));
+    }
+
+    m_CameraCursor.EvaluatedKey = m_CameraCursor.Key;
+    m_CameraCursor.EvaluatedStatic = is_static;
+    if (SameCamera(camera, m_Camera)) {
+        return 0;
+    }
+    m_Camera = camera;
+    return k_DirtyCamera;
+}
+
+uint32_t SceneTrackEvaluator::EvaluateLight(uint32_t frame_no, float frame, bool rewound)
+{
+    if (m_LightKeys.empty()) {
+        return 0;
+    }
+    Seek(m_LightFrameNos, frame_no, rewound, &m_LightCursor);
+    if (IsSkippable(m_LightCursor)) {
+        return 0;
+    }
+
+    const uint32_t key_num = static_cast<uint32_t>(m_LightKeys.size());
+    const uint32_t begin_idx = m_LightCursor.Key == k_NoKey ? 0 : m_LightCursor.Key;
+    const uint32_t end_idx = m_LightCursor.Key == k_NoKey || begin_idx + 1 >= key_num ? begin_idx : begin_idx + 1;
+    const SceneLight& begin = m_LightKeys[begin_idx];
+    const SceneLight& end = m_LightKeys[end_idx];
+
+    // Ɩ̃L[t[ɂ͕ԋȐ̂Ő`Ԃ
+    const uint32_t span = m_LightFrameNos[end_idx] - m_LightFrameNos[begin_idx];
+    const bool is_static = span == 0 || SameLight(begin, end);
+
+    SceneLight light = begin;
+    if (!is_static) {
+        const float x = std::clamp((frame - static_cast<float>(m_LightFrameNos[begin_idx])) / static_cast<float>(span), 0.0f, 1.0f);
+        DirectX::XMStoreFloat3(&light.Color, DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&begin.Color), DirectX::XMLoadFloat3(&end.Color), x));
+        DirectX::XMStoreFloat3(&light.Direction, DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&begin.Direction), DirectX::XMLoadFloat3(&end.Direction), x));
+    }
+
+    m_LightCursor.EvaluatedKey = m_LightCursor.Key;
+    m_LightCursor.EvaluatedStatic = is_static;
+    if (SameLight(light, m_Light)) {
+        return 0;
+    }
+    m_Light = light;
+    return k_DirtyLight;
+}
+
+uint32_t SceneTrackEvaluator::EvaluateShadow(uint32_t frame_no, bool rewound)
+{
+    if (m_ShadowKeys.empty()) {
+        return 0;
+    }
+    Seek(m_ShadowFrameNos, frame_no, rewound, &m_ShadowCursor);
+    if (IsSkippable(m_ShadowCursor)) {
+        return 0;
+    }
+
+    // ZtVhẼ͎L[t[܂Œlۂ
+    const SceneShadow& shadow = m_ShadowKeys[m_ShadowCursor.Key == k_NoKey ? 0 : m_ShadowCursor.Key];
+
+    m_ShadowCursor.EvaluatedKey = m_ShadowCursor.Key;
+    m_ShadowCursor.EvaluatedStatic = true;
+    if (SameShadow(shadow, m_Shadow)) {
+        return 0;
+    }
+    m_Shadow = shadow;
+    return k_DirtyShadow;
+}
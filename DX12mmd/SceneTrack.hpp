@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "VMD.hpp"
+#include "BezierEasing.hpp"
+
+// J̏ԁiVMD ̃JL[t[Ɠ\j
+struct SceneCamera
+{
+    DirectX::XMFLOAT3 Target;       // _
+    DirectX::XMFLOAT3 Rotation;     // _𒆐SƂ]iIC[pAWAj
+    float             Distance;     // _̋iMMD ł͕̒lŁA_̎OɎ_j
+    float             FoV;          // c̎piWAj
+    bool              Perspective;  // eifalse Ȃ畽sej
+
+    DirectX::XMFLOAT3 Eye() const;  // _W
+    DirectX::XMMATRIX ViewMatrix() const;
+
+    // @param aspect ʂ̏ci / j
+    DirectX::XMMATRIX ProjectionMatrix(float aspect, float near_z, float far_z) const;
+};
+
+// s
+struct SceneLight
+{
+    DirectX::XMFLOAT3 Color;        // CgF
+    DirectX::XMFLOAT3 Direction;    // ̌
+};
+
+// ZtVhE
+struct SceneShadow
+{
+    uint8_t Mode;                   // e[hi0:e, 1:[h1, 2:[h2j
+    float   Distance;               // e͈̔
+};
+
+// VMD ̃JEƖEZtVhẼgbN]NX
+//
+// {[̃gbNƓAL[t[̓t[ԍ̔zƃJ[\ňA
+// Oɐi񂾏ꍇ͐܂ŏɒׁA߂ꍇ傫񂾏ꍇ񕪒TB
+// J̓L[t[ 24byte ̕ԋȐiX, Y, Z, ], , pjŕԂA
+// 1t[̃L[t[̓J̐؂ւiJbgjƂĕԂȂB
+// Evaluate ͑O񂩂lςgbNtOŕԂ̂ŁAĂяo͕ς萔߂΂悢B
+// Ԃ̗[liÎ~ĂJEJbgEŌ̃L[t[ȍ~jȂA
+// J[\ԂɂԂ͕ԂrȂB
+class SceneTrackEvaluator
+{
+public:
+
+    static constexpr uint32_t k_LinearSearchNum = 4;    // 񕪒Tɐ؂ւ܂łɏɒׂL[t[
+
+    enum DirtyFlag : uint32_t
+    {
+        k_DirtyCamera = 1 << 0,
+        k_DirtyLight  = 1 << 1,
+        k_DirtyShadow = 1 << 2,
+        k_DirtyAll    = k_DirtyCamera | k_DirtyLight | k_DirtyShadow,
+    };
+
+    // J̕ԋȐ̕
+    enum CameraChannel
+    {
+        k_CameraX,
+        k_CameraY,
+        k_CameraZ,
+        k_CameraRotation,
+        k_CameraDistance,
+        k_CameraFoV,
+        k_CameraChannelNum,
+    };
+
+public:
+
+    SceneTrackEvaluator();
+
+    // @brief L[t[̖gbNŎglݒ肷
+    void SetDefault(const SceneCamera& camera, const SceneLight& light, const SceneShadow& shadow);
+
+    // @brief [ṼJEƖEZtVhẼgbNǂݍށiL[t[̓Rs[Ďj
+    void Bind(const VMDMotionTable& table);
+
+    bool HasCamera() const;
+    bool HasLight() const;
+    bool HasShadow() const;
+    uint32_t MaxKeyFrameNo() const;     // SgbN̍Ō̃L[t[ԍ
+
+    // @brief wt[̒l߂
+    // @param frame t[ʒuiԂɎgj
+    // @retval O Evaluate lςgbNiDirtyFlag ̑gݍ킹j
+    uint32_t Evaluate(float frame);
+
+    const SceneCamera& Camera() const;
+    const SceneLight& Light() const;
+    const SceneShadow& Shadow() const;
+
+    // @brief J[\擪ɖ߂A Evaluate őSgbNύXƂĕԂ
+    void Reset();
+
+private:
+
+    static constexpr uint32_t k_NoKey = 0xFFFFFFFF;
+
+    struct CameraKey
+    {
+        SceneCamera Value;
+        uint32_t    Curves[k_CameraChannelNum];     // ̃L[t[ɌԂ̕ԋȐ
+    };
+
+    // gbÑJ[\
+    struct Cursor
+    {
+        uint32_t Key;               // frame_no ȑOōŌ̃L[t[i k_NoKeyj
+        uint32_t EvaluatedKey;      // Ol߂Ƃ Key
+        bool     EvaluatedStatic;   // Ol߂Ԃ̗[l
+    };
+
+    static void Seek(const std::vector<uint32_t>& frame_nos, uint32_t frame_no, bool rewound, Cursor* cursor);
+    static bool IsSkippable(const Cursor& cursor);
+
+    uint32_t EvaluateCamera(uint32_t frame_no, float frame, bool rewound);
+    uint32_t EvaluateLight(uint32_t frame_no, float frame, bool rewound);
+    uint32_t EvaluateShadow(uint32_t frame_no, bool rewound);
+
+    BezierEasingTable        m_Easing;              // J̕ԋȐ
+    std::vector<uint32_t>    m_CameraFrameNos;      // J̃L[t[ԍij
+    std::vector<CameraKey>   m_CameraKeys;
+    std::vector<uint32_t>    m_LightFrameNos;
+    std::vector<SceneLight>  m_LightKeys;
+    std::vector<uint32_t>    m_ShadowFrameNos;
+    std::vector<SceneShadow> m_ShadowKeys;
+
+    Cursor      m_CameraCursor;
+    Cursor      m_LightCursor;
+    Cursor      m_ShadowCursor;
+    uint32_t    m_LastFrameNo;
+    bool        m_ForceDirty;       //  Evaluate őSgbNύXƂ
+
+    SceneCamera m_Camera;
+    SceneLight  m_Light;
+    SceneShadow m_Shadow;
+};
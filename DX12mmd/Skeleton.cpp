@@ -0,0 +1,166 @@
+#include "Skeleton.hpp"
+#include "PMD.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+
+Skeleton::Skeleton()
+    :
+    m_Parents(),
+    m_IkParents(),
+    m_BoneTypes(),
+    m_RestPositions(),
+    m_Hash(k_FNV1aOffsetBasis),
+    m_Order(),
+    m_OrderPos(),
+    m_SubtreeEnd()
+{}
+
+void Skeleton::Create(const DataView<PMDBone>& bones)
+{
+    const size_t bone_num = bones.size();
+    m_Parents.resize(bone_num);
+    m_IkParents.resize(bone_num);
+    m_BoneTypes.resize(bone_num);
+    m_RestPositions.resize(bone_num);
+
+    for (size_t idx = 0; idx < bone_num; ++idx) {
+        const PMDBone& bone = bones[idx];
+        // 肦Ȃeԍi͈͊OEgj̓[gɂ
+        m_Parents[idx] = (bone.ParentBoneNo < bone_num && bone.ParentBoneNo != idx) ? bone.ParentBoneNo : k_InvalidBoneIdx;
+        m_IkParents[idx] = bone.IkBoneNo;
+        m_BoneTypes[idx] = bone.BoneType;
+        m_RestPositions[idx] = bone.Pos;
+    }
+    m_Hash = HashFNV1a(bones.data(), bone_num * sizeof(PMDBone));
+
+    BuildOrder();
+}
+
+void Skeleton::BuildOrder()
+{
+    const size_t bone_num = m_Parents.size();
+
+    // q̈ꗗ CSR `i擪ʒu̔z{qԍ̔zjō
+    std::vector<uint16_t> child_begin(bone_num + 1, 0);
+    for (size_t idx = 0; idx < bone_num; ++idx) {
+        if (m_Parents[idx] != k_InvalidBoneIdx) {
+            ++child_begin[m_Parents[idx] + 1];
+        }
+    }
+    for (size_t idx = 0; idx < bone_num; ++idx) {
+        child_begin[idx + 1] += child_begin[idx];
+    }
+    std::vector<uint16_t> children(child_begin[bone_num]);
+    std::vector<uint16_t> fill(child_begin.begin(), child_begin.end() - 1);
+    for (size_t idx = 0; idx < bone_num; ++idx) {
+        if (m_Parents[idx] != k_InvalidBoneIdx) {
+            children[fill[m_Parents[idx]]++] = static_cast<uint16_t>(idx);
+        }
+    }
+
+    m_Order.clear();
+    m_Order.reserve(bone_num);
+    m_OrderPos.assign(bone_num, k_InvalidBoneIdx);
+    m_SubtreeEnd.assign(bone_num, 0);
+
+    // [DisjŕׂBċA͂AÕX^bNŒH
+    std::vector<uint16_t> stack;
+    stack.reserve(bone_num);
+    auto visit = [&](uint16_t root) {
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint16_t idx = stack.back();
+            stack.pop_back();
+            if (m_OrderPos[idx] != k_InvalidBoneIdx) {
+                continue;
+            }
+            m_OrderPos[idx] = static_cast<uint16_t>(m_Order.size());
+            m_Order.push_back(idx);
+            // q̓{[ԍ̏̂H悤Atɐς
+            for (uint16_t c = child_begin[idx + 1]; c > child_begin[idx]; --c) {
+                stack.push_back(children[c - 1]);
+            }
+        }
+    };
+
+    for (size_t idx = 0; idx < bone_num; ++idx) {
+        if (m_Parents[idx] == k_InvalidBoneIdx) {
+            visit(static_cast<uint16_t>(idx));
+        }
+    }
+
+    // eq֌WzĂĂǂ̃[gHȂ{[́A[gɂĕтɉ
+    for (size_t idx = 0; idx < bone_num; ++idx) {
+        if (m_OrderPos[idx] == k_InvalidBoneIdx) {
+            m_Parents[idx] = k_InvalidBoneIdx;
+            visit(static_cast<uint16_t>(idx));
+        }
+    }
+
+    // ؂̏I[납狁߂iq̏I[̂ő̂́j
+    for (size_t pos = bone_num; pos > 0; --pos) {
+        const size_t p = pos - 1;
+        m_SubtreeEnd[p] = std::max<uint16_t>(m_SubtreeEnd[p], static_cast<uint16_t>(p + 1));
+        uint16_t parent = m_Parents[m_Order[p]];
+        if (parent != k_InvalidBoneIdx) {
+            uint16_t& parent_end = m_SubtreeEnd[m_OrderPos[parent]];
+            parent_end = std::max(parent_end, m_SubtreeEnd[p]);
+        }
+    }
+}
+
+uint32_t Skeleton::BoneNum() const
+{
+    return static_cast<uint32_t>(m_Parents.size());
+}
+
+uint64_t Skeleton::Hash() const
+{
+    return m_Hash;
+}
+
+const std::vector<uint16_t>& Skeleton::Parents() const
+{
+    return m_Parents;
+}
+
+const std::vector<uint16_t>& Skeleton::IkParents() const
+{
+    return m_IkParents;
+}
+
+const std::vector<uint8_t>& Skeleton::BoneTypes() const
+{
+    return m_BoneTypes;
+}
+
+const std::vector<DirectX::XMFLOAT3>& Skeleton::RestPositions() const
+{
+    return m_RestPositions;
+}
+
+const std::vector<uint16_t>& Skeleton::Order() const
+{
+    return m_Order;
+}
+
+const std::vector<uint16_t>& Skeleton::OrderPositions() const
+{
+    return m_OrderPos;
+}
+
+const std::vector<uint16_t>& Skeleton::SubtreeEnds() const
+{
+    return m_SubtreeEnd;
+}
+
+void Skeleton::CollectSubtree(uint16_t root_idx, std::vector<uint16_t>* bones) const
+{
+    if (root_idx >= m_OrderPos.size()) {
+        return;
+    }
+
+    const uint16_t begin = m_OrderPos[root_idx];
+    bones->insert(bones->end(), m_Order.begin() + begin, m_Order.begin() + m_SubtreeEnd[begin]);
+}
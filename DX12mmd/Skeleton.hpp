@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "MappedFile.hpp"
+
+struct PMDBone;
+
+// ǂݍݎɃ{[Kw𕽒RXPg
+//
+// {[͗vf̔ziSoAjŎA{[ԍňB
+// ʂɁueKqOɗv[Disj̕т̂ŁA
+// [hῗ̕т擪1Ȃ߂邾ŌvZłB
+// sȂ̂ŁA{[̎q͕т̒ŘA͈͂ɂȂB
+class Skeleton
+{
+public:
+
+    static constexpr uint16_t k_InvalidBoneIdx = 0xFFFF;
+
+    Skeleton();
+
+    void Create(const DataView<PMDBone>& bones);
+
+    uint32_t BoneNum() const;
+
+    // @brief {[\iOEeq֌WE_Ȃǁj̃nbV
+    //        Ă񂾃[VXPg̔Ɏg
+    uint64_t Hash() const;
+
+    const std::vector<uint16_t>& Parents() const;                       // {[ԍ̐e{[ԍi[g k_InvalidBoneIdxj
+    const std::vector<uint16_t>& IkParents() const;                     // {[ԍIKe{[ԍ
+    const std::vector<uint8_t>& BoneTypes() const;                      // {[ԍ̃{[
+    const std::vector<DirectX::XMFLOAT3>& RestPositions() const;        // {[ԍ̃{[_
+    const std::vector<uint16_t>& Order() const;                         // eɗсi{[ԍ̗j
+
+    const std::vector<uint16_t>& OrderPositions() const;                // {[ԍ Order ̈ʒu
+    const std::vector<uint16_t>& SubtreeEnds() const;                   // Order ̈ʒúA؂̏I[ïʒu͊܂܂Ȃj
+
+    // @brief {[ƁA̎q̃{[ԍeɗ鏇ŏW߂
+    // @param root_idx ؂̃[g̃{[ԍ
+    // @param bones    {[ԍ̒ǉ
+    void CollectSubtree(uint16_t root_idx, std::vector<uint16_t>* bones) const;
+
+private:
+
+    void BuildOrder();
+
+    std::vector<uint16_t>          m_Parents;
+    std::vector<uint16_t>          m_IkParents;
+    std::vector<uint8_t>           m_BoneTypes;
+    std::vector<DirectX::XMFLOAT3> m_RestPositions;
+    uint64_t                       m_Hash;              // PMDBone z̃nbViFNV-1aj
+
+    std::vector<uint16_t>          m_Order;             // eɗ
+    std::vector<uint16_t>          m_OrderPos;          // {[ԍ -> m_Order ̈ʒu
+    std::vector<uint16_t>          m_SubtreeEnd;        // m_Order ̈ʒúA؂̏I[ïʒu͊܂܂Ȃj
+};
@@ -0,0 +1,281 @@
+#include "SkeletonPose.hpp"
+#include "Skeleton.hpp"
+#include "PoseBlend.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    bool SameFloat4(const DirectX::XMFLOAT4& a, const DirectX::XMFLOAT4& b)
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+    }
+
+    bool SameFloat3(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+}
+
+SkeletonPose::SkeletonPose()
+    :
+    m_Skeleton(nullptr),
+    m_SourceRotations(),
+    m_SourceOffsets(),
+    m_LocalRotations(),
+    m_LocalTranslations(),
+    m_WorldRotations(),
+    m_WorldTranslations(),
+    m_LocalDirty(),
+    m_MatrixDirty(),
+    m_AnyLocalDirty(false),
+    m_AnyMatrixDirty(false),
+    m_Invalid(true)
+{}
+
+void SkeletonPose::Bind(const Skeleton& skeleton)
+{
+    m_Skeleton = &skeleton;
+
+    const uint32_t bone_num = skeleton.BoneNum();
+    const DirectX::XMFLOAT4 identity(0.0f, 0.0f, 0.0f, 1.0f);
+    const DirectX::XMFLOAT3 zero(0.0f, 0.0f, 0.0f);
+    m_SourceRotations.assign(bone_num, identity);
+    m_SourceOffsets.assign(bone_num, zero);
+    m_LocalRotations.assign(bone_num, identity);
+    m_LocalTranslations.assign(bone_num, zero);
+    m_WorldRotations.assign(bone_num, identity);
+    m_WorldTranslations.assign(bone_num, zero);
+    m_LocalDirty.assign(bone_num, 0);
+    m_MatrixDirty.assign(bone_num, 0);
+
+    Invalidate();
+}
+
+uint32_t SkeletonPose::BoneNum() const
+{
+    return static_cast<uint32_t>(m_LocalRotations.size());
+}
+
+bool SkeletonPose::SetSource(const LocalPose& pose)
+{
+    const uint32_t bone_num = std::min(BoneNum(), pose.BoneNum());
+    bool changed = false;
+    for (uint32_t i = 0; i < bone_num; ++i) {
+        if (!m_Invalid &&
+            SameFloat4(pose.Rotations[i], m_SourceRotations[i]) &&
+            SameFloat3(pose.Translations[i], m_SourceOffsets[i])) {
+            continue;
+        }
+        m_SourceRotations[i] = pose.Rotations[i];
+        m_SourceOffsets[i] = pose.Translations[i];
+        SetLocalFromSource(static_cast<uint16_t>(i));
+        m_AnyLocalDirty = true;
+        changed = true;
+    }
+
+    if (m_Invalid) {
+        // ̖͂{[܂߂đS蒼
+        for (uint32_t i = bone_num; i < BoneNum(); ++i) {
+            SetLocalFromSource(static_cast<uint16_t>(i));
+        }
+        std::fill(m_MatrixDirty.begin(), m_MatrixDirty.end(), 1);
+        m_AnyLocalDirty = true;
+        m_AnyMatrixDirty = true;
+        m_Invalid = false;
+        changed = true;
+    }
+    return changed;
+}
+
+void SkeletonPose::RestoreSource(uint16_t bone_idx)
+{
+    if (bone_idx >= BoneNum()) {
+        return;
+    }
+
+    // ͂[JpƓȂtȂ
+    const DirectX::XMFLOAT4 rotation = m_LocalRotations[bone_idx];
+    const DirectX::XMFLOAT3 translation = m_LocalTranslations[bone_idx];
+    SetLocalFromSource(bone_idx);
+    if (SameFloat4(rotation, m_LocalRotations[bone_idx]) && SameFloat3(translation, m_LocalTranslations[bone_idx])) {
+        m_LocalDirty[bone_idx] = 0;
+    }
+}
+
+void SkeletonPose::SetLocalFromSource(uint16_t bone_idx)
+{
+    SetLocal(bone_idx, DirectX::XMLoadFloat4(&m_SourceRotations[bone_idx]), DirectX::XMLoadFloat3(&m_SourceOffsets[bone_idx]));
+}
+
+void SkeletonPose::SetLocal(uint16_t bone_idx, DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR offset)
+{
+    // _ p 𒆐Sɉ] R  offset ړΐAړ p + offset - p * R ɂ̂Ɠ
+    const DirectX::XMVECTOR pos = DirectX::XMLoadFloat3(&m_Skeleton->RestPositions()[bone_idx]);
+    const DirectX::XMVECTOR translation = DirectX::XMVectorSubtract(
+        DirectX::XMVectorAdd(pos, offset),
+        DirectX::XMVector3Rotate(pos, rotation)
+    );
+
+    DirectX::XMStoreFloat4(&m_LocalRotations[bone_idx], rotation);
+    DirectX::XMStoreFloat3(&m_LocalTranslations[bone_idx], translation);
+    m_LocalDirty[bone_idx] = 1;
+}
+
+void SkeletonPose::MarkChanged()
+{
+    m_AnyLocalDirty = true;
+    m_AnyMatrixDirty = true;
+}
+
+DirectX::XMVECTOR SkeletonPose::LocalRotation(uint16_t bone_idx) const
+{
+    return DirectX::XMLoadFloat4(&m_LocalRotations[bone_idx]);
+}
+
+void SkeletonPose::SetLocalRotation(uint16_t bone_idx, DirectX::FXMVECTOR rotation)
+{
+    if (bone_idx >= BoneNum()) {
+        return;
+    }
+    SetLocal(bone_idx, rotation, DirectX::XMLoadFloat3(&m_SourceOffsets[bone_idx]));
+}
+
+void SkeletonPose::UpdateWorld()
+{
+    if (!m_AnyLocalDirty) {
+        return;
+    }
+
+    // s̕тł͕؂A͈͂ɂȂ̂ŁA̕t{[͈̔͂vZēǂݔ΂
+    const auto& order = m_Skeleton->Order();
+    const auto& subtree_end = m_Skeleton->SubtreeEnds();
+    const uint32_t bone_num = static_cast<uint32_t>(order.size());
+    uint32_t pos = 0;
+    while (pos < bone_num) {
+        if (m_LocalDirty[order[pos]]) {
+            const uint32_t end = subtree_end[pos];
+            ComposeRange(pos, end);
+            m_AnyMatrixDirty = true;
+            pos = end;
+        }
+        else {
+            ++pos;
+        }
+    }
+    m_AnyLocalDirty = false;
+}
+
+void SkeletonPose::UpdateWorld(const uint16_t* bones, uint32_t num)
+{
+    const auto& order_pos = m_Skeleton->OrderPositions();
+    const auto& subtree_end = m_Skeleton->SubtreeEnds();
+    for (uint32_t i = 0; i < num; ++i) {
+        // ɌvZe̕؂Ɋ܂܂Ă΁A͂Ă
+        const uint16_t idx = bones[i];
+        if (m_LocalDirty[idx]) {
+            const uint32_t begin = order_pos[idx];
+            ComposeRange(begin, subtree_end[begin]);
+        }
+    }
+}
+
+void SkeletonPose::ComposeRange(uint32_t begin_pos, uint32_t end_pos)
+{
+    // q̕ϊ x * R + t ̌ɐe̕ϊ|
+    //   R' = R * R_parent, t' = t * R_parent + t_parent
+    const auto& order = m_Skeleton->Order();
+    const auto& parents = m_Skeleton->Parents();
+    for (uint32_t pos = begin_pos; pos < end_pos; ++pos) {
+        const uint16_t idx = order[pos];
+        const uint16_t parent = parents[idx];
+        if (parent == Skeleton::k_InvalidBoneIdx) {
+            m_WorldRotations[idx] = m_LocalRotations[idx];
+            m_WorldTranslations[idx] = m_LocalTranslations[idx];
+        }
+        else {
+            const DirectX::XMVECTOR parent_rotation = DirectX::XMLoadFloat4(&m_WorldRotations[parent]);
+            const DirectX::XMVECTOR rotation = DirectX::XMQuaternionMultiply(DirectX::XMLoadFloat4(&m_LocalRotations[idx]), parent_rotation);
+            const DirectX::XMVECTOR translation = DirectX::XMVectorAdd(
+                DirectX::XMVector3Rotate(DirectX::XMLoadFloat3(&m_LocalTranslations[idx]), parent_rotation),
+                DirectX::XMLoadFloat3(&m_WorldTranslations[parent])
+            );
+            DirectX::XMStoreFloat4(&m_WorldRotations[idx], rotation);
+            DirectX::XMStoreFloat3(&m_WorldTranslations[idx], translation);
+        }
+        m_LocalDirty[idx] = 0;
+        m_MatrixDirty[idx] = 1;
+    }
+}
+
+DirectX::XMVECTOR SkeletonPose::WorldRotation(uint16_t bone_idx) const
+{
+    return DirectX::XMLoadFloat4(&m_WorldRotations[bone_idx]);
+}
+
+DirectX::XMVECTOR SkeletonPose::WorldTranslation(uint16_t bone_idx) const
+{
+    return DirectX::XMLoadFloat3(&m_WorldTranslations[bone_idx]);
+}
+
+DirectX::XMVECTOR SkeletonPose::WorldPosition(uint16_t bone_idx) const
+{
+    const DirectX::XMVECTOR pos = DirectX::XMLoadFloat3(&m_Skeleton->RestPositions()[bone_idx]);
+    return DirectX::XMVectorAdd(DirectX::XMVector3Rotate(pos, WorldRotation(bone_idx)), WorldTranslation(bone_idx));
+}
+
+void SkeletonPose::RotateWorld(uint16_t bone_idx, DirectX::FXMVECTOR delta)
+{
+    // ݈ʒu P 𒆐Sɉ: x * R + t -> (x * R + t - P) * D + P
+    const DirectX::XMVECTOR center = WorldPosition(bone_idx);
+    const DirectX::XMVECTOR rotation = DirectX::XMQuaternionNormalize(DirectX::XMQuaternionMultiply(WorldRotation(bone_idx), delta));
+    const DirectX::XMVECTOR translation = DirectX::XMVectorAdd(
+        DirectX::XMVector3Rotate(DirectX::XMVectorSubtract(WorldTranslation(bone_idx), center), delta),
+        center
+    );
+
+    // e̕ϊOă[Jpɖ߂
+    //   R = R' * R_parent^-1, t = (t' - t_parent) * R_parent^-1
+    const uint16_t parent = m_Skeleton->Parents()[bone_idx];
+    if (parent == Skeleton::k_InvalidBoneIdx) {
+        DirectX::XMStoreFloat4(&m_LocalRotations[bone_idx], rotation);
+        DirectX::XMStoreFloat3(&m_LocalTranslations[bone_idx], translation);
+    }
+    else {
+        const DirectX::XMVECTOR inv_parent_rotation = DirectX::XMQuaternionInverse(WorldRotation(parent));
+        DirectX::XMStoreFloat4(&m_LocalRotations[bone_idx], DirectX::XMQuaternionMultiply(rotation, inv_parent_rotation));
+        DirectX::XMStoreFloat3(
+            &m_LocalTranslations[bone_idx],
+            DirectX::XMVector3Rotate(DirectX::XMVectorSubtract(translation, WorldTranslation(parent)), inv_parent_rotation)
+        );
+    }
+
+    const uint32_t begin = m_Skeleton->OrderPositions()[bone_idx];
+    ComposeRange(begin, m_Skeleton->SubtreeEnds()[begin]);
+}
+
+bool SkeletonPose::WriteMatrices(DirectX::XMMATRIX* matrices, uint32_t num)
+{
+    if (!m_AnyMatrixDirty) {
+        return false;
+    }
+
+    const uint32_t bone_num = std::min(BoneNum(), num);
+    for (uint32_t i = 0; i < bone_num; ++i) {
+        if (!m_MatrixDirty[i]) {
+            continue;
+        }
+        DirectX::XMMATRIX mat = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(&m_WorldRotations[i]));
+        mat.r[3] = DirectX::XMVectorSetW(DirectX::XMLoadFloat3(&m_WorldTranslations[i]), 1.0f);
+        matrices[i] = mat;
+        m_MatrixDirty[i] = 0;
+    }
+    m_AnyMatrixDirty = false;
+
+    return true;
+}
+
+void SkeletonPose::Invalidate()
+{
+    m_Invalid = true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+class Skeleton;
+struct LocalPose;
+
+// {[̃[JpE[hp]iNH[^jIjƈړŎNX
+//
+// pׂ͂āup̒_ǂ֓v̍̕ϊ x' = x * R + t ŕ\B
+// [Jp͐e{[̕ϊ|ỐA[hp͐e珇Ɋ|̂ŁA
+// [hp̂܂܍sɂ̂XLjOɎg{[sɂȂB
+//
+// [Jpς{[ɂ͈tA[hp͈̕t؂vZB
+// s͍ŌɁA[hpς{[̕B
+// ~܂ĂpAꕔ̃{[ɂL[t[̖[Vł͂قƂǌvZȂB
+//
+// Aj[VEC[̌ʁíjƁAIK ̃[Jp͕ʂɎ̂ŁA
+// ͂OƓȂ IK ̌ʂ܂߂đO̎p̂܂܎gB
+//
+// dȂȂ{[̕؂ȂAʁX̃Xbh瓯ɏĂ悢iIK ̕spjB
+// ؂֐iRestoreSourceESetLocalRotationE؂ UpdateWorldERotateWorldj
+// {[̈󂵂GȂ̂ŁAIĂяoXbh MarkChanged ĂԁB
+class SkeletonPose
+{
+public:
+
+    SkeletonPose();
+
+    // @brief XPgɍ킹ė̈mۂAS{[pɂ
+    // @param skeleton XPgĩNX蒷邱Ɓj
+    void Bind(const Skeleton& skeleton);
+
+    uint32_t BoneNum() const;
+
+    // @brief Aj[VEC[̌ʂ͂ƂĐݒ肷
+    //        O̓͂ƒlႤ{[[JpĈt
+    // @param pose {[_𒆐SƂ]EړiVMD ̃L[t[Ɠ`j
+    // @retval ͂O񂩂ς{[邩
+    bool SetSource(const LocalPose& pose);
+
+    // @brief [Jp͂̒lɖ߂iIK ŏ{[OɎgj
+    void RestoreSource(uint16_t bone_idx);
+
+    // @brief ̕t{[̕؂[hpvZ
+    void UpdateWorld();
+
+    // @brief w肵{[̂A̕t̂̕؂[hpvZ
+    //        iw肵{[̕؈ȊOɂ͐GȂ̂ŁAdȂȂ؂ȂʃXbh瓯ɌĂׂj
+    // @param bones eɂȂ鏇̃{[ԍ
+    void UpdateWorld(const uint16_t* bones, uint32_t num);
+
+    // @brief ؂ɁAŜ̈i[JpEs񂪌Â{[jt
+    //        ɏĂXbhSIĂAĂяoXbhŌĂ
+    void MarkChanged();
+
+    DirectX::XMVECTOR LocalRotation(uint16_t bone_idx) const;
+
+    // @brief ͂̈ړʂ̂܂܁A{[_𒆐SƂ]ւiIK ̑Ỏn߂pj
+    //        [hp͎ UpdateWorld ŌvZ
+    void SetLocalRotation(uint16_t bone_idx, DirectX::FXMVECTOR rotation);
+
+    DirectX::XMVECTOR WorldRotation(uint16_t bone_idx) const;
+    DirectX::XMVECTOR WorldTranslation(uint16_t bone_idx) const;
+
+    // @brief {[_݈̌ʒuiUpdateWorld ̌Ɏgj
+    DirectX::XMVECTOR WorldPosition(uint16_t bone_idx) const;
+
+    // @brief {[A݈ʒu𒆐SɃ[hԂŉ]iIK pj
+    //        [JpÃ{[̕؂̃[hpɌvZ
+    // @param bone_idx {[ԍiUpdateWorld ̌Ɏgj
+    // @param delta    [hԂł̉]iNH[^jIj
+    void RotateWorld(uint16_t bone_idx, DirectX::FXMVECTOR delta);
+
+    // @brief [hpς{[s
+    // @param matrices {[ԍ̍siO񏑂񂾓eێĂ邱Ɓj
+    // @param num      matrices ̐ĩ{[͏܂Ȃj
+    // @retval 񂾍s񂪂邩
+    bool WriteMatrices(DirectX::XMMATRIX* matrices, uint32_t num);
+
+    // @brief  SetSource őS{[ύXƂA WriteMatrices őSs
+    //        iĂ񂾎pȂǁAʂ̌oHōsƂɌĂԁj
+    void Invalidate();
+
+private:
+
+    void ComposeRange(uint32_t begin_pos, uint32_t end_pos);
+    void SetLocalFromSource(uint16_t bone_idx);
+    void SetLocal(uint16_t bone_idx, DirectX::FXMVECTOR rotation, DirectX::FXMVECTOR offset);
+
+    const Skeleton* m_Skeleton;
+
+    // ́i{[_𒆐SƂ]Eړj
+    std::vector<DirectX::XMFLOAT4> m_SourceRotations;
+    std::vector<DirectX::XMFLOAT3> m_SourceOffsets;
+
+    // [Jpie̕ϊ|O x' = x * R + tj
+    std::vector<DirectX::XMFLOAT4> m_LocalRotations;
+    std::vector<DirectX::XMFLOAT3> m_LocalTranslations;
+
+    // [hp
+    std::vector<DirectX::XMFLOAT4> m_WorldRotations;
+    std::vector<DirectX::XMFLOAT3> m_WorldTranslations;
+
+    std::vector<uint8_t> m_LocalDirty;          // [JpςA؂̃[hpÂ
+    std::vector<uint8_t> m_MatrixDirty;         // [hpςAs񂪌Â
+    bool                 m_AnyLocalDirty;       // ̕t{[邩i؂̏ł MarkChanged ŕtj
+    bool                 m_AnyMatrixDirty;
+    bool                 m_Invalid;             // ́EsOƔׂɑS蒼
+};
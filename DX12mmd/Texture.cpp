@@ -21,9 +21,28 @@ void TextureGroup::SetShaderResource(ResourceManager* shader_resource)
     m_ShaderResource = shader_resource;
 }
 
+DecodedImagePtr TextureGroup::DecodeImage(const std::filesystem::path& filepath)
+{
+    // WIC̓XbhCOM̏Kv
+    HRESULT co_result = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+    auto scratch_img = std::make_shared<ScratchImage>();
+    auto result = LoadFromWICFile(filepath.c_str(), WIC_FLAGS_NONE, nullptr, *scratch_img);
+
+    if (SUCCEEDED(co_result)) {
+        CoUninitialize();
+    }
+    if (result != S_OK) {
+        return nullptr;
+    }
+
+    return scratch_img;
+}
+
 bool TextureGroup::CreateTextures(
     const std::filesystem::path& filepath,
-    TexturePtr* handle
+    TexturePtr* handle,
+    const DecodedImagePtr& decoded
 )
 {
     auto texture_cache = m_Textures.find(filepath.wstring());
@@ -31,15 +50,14 @@ bool TextureGroup::CreateTextures(
         *handle = texture_cache->second;
         return true;
     }
-    TexMetadata metadata{};
-    ScratchImage scratch_img{};
 
-    auto result = LoadFromWICFile(filepath.c_str(), WIC_FLAGS_NONE, &metadata, scratch_img);
-    if (result != S_OK) {
+    DecodedImagePtr scratch_img = decoded ? decoded : DecodeImage(filepath);
+    if (!scratch_img) {
         return false;
     }
 
-    auto img = scratch_img.GetImage(0, 0, 0);
+    const TexMetadata& metadata = scratch_img->GetMetadata();
+    auto img = scratch_img->GetImage(0, 0, 0);
     ImageFmt image_fmt = {
         img->height,
         img->width,
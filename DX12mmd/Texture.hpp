@@ -28,8 +28,14 @@ struct TexRGBA
     uint8_t R, G, B, A;
 };
 
+namespace DirectX
+{
+    class ScratchImage;
+}
+
 class Texture;
 using TexturePtr = std::shared_ptr<Texture>;
+using DecodedImagePtr = std::shared_ptr<DirectX::ScratchImage>;     // fR[hς݁iGPU]Oj̉摜
 
 class TextureGroup
 {
@@ -41,9 +47,17 @@ public:
     TextureGroup& operator=(TextureGroup&) = delete;
 
     void SetShaderResource(ResourceManager* shader_resource);
+
+    // @brief 摜t@CfR[hiGPUgȂ̂Ń[J[XbhĂł悢j
+    // @retval fR[hɎs nullptr
+    static DecodedImagePtr DecodeImage(const std::filesystem::path& filepath);
+
+    // @brief eNX`쐬
+    // @param decoded fR[hς݂̉摜inullptr Ȃ炱Ńt@Cǂݍށj
     bool CreateTextures(
         const std::filesystem::path& filepath, 
-        TexturePtr* handle
+        TexturePtr* handle,
+        const DecodedImagePtr& decoded = nullptr
     );
     bool CreatePlaneTexture(
         const std::wstring& name, 
@@ -0,0 +1,165 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    // s̃[J[̏i[J[̒o^^XN̗ɐςޗpj
+    thread_local const ThreadPool* t_Pool = nullptr;
+    thread_local uint32_t          t_WorkerIdx = 0;
+
+    // ParallelFor 1񕪂̏
+    // i[J[łāAIɎn܂^XNĜŁAshared_ptr Ŏj
+    struct ParallelForState
+    {
+        std::atomic<uint32_t> Next;     // Ɏsԍ
+        std::atomic<uint32_t> Done;     // sI
+        uint32_t              Num;
+        const std::function<void(uint32_t)>* Func;
+    };
+}
+
+ThreadPool::ThreadPool(uint32_t thread_num)
+    :
+    m_Queues(),
+    m_Workers(),
+    m_PendingNum(0),
+    m_NextQueue(0),
+    m_Mutex(),
+    m_Condition(),
+    m_Stop(false)
+{
+    if (thread_num == 0) {
+        thread_num = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // ̓[J[NOɑSĂiN[J[͂ɑ̗ɍsj
+    m_Queues.reserve(thread_num);
+    for (uint32_t i = 0; i < thread_num; ++i) {
+        m_Queues.push_back(std::make_unique<WorkQueue>());
+    }
+    m_Workers.reserve(thread_num);
+    for (uint32_t i = 0; i < thread_num; ++i) {
+        m_Workers.emplace_back([this, i]() { WorkerMain(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Condition.notify_all();
+
+    // o^ς݂̃^XNׂ͂ĎsĂI
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+}
+
+uint32_t ThreadPool::ThreadNum() const
+{
+    return static_cast<uint32_t>(m_Workers.size());
+}
+
+void ThreadPool::ParallelFor(uint32_t num, const std::function<void(uint32_t)>& func)
+{
+    if (num == 0) {
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->Next = 0;
+    state->Done = 0;
+    state->Num = num;
+    state->Func = &func;
+
+    // ԍ1荇ĎsBԍȂ^XN͂߂
+    auto run = [state]() {
+        for (uint32_t i = state->Next.fetch_add(1); i < state->Num; i = state->Next.fetch_add(1)) {
+            (*state->Func)(i);
+            state->Done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    const uint32_t helper_num = std::min(ThreadNum(), num - 1);
+    for (uint32_t i = 0; i < helper_num; ++i) {
+        Enqueue(run);
+    }
+    run();
+
+    // [J[s̎c҂
+    while (state->Done.load(std::memory_order_acquire) < num) {
+        std::this_thread::yield();
+    }
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+    const uint32_t queue_idx = (t_Pool == this) ?
+        t_WorkerIdx :
+        m_NextQueue.fetch_add(1, std::memory_order_relaxed) % ThreadNum();
+
+    // ɐ𑝂₵Ăi[J[炷OɑĂ悤Ɂj
+    m_PendingNum.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(m_Queues[queue_idx]->Mutex);
+        m_Queues[queue_idx]->Tasks.emplace_back(std::move(task));
+    }
+    {
+        // 낤ƂĂ郏[J[N˂Ȃ悤Am_Mutex ĂN
+        std::lock_guard<std::mutex> lock(m_Mutex);
+    }
+    m_Condition.notify_one();
+}
+
+bool ThreadPool::TryPop(uint32_t worker_idx, std::function<void()>* task)
+{
+    // ̗͌iŌɐς񂾂́j
+    {
+        WorkQueue& queue = *m_Queues[worker_idx];
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        if (!queue.Tasks.empty()) {
+            *task = std::move(queue.Tasks.back());
+            queue.Tasks.pop_back();
+            m_PendingNum.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // ̃[J[̗͑Oiŏɐς܂ꂽ́j瓐
+    const uint32_t queue_num = static_cast<uint32_t>(m_Queues.size());
+    for (uint32_t i = 1; i < queue_num; ++i) {
+        WorkQueue& queue = *m_Queues[(worker_idx + i) % queue_num];
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        if (!queue.Tasks.empty()) {
+            *task = std::move(queue.Tasks.front());
+            queue.Tasks.pop_front();
+            m_PendingNum.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::WorkerMain(uint32_t worker_idx)
+{
+    t_Pool = this;
+    t_WorkerIdx = worker_idx;
+
+    while (true) {
+        std::function<void()> task;
+        if (TryPop(worker_idx, &task)) {
+            task();
+            continue;
+        }
+
+        // ǂ̗ȂA^XNς܂܂Ŗ
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this]() { return m_Stop || m_PendingNum.load() > 0; });
+        if (m_Stop && m_PendingNum.load() == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+// Œ萔̃[J[XbhŃ^XNsXbhv[
+//
+// ^XN̗̓[J[Ɏi[NXeB[OjB
+// [J[̒o^^XN͂̃[J[̗̌ɐς݁A͌납B
+// ̗񂪋ɂȂ[J[́Ã[J[̗̑OB
+// [J[ȊOo^^XŃA[J[̗ɏɐU蕪B
+class ThreadPool
+{
+public:
+
+    // @param thread_num [J[Xbhi0Ȃn[hEFAXbhj
+    explicit ThreadPool(uint32_t thread_num = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // @brief ^XNo^
+    // @retval ^XN̖߂l󂯎 future
+    template <typename F>
+    auto Submit(F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        std::future<Result> result = task->get_future();
+        Enqueue([task]() { (*task)(); });
+
+        return result;
+    }
+
+    // @brief func(0) ` func(num - 1) ĂяoXbhƃ[J[ŕĎsASI܂ő҂
+    //        ĂяoXbhŝŁA[J[̃^XNŖ܂ĂĂA^XN̒Ăł~܂Ȃ
+    void ParallelFor(uint32_t num, const std::function<void(uint32_t)>& func);
+
+    uint32_t ThreadNum() const;
+
+private:
+
+    // [J[̃^XN̗
+    struct WorkQueue
+    {
+        std::mutex                        Mutex;
+        std::deque<std::function<void()>> Tasks;
+    };
+
+    void Enqueue(std::function<void()> task);
+    bool TryPop(uint32_t worker_idx, std::function<void()>* task);
+    void WorkerMain(uint32_t worker_idx);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues;   // [J[ԍ
+    std::vector<std::thread>          m_Workers;
+    std::atomic<uint32_t>             m_PendingNum;     // ɐς܂ĂāA܂ĂȂ^XN
+    std::atomic<uint32_t>             m_NextQueue;      // [J[ȊOo^^XN̐U蕪
+    std::mutex                        m_Mutex;          // Ă郏[J[Np
+    std::condition_variable           m_Condition;
+    bool                              m_Stop;
+};
@@ -1,84 +1,101 @@
 #include "VMD.hpp"
+#include "PMD.hpp"
+#include "CompressedMotion.hpp"
 
 #include <fstream>
 #include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // ƃR[h̔z񂩂ȂZNVǂށit@CrŏIĂ΋ɂj
+    template <typename T>
+    void ReadSection(std::ifstream& ifs, uint32_t* num, std::vector<T>* list)
+    {
+        *num = 0;
+        ifs.read(reinterpret_cast<char*>(num), sizeof(*num));
+        if (!ifs) {
+            *num = 0;
+        }
+        list->resize(*num);
+        ifs.read(reinterpret_cast<char*>(list->data()), sizeof(T) * *num);
+        if (!ifs) {
+            *num = 0;
+            list->clear();
+        }
+    }
+}
 
 MotionKeyFrame::MotionKeyFrame(
     uint32_t frame_no, 
     const DirectX::XMFLOAT4& q, 
     const DirectX::XMFLOAT3& offset,
-    const DirectX::XMFLOAT2& p1, 
-    const DirectX::XMFLOAT2& p2
+    const uint32_t* curves
 )
     :
     FrameNo(frame_no),
     Quaternion(q),
-    Offset(offset),
-    RotateBezierP1(p1),
-    RotateBezierP2(p2)
-{}
+    Offset(offset)
+{
+    std::copy_n(curves, BezierEasingTable::k_ChannelNum, Curves);
+}
 
 VMDMotionTable::VMDMotionTable()
     :
     m_MotionDataNum(0),
-    m_MotionList()
+    m_MotionList(),
+    m_MaxKeyFrameNo(0),
+    m_Easing(),
+    m_CompressedMotion(),
+    m_MorphDataNum(0),
+    m_MorphList(),
+    m_MorphTable(),
+    m_CameraDataNum(0),
+    m_CameraList(),
+    m_LightDataNum(0),
+    m_LightList(),
+    m_SelfShadowDataNum(0),
+    m_SelfShadowList(),
+    m_IKSwitchNum(0),
+    m_IKSwitchList()
 {}
 
-double VMDMotionTable::MotionInterpolater::GetYFromXOnBezier(double x, const DirectX::XMFLOAT2& p1, const DirectX::XMFLOAT2& p2, uint8_t count) const
+void VMDMotionTable::MotionInterpolater::Slerp(
+    float frame, const BezierEasingTable& easing, DirectX::XMMATRIX* rotate_mat_out, DirectX::XMVECTOR* offset_out ) const
 {
-    // xWFȐԂȂvZsvƂB
-    constexpr double e = std::numeric_limits<double>::epsilon();
-    if ((std::abs(p1.x - p1.y) < e) && (std::abs(p2.x - p2.y) < e)) {
-        return x;
-    }
-
-    double t = x;
-    const float k0 = 1.0 + (3.0 * p1.x) - (3.0 * p2.x);
-    const float k1 = (3.0 * p2.x) - (6.0 * p1.x);
-    const float k2 = 3.0 * p1.x;
-
-    // Ő؂덷
-    constexpr double stop_eps = 0.0005;
-
-    // x  tߎŋ߂
-    for (int i = 0; i < count; ++i) {
-        // f(t)߂
-        double ft = (k0 * t * t * t) + (k1 * t * t) + (k2 * t) - x;
-        // ʂŐ؂덷ł؂
-        if (ft < stop_eps && ft > stop_eps) {
-            break;
-        }
-
-        t -= ft / 2;
-    }
-
-    double r = 1 - t;
-    return (t * t * t) + (3 * t * t * r * p2.y) + (3 * t * r * r * p1.y);
+    DirectX::XMVECTOR rotation;
+    Interpolate(frame, easing, &rotation, offset_out);
+    *rotate_mat_out = DirectX::XMMatrixRotationQuaternion(rotation);
 }
 
-void VMDMotionTable::MotionInterpolater::Slerp(
-    uint32_t frame_no, DirectX::XMMATRIX* rotate_mat_out, DirectX::XMVECTOR* offset_out ) const
+void VMDMotionTable::MotionInterpolater::Interpolate(
+    float frame, const BezierEasingTable& easing, DirectX::XMVECTOR* rotation_out, DirectX::XMVECTOR* offset_out) const
 {
-    DirectX::XMVECTOR begin_offset = DirectX::XMLoadFloat3(&(Begin.Offset));
-    if (Begin.FrameNo == End.FrameNo) {
-        *rotate_mat_out = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(&Begin.Quaternion));
+    DirectX::XMVECTOR begin_offset = DirectX::XMLoadFloat3(&(Begin->Offset));
+    if (Begin->FrameNo == End->FrameNo) {
+        *rotation_out = DirectX::XMLoadFloat4(&Begin->Quaternion);
         *offset_out = begin_offset;
     }
     else {
-        float t = static_cast<float>(frame_no - Begin.FrameNo) / static_cast<float>(End.FrameNo - Begin.FrameNo);
-        t = GetYFromXOnBezier(t, Begin.RotateBezierP1, Begin.RotateBezierP2, 12);
-
-        DirectX::XMMATRIX rotation =
-            DirectX::XMMatrixRotationQuaternion(
-                DirectX::XMQuaternionSlerp(DirectX::XMLoadFloat4(&Begin.Quaternion), DirectX::XMLoadFloat4(&End.Quaternion), t)
-            );
+        // MMD ł̓L[t[̕ԋȐ́ÃL[t[ɌԂɎg
+        // BeginEEnd  frame ̐őIł̂ŁAx ͏̕炩ɐi
+        float x = (frame - static_cast<float>(Begin->FrameNo)) / static_cast<float>(End->FrameNo - Begin->FrameNo);
+        x = std::clamp(x, 0.0f, 1.0f);
+        DirectX::XMVECTOR t = easing.Evaluate4(End->Curves, x);
+
+        *rotation_out = DirectX::XMQuaternionSlerp(
+            DirectX::XMLoadFloat4(&Begin->Quaternion),
+            DirectX::XMLoadFloat4(&End->Quaternion),
+            DirectX::XMVectorGetW(t)
+        );
 
-        *rotate_mat_out = rotation;
-        *offset_out = DirectX::XMVectorLerp(begin_offset, DirectX::XMLoadFloat3(&(End.Offset)), t);
+        // ʒu X, Y, Z ꂼ̋ȐŕԂ
+        DirectX::XMVECTOR end_offset = DirectX::XMLoadFloat3(&(End->Offset));
+        *offset_out = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorSubtract(end_offset, begin_offset), t, begin_offset);
     }
 }
 
-bool VMDMotionTable::Open(const std::filesystem::path& filename)
+bool VMDMotionTable::Open(const std::filesystem::path& filename, bool load_bone_motion)
 {
     std::ifstream ifs(filename, std::ios::in | std::ios::binary);
     if (!ifs) {
@@ -90,7 +107,11 @@ bool VMDMotionTable::Open(const std::filesystem::path& filename)
     // [Vf[^ǂݍ
     ifs.read(reinterpret_cast<char*>(&m_MotionDataNum), sizeof(m_MotionDataNum));
 
-    std::vector<VMDMotion> vmd_motion_data(m_MotionDataNum);
+    // {[[Vǂ܂Ȃꍇ́A\ȍ~̃f[^܂œǂݔ΂
+    std::vector<VMDMotion> vmd_motion_data(load_bone_motion ? m_MotionDataNum : 0);
+    if (!load_bone_motion) {
+        ifs.seekg(static_cast<std::streamoff>(m_MotionDataNum) * k_VMDMotionRecordSize, std::ios::cur);
+    }
     for (auto& motion : vmd_motion_data) {
         ifs.read(reinterpret_cast<char*>(&motion.BoneName), sizeof(motion.BoneName));
         ifs.read(
@@ -103,14 +124,22 @@ bool VMDMotionTable::Open(const std::filesystem::path& filename)
     }
 
     // VMD̃[Vf[^AۂɎgp郂[Ve[u֕ϊ
+    // ԃp[^͐擪16byte X, Y, Z, ] ̏ x1[4], y1[4], x2[4], y2[4] ł
+    m_Easing = BezierEasingTable();
     for (auto& vmd_motion : vmd_motion_data) {
+        uint32_t curves[BezierEasingTable::k_ChannelNum];
+        for (uint32_t c = 0; c < BezierEasingTable::k_ChannelNum; ++c) {
+            curves[c] = m_Easing.Register(
+                vmd_motion.Bezier[c], vmd_motion.Bezier[4 + c], vmd_motion.Bezier[8 + c], vmd_motion.Bezier[12 + c]
+            );
+        }
+
         m_MotionList[vmd_motion.BoneName].emplace_back(
             MotionKeyFrame(
                 vmd_motion.FrameNo, 
                 vmd_motion.Quaternion,
                 DirectX::XMFLOAT3(vmd_motion.Location),
-                DirectX::XMFLOAT2((vmd_motion.Bezier[3] / 127.0f), (vmd_motion.Bezier[7] / 127.0f)),
-                DirectX::XMFLOAT2((vmd_motion.Bezier[11] / 127.0f), (vmd_motion.Bezier[15] / 127.0f))
+                curves
             )
         );
 
@@ -118,10 +147,10 @@ bool VMDMotionTable::Open(const std::filesystem::path& filename)
         m_MaxKeyFrameNo = std::max(m_MaxKeyFrameNo, vmd_motion.FrameNo);
     }
 
-    // L[t[ɏ\[g
+    // L[t[ɏ\[git[̃L[t[̓t@C̏̂܂܁j
     for (auto& keyframes : m_MotionList) {
         auto& keyframelist = keyframes.second;
-        std::sort(
+        std::stable_sort(
             keyframelist.begin(), keyframelist.end(),
             [](const MotionKeyFrame& a, const MotionKeyFrame& b)
             {
@@ -135,23 +164,37 @@ bool VMDMotionTable::Open(const std::filesystem::path& filename)
     m_MorphList.resize(m_MorphDataNum);
     ifs.read(reinterpret_cast<char*>(m_MorphList.data()), sizeof(VMDMorph) * m_MorphDataNum);
 
+    // \̃L[t[XgɕϊiO15byte傤ǂ̏ꍇI[j
+    for (const auto& morph : m_MorphList) {
+        std::string name(morph.Name, strnlen(morph.Name, sizeof(morph.Name)));
+        m_MorphTable[name].emplace_back(MorphKeyFrame{ morph.FrameNo, morph.Weight });
+        m_MaxKeyFrameNo = std::max(m_MaxKeyFrameNo, morph.FrameNo);
+    }
+    for (auto& keyframes : m_MorphTable) {
+        std::stable_sort(
+            keyframes.second.begin(), keyframes.second.end(),
+            [](const MorphKeyFrame& a, const MorphKeyFrame& b) {
+                return a.FrameNo < b.FrameNo;
+            }
+        );
+    }
+
     // J
-    ifs.read(reinterpret_cast<char*>(&m_CameraDataNum), sizeof(m_CameraDataNum));
-    m_CameraList.resize(m_CameraDataNum);
-    ifs.read(reinterpret_cast<char*>(m_CameraList.data()), sizeof(VMDCamera) * m_CameraDataNum);
+    // [VEJVMD͓r̃ZNVŏIĂ邱Ƃ̂ŁAǂ߂ȂZNV͋ɂ
+    ReadSection(ifs, &m_CameraDataNum, &m_CameraList);
 
     // Ɩf[^
-    ifs.read(reinterpret_cast<char*>(&m_LightDataNum), sizeof(m_LightDataNum));
-    m_LightList.resize(m_LightDataNum);
-    ifs.read(reinterpret_cast<char*>(m_LightList.data()), sizeof(VMDLight) * m_LightDataNum);
+    ReadSection(ifs, &m_LightDataNum, &m_LightList);
 
     // ZtVhEf[^
-    ifs.read(reinterpret_cast<char*>(&m_SelfShadowDataNum), sizeof(m_SelfShadowDataNum));
-    m_SelfShadowList.resize(m_SelfShadowDataNum);
-    ifs.read(reinterpret_cast<char*>(m_SelfShadowList.data()), sizeof(VMDSelfShadow) * m_SelfShadowDataNum);
+    ReadSection(ifs, &m_SelfShadowDataNum, &m_SelfShadowList);
 
     // IK؂ւf[^
+    m_IKSwitchNum = 0;
     ifs.read(reinterpret_cast<char*>(&m_IKSwitchNum), sizeof(m_IKSwitchNum));
+    if (!ifs) {
+        m_IKSwitchNum = 0;
+    }
     m_IKSwitchList.resize(m_IKSwitchNum);
 
     for (auto& ik_enable : m_IKSwitchList) {
@@ -178,7 +221,8 @@ bool VMDMotionTable::Open(const std::filesystem::path& filename)
         }
     }
 
-    std::sort(
+    // t[̐؂ւf[^͌̂̂ĝŁAt@C̏Ȃ悤\[gɂ
+    std::stable_sort(
         m_IKSwitchList.begin(), m_IKSwitchList.end(),
         [](const VMDIKEnable& a, const VMDIKEnable& b) {
             return a.FrameNo < b.FrameNo;
@@ -189,56 +233,369 @@ bool VMDMotionTable::Open(const std::filesystem::path& filename)
     return true;
 }
 
+bool VMDMotionTable::Compress(const MotionCompressionSettings& settings)
+{
+    auto compressed = std::make_shared<CompressedMotion>();
+    if (!compressed->Build(m_MotionList, m_Easing, settings)) {
+        return false;
+    }
+
+    // kÕL[t[͔j
+    m_CompressedMotion = compressed;
+    MotionTable().swap(m_MotionList);
+
+    return true;
+}
+
+bool VMDMotionTable::IsCompressed() const
+{
+    return m_CompressedMotion != nullptr;
+}
+
+const CompressedMotion* VMDMotionTable::GetCompressedMotion() const
+{
+    return m_CompressedMotion.get();
+}
+
 const VMDMotionTable::MotionTable& VMDMotionTable::GetMotionTable() const
 {
     return m_MotionList;
 }
 
-VMDMotionTable::NowMotionListPtr VMDMotionTable::GetNowMotionList(uint32_t frame_no)
+const VMDIKEnable* VMDMotionTable::GetIKEnable(uint32_t frame_no) const
+{
+    // frame_no ̍ŏ̐؂ւf[^񕪒T
+    auto next = std::upper_bound(
+        m_IKSwitchList.begin(), m_IKSwitchList.end(), frame_no,
+        [](uint32_t frame, const VMDIKEnable& ike) {
+            return frame < ike.FrameNo;
+        }
+    );
+
+    return next == m_IKSwitchList.begin() ? nullptr : &*(next - 1);
+}
+
+const std::vector<VMDIKEnable>& VMDMotionTable::GetIKSwitchList() const
+{
+    return m_IKSwitchList;
+}
+
+const std::vector<VMDCamera>& VMDMotionTable::GetCameraList() const
+{
+    return m_CameraList;
+}
+
+const std::vector<VMDLight>& VMDMotionTable::GetLightList() const
+{
+    return m_LightList;
+}
+
+const std::vector<VMDSelfShadow>& VMDMotionTable::GetSelfShadowList() const
+{
+    return m_SelfShadowList;
+}
+
+const VMDMotionTable::MorphTable& VMDMotionTable::GetMorphTable() const
+{
+    return m_MorphTable;
+}
+
+const BezierEasingTable& VMDMotionTable::GetEasing() const
 {
-    NowMotionListPtr motion_ptr = std::make_shared<std::vector<MotionInterpolater>>();
+    return m_Easing;
+}
+
+uint32_t VMDMotionTable::MaxKeyFrameNo() const
+{
+    return m_MaxKeyFrameNo;
+}
+
+float VMDMotionTable::GetMorphWeight(const std::vector<MorphKeyFrame>& keyframes, float frame)
+{
+    if (keyframes.empty()) {
+        return 0.0f;
+    }
+
+    // frame ̍ŏ̃L[t[񕪒T
+    auto next = std::upper_bound(
+        keyframes.begin(), keyframes.end(), frame,
+        [](float f, const MorphKeyFrame& key) {
+            return f < static_cast<float>(key.FrameNo);
+        }
+    );
+    if (next == keyframes.begin()) {
+        return next->Weight;
+    }
+    auto prev = next - 1;
+    if (next == keyframes.end()) {
+        return prev->Weight;
+    }
+
+    float t = (frame - static_cast<float>(prev->FrameNo)) / static_cast<float>(next->FrameNo - prev->FrameNo);
+    return prev->Weight + (next->Weight - prev->Weight) * t;
+}
 
-    for (const auto& bone_motion : m_MotionList) {
-        // v̂T
-        auto motions = bone_motion.second;
-        auto ritr = std::find_if(
-            motions.rbegin(), motions.rend(),
-            [frame_no](const MotionKeyFrame& m) {
-                return m.FrameNo <= frame_no;
+
+//
+// Implements class VMDMotionSampler
+//
+
+VMDMotionSampler::VMDMotionSampler()
+    :
+    m_Compressed(nullptr),
+    m_Decoded(),
+    m_Tracks(),
+    m_BoundBones(),
+    m_LastFrameNo(0)
+{}
+
+void VMDMotionSampler::Bind(const VMDMotionTable& table, const PMDData& pmd, std::vector<std::string>* unmatched)
+{
+    m_Tracks.assign(pmd.BoneNum(), Track{ nullptr, nullptr, 0, 0, k_NoKey, k_NoKey });
+    m_BoundBones.clear();
+    if (unmatched) {
+        unmatched->clear();
+    }
+
+    auto bind_track = [&](const std::string& name, uint32_t key_num) -> Track* {
+        if (key_num == 0) {
+            return nullptr;
+        }
+        const uint16_t bone_idx = pmd.FindBoneIndex(name);
+        if (bone_idx == BoneTree::k_InvalidBoneIdx) {
+            if (unmatched) {
+                unmatched->push_back(name);
             }
-        );
+            return nullptr;
+        }
+        m_Tracks[bone_idx].KeyNum = key_num;
+        return &m_Tracks[bone_idx];
+    };
+
+    m_Compressed = table.GetCompressedMotion();
+    if (m_Compressed) {
+        for (uint32_t i = 0; i < m_Compressed->TrackNum(); ++i) {
+            Track* track = bind_track(m_Compressed->GetTrackName(i), m_Compressed->KeyNum(i));
+            if (track) {
+                track->FrameNos = m_Compressed->FrameNos(i);
+                track->CompressedTrack = i;
+            }
+        }
+    }
+    else {
+        for (const auto& bone_motion : table.GetMotionTable()) {
+            Track* track = bind_track(bone_motion.first, static_cast<uint32_t>(bone_motion.second.size()));
+            if (track) {
+                track->KeyFrames = &bone_motion.second;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < m_Tracks.size(); ++i) {
+        if (m_Tracks[i].KeyNum > 0) {
+            m_BoundBones.push_back(i);
+        }
+    }
+    if (unmatched) {
+        std::sort(unmatched->begin(), unmatched->end());
+    }
+
+    // k̓WJiȍ~͍ĊmۂȂ̂ŁASample ̌ʂwj
+    const uint32_t zero_curves[BezierEasingTable::k_ChannelNum] = {};
+    m_Decoded.assign(
+        m_Compressed ? m_Tracks.size() * 2 : 0,
+        MotionKeyFrame(0, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), zero_curves)
+    );
+    Reset();
+}
+
+uint32_t VMDMotionSampler::TrackNum() const
+{
+    return static_cast<uint32_t>(m_Tracks.size());
+}
+
+uint32_t VMDMotionSampler::BoundTrackNum() const
+{
+    return static_cast<uint32_t>(m_BoundBones.size());
+}
+
+bool VMDMotionSampler::HasTrack(uint32_t bone_idx) const
+{
+    return bone_idx < m_Tracks.size() && m_Tracks[bone_idx].KeyNum > 0;
+}
+
+void VMDMotionSampler::Reset()
+{
+    for (auto& track : m_Tracks) {
+        track.Cursor = k_NoKey;
+        track.DecodedCursor = k_NoKey;
+    }
+    m_LastFrameNo = 0;
+}
+
+uint32_t VMDMotionSampler::KeyFrameNo(const Track& track, uint32_t key_idx)
+{
+    return track.KeyFrames ? (*track.KeyFrames)[key_idx].FrameNo : track.FrameNos[key_idx];
+}
+
+uint32_t VMDMotionSampler::Seek(const Track& track, uint32_t frame_no)
+{
+    // frame_no ̍ŏ̃L[t[1O
+    uint32_t lo = 0;
+    uint32_t hi = track.KeyNum;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (frame_no < KeyFrameNo(track, mid)) {
+            hi = mid;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    return lo == 0 ? k_NoKey : lo - 1;
+}
 
-        if (ritr == motions.rend()) {
+uint32_t VMDMotionSampler::Sample(uint32_t frame_no, VMDMotionTable::MotionInterpolater* out)
+{
+    const bool rewound = frame_no < m_LastFrameNo;
+    m_LastFrameNo = frame_no;
+
+    uint32_t out_num = 0;
+    for (uint32_t bone_idx : m_BoundBones) {
+        Track& track = m_Tracks[bone_idx];
+        const uint32_t key_num = track.KeyNum;
+
+        if (rewound) {
+            track.Cursor = Seek(track, frame_no);
+        }
+        else {
+            // J[\珇ɐi߁Ał͂ȂΓ񕪒T
+            uint32_t cursor = track.Cursor;
+            uint32_t step = 0;
+            while (step < k_LinearSearchNum) {
+                const uint32_t next = cursor == k_NoKey ? 0 : cursor + 1;
+                if (next >= key_num || KeyFrameNo(track, next) > frame_no) {
+                    break;
+                }
+                cursor = next;
+                ++step;
+            }
+            if (step == k_LinearSearchNum) {
+                const uint32_t next = cursor + 1;
+                if (next < key_num && KeyFrameNo(track, next) <= frame_no) {
+                    cursor = Seek(track, frame_no);
+                }
+            }
+            track.Cursor = cursor;
+        }
+
+        if (track.Cursor == k_NoKey) {
             continue;
         }
-        
 
-        MotionInterpolater interpolater = {
-            bone_motion.first,
-            *ritr,
-            ritr.base() == motions.end() ? *ritr : *(ritr.base())
-        };
+        const uint32_t next = track.Cursor + 1;
+        VMDMotionTable::MotionInterpolater& result = out[out_num++];
+        result.BoneIdx = bone_idx;
+        if (track.KeyFrames) {
+            const auto& keyframes = *track.KeyFrames;
+            result.Begin = &keyframes[track.Cursor];
+            result.End = next < key_num ? &keyframes[next] : result.Begin;
+            continue;
+        }
+
+        // k̓J[\ƂÕL[t[WJ
+        MotionKeyFrame* decoded = &m_Decoded[static_cast<size_t>(bone_idx) * 2];
+        if (track.DecodedCursor != track.Cursor) {
+            m_Compressed->Decode(track.CompressedTrack, track.Cursor, &decoded[0]);
+            if (next < key_num) {
+                m_Compressed->Decode(track.CompressedTrack, next, &decoded[1]);
+            }
+            track.DecodedCursor = track.Cursor;
+        }
+        result.Begin = &decoded[0];
+        result.End = next < key_num ? &decoded[1] : result.Begin;
+    }
+
+    return out_num;
+}
+
+
+//
+// Implements class IKEnableTimeline
+//
+
+IKEnableTimeline::IKEnableTimeline()
+    :
+    m_WordNum(1),
+    m_AllEnabled(1, ~Word(0)),
+    m_FrameNos(),
+    m_Bits(),
+    m_Cursor(k_NoKey),
+    m_LastFrameNo(0)
+{}
 
-        motion_ptr->emplace_back(interpolater);
+void IKEnableTimeline::Bind(const VMDMotionTable& table, const PMDData& pmd)
+{
+    const auto& iks = pmd.GetPMDIKData();
+    const uint32_t ik_num = static_cast<uint32_t>(iks.size());
+    m_WordNum = std::max<uint32_t>((ik_num + k_WordBits - 1) / k_WordBits, 1);
+    m_AllEnabled.assign(m_WordNum, ~Word(0));
+
+    // IKԍ̃{[1񂾂ĂA؂ւf[^ɖOŒT
+    std::vector<const std::string*> ik_names(ik_num);
+    for (uint32_t i = 0; i < ik_num; ++i) {
+        ik_names[i] = &pmd.GetBoneName(iks[i].BoneIdx);
     }
 
-    return motion_ptr;
+    const auto& switches = table.GetIKSwitchList();
+    m_FrameNos.clear();
+    m_Bits.clear();
+    m_FrameNos.reserve(switches.size());
+    m_Bits.reserve(switches.size() * m_WordNum);
+    for (const auto& ik_enable : switches) {
+        const size_t begin = m_Bits.size();
+        m_Bits.resize(begin + m_WordNum, ~Word(0));
+        for (uint32_t i = 0; i < ik_num; ++i) {
+            auto itr = ik_enable.IkEnableTable.find(*ik_names[i]);
+            if (itr != ik_enable.IkEnableTable.end() && !itr->second) {
+                m_Bits[begin + i / k_WordBits] &= ~(Word(1) << (i % k_WordBits));
+            }
+        }
+
+        // t[̐؂ւf[^͌̂̂g
+        if (!m_FrameNos.empty() && m_FrameNos.back() == ik_enable.FrameNo) {
+            std::copy_n(m_Bits.begin() + begin, m_WordNum, m_Bits.begin() + (begin - m_WordNum));
+            m_Bits.resize(begin);
+            continue;
+        }
+        m_FrameNos.push_back(ik_enable.FrameNo);
+    }
+
+    Reset();
 }
 
-VMDMotionTable::VMDIKEnableResult VMDMotionTable::GetIKEnable(uint32_t frame_no) const
+const IKEnableTimeline::Word* IKEnableTimeline::Enabled(uint32_t frame_no)
 {
-    auto itr = std::find_if(
-        m_IKSwitchList.rbegin(),
-        m_IKSwitchList.rend(),
-        [frame_no](const VMDIKEnable& ike) {
-            return ike.FrameNo <= frame_no;
+    const uint32_t key_num = static_cast<uint32_t>(m_FrameNos.size());
+    if (frame_no < m_LastFrameNo) {
+        // ߂Ƃ񕪒T
+        auto next = std::upper_bound(m_FrameNos.begin(), m_FrameNos.end(), frame_no);
+        m_Cursor = next == m_FrameNos.begin() ? k_NoKey : static_cast<uint32_t>(next - m_FrameNos.begin() - 1);
+    }
+    else {
+        // ؂ւf[^͂܂΂Ȃ̂ŁAɐi߂邾ł悢
+        uint32_t next = m_Cursor == k_NoKey ? 0 : m_Cursor + 1;
+        while (next < key_num && m_FrameNos[next] <= frame_no) {
+            m_Cursor = next++;
         }
-    );
+    }
+    m_LastFrameNo = frame_no;
 
-    return itr == m_IKSwitchList.rend() ? std::nullopt : VMDIKEnableResult(*itr);
+    return m_Cursor == k_NoKey ? m_AllEnabled.data() : m_Bits.data() + static_cast<size_t>(m_Cursor) * m_WordNum;
 }
 
-uint32_t VMDMotionTable::MaxKeyFrameNo() const
+void IKEnableTimeline::Reset()
 {
-    return m_MaxKeyFrameNo;
-}
\ No newline at end of file
+    m_Cursor = k_NoKey;
+    m_LastFrameNo = 0;
+}
@@ -6,9 +6,16 @@
 #include <unordered_map>
 #include <filesystem>
 #include <optional>
+#include <memory>
 
 #include <DirectXMath.h>
 
+#include "BezierEasing.hpp"
+
+class PMDData;
+class CompressedMotion;
+struct MotionCompressionSettings;
+
 struct VMDMotion
 {
 public:
@@ -20,6 +27,10 @@ public:
     uint8_t  Bezier[64];            // [4][4][4] xWFԃp[^
 };
 
+// t@C VMDMotion ͋l߂ĕł̂ŁA\̂̃TCYƂ͈vȂ
+static constexpr uint32_t k_VMDHeaderSize = 50;             // t@C擪̃wb_[i[V̎O܂Łj
+static constexpr uint32_t k_VMDMotionRecordSize = 111;      // t@C̃{[[V1̃oCg
+
 struct MotionKeyFrame
 {
 public:
@@ -28,15 +39,13 @@ public:
     DirectX::XMFLOAT4 Quaternion;   // NH[^jI
 
     DirectX::XMFLOAT3 Offset;               // IK̏W̃ItZbg
-    DirectX::XMFLOAT2 RotateBezierP1;       // ]ԃxWF_p1
-    DirectX::XMFLOAT2 RotateBezierP2;       // ]ԃxWF_p2
+    uint32_t Curves[BezierEasingTable::k_ChannelNum];   // ÕL[t[炱̃L[t[܂ł̕ԋȐiX, Y, Z, ]j
 
     MotionKeyFrame(
         uint32_t frame_no, 
         const DirectX::XMFLOAT4& q,
         const DirectX::XMFLOAT3& offset,
-        const DirectX::XMFLOAT2& p1, 
-        const DirectX::XMFLOAT2& p2
+        const uint32_t* curves
     );
 };
 
@@ -50,6 +59,13 @@ struct VMDMorph
 };
 #pragma pack()
 
+// \̃L[t[
+struct MorphKeyFrame
+{
+    uint32_t FrameNo;   // t[ԍ
+    float Weight;       // EFCg
+};
+
 #pragma pack(1)
 // J
 struct VMDCamera
@@ -98,37 +114,61 @@ public:
     {
     public:
 
-        double GetYFromXOnBezier(double x, const DirectX::XMFLOAT2& p1, const DirectX::XMFLOAT2& p2, uint8_t count) const;
-        void Slerp(uint32_t frame_no, DirectX::XMMATRIX* rotate_mat_out, DirectX::XMVECTOR* offset_out) const;
+        // @brief Begin  End ̊ԂԂ
+        // @param frame    t[ʒuiԂɎgj
+        // @param easing   L[t[̕ԋȐo^e[u
+        void Slerp(float frame, const BezierEasingTable& easing, DirectX::XMMATRIX* rotate_mat_out, DirectX::XMVECTOR* offset_out) const;
+
+        // @brief Begin  End ̊ԂԂ]iNH[^jIjƈʒu߂
+        void Interpolate(float frame, const BezierEasingTable& easing, DirectX::XMVECTOR* rotation_out, DirectX::XMVECTOR* offset_out) const;
 
-        std::string    Name;
-        MotionKeyFrame Begin;
-        MotionKeyFrame End;
+        uint32_t              BoneIdx;      // f̃{[ԍ
+        const MotionKeyFrame* Begin;        // frame_no ȑOōŌ̃L[t[
+        const MotionKeyFrame* End;          // ̎̃L[t[i Begin Ɠj
     };
 
     typedef std::unordered_map <std::string, std::vector<MotionKeyFrame>> MotionTable;
-    typedef std::shared_ptr<std::vector<MotionInterpolater>> NowMotionListPtr;
-    typedef std::optional<VMDIKEnable> VMDIKEnableResult;
+    typedef std::unordered_map <std::string, std::vector<MorphKeyFrame>> MorphTable;
 
 public:
     VMDMotionTable();
 
-    bool Open(const std::filesystem::path& filename);
+    // @param load_bone_motion {[[VǂݍނiXg[~OĐł VMDMotionStream ǂނ̂ falsej
+    bool Open(const std::filesystem::path& filename, bool load_bone_motion = true);
+
+    // @brief {[[Vkik GetMotionTable ͋ɂȂj
+    // @param settings k̐ݒ
+    // @retval kłȂꍇ falseî܂܁j
+    bool Compress(const MotionCompressionSettings& settings);
+    bool IsCompressed() const;
+    const CompressedMotion* GetCompressedMotion() const;   // kĂȂ nullptr
 
     const MotionTable& GetMotionTable() const;
-    NowMotionListPtr  GetNowMotionList(uint32_t frame_no);
-    VMDIKEnableResult GetIKEnable(uint32_t frame_no) const;
+    const MorphTable& GetMorphTable() const;
+    const BezierEasingTable& GetEasing() const;
+    const VMDIKEnable* GetIKEnable(uint32_t frame_no) const;     // frame_no ȑOōŌIK؂ւf[^i nullptrj
+    const std::vector<VMDIKEnable>& GetIKSwitchList() const;     // IK؂ւf[^it[ԍBt[̓t@C̏j
+    const std::vector<VMDCamera>& GetCameraList() const;         // Jf[^it@C̏j
+    const std::vector<VMDLight>& GetLightList() const;           // Ɩf[^it@C̏j
+    const std::vector<VMDSelfShadow>& GetSelfShadowList() const; // ZtVhEf[^it@C̏j
     
     uint32_t MaxKeyFrameNo() const;
+
+    // @brief \̃EFCg߂iÕL[t[`ԁj
+    // @param keyframes t[ԍ̏ɕ񂾃L[t[
+    static float GetMorphWeight(const std::vector<MorphKeyFrame>& keyframes, float frame);
     
 private:
 
     uint32_t     m_MotionDataNum;       // [Vf[^
     MotionTable  m_MotionList;          // [VXg [{[, L[t[Xg]̘Azz
     uint32_t     m_MaxKeyFrameNo;       // őL[t[ԍ
+    BezierEasingTable m_Easing;         // L[t[̕ԋȐ
+    std::shared_ptr<const CompressedMotion> m_CompressedMotion;  // k{[[VikĂȂ΋j
 
     uint32_t     m_MorphDataNum;        // [tf[^
     std::vector<VMDMorph> m_MorphList;  // [tf[^
+    MorphTable   m_MorphTable;          // \e[u [\, L[t[Xg]̘Azz
 
     uint32_t     m_CameraDataNum;                     // Jf[^
     std::vector<VMDCamera> m_CameraList;              // Jf[^
@@ -141,4 +181,113 @@ private:
 
     uint32_t     m_IKSwitchNum;                       // IK؂ւf[^
     std::vector<VMDIKEnable>   m_IKSwitchList;        // IK؂ւf[^
-};
\ No newline at end of file
+};
+
+// {[[ṼL[t[gbNi{[j̃J[\ňNX
+//
+// ǂݍݎ1񂾂[Ṽ{[f̃{[ԍɑΉtA
+// ȍ~̓{[ԍŕ񂾃gbNgit[Azz͎gȂjB
+// Õt[i񂾏ꍇ̓J[\琔܂ŏɒׂ邾ōς݁A
+// ߂ꍇi[v̐擪ɖ߂EV[Nj傫񂾏ꍇ͓񕪒TB
+// ʂ͌Ăяopӂ̈ɏނ̂ŁAt[̃mۂ͖B
+// [VkĂꍇ́AJ[\gbÑL[t[gbN̗̈ɓWJB
+class VMDMotionSampler
+{
+public:
+
+    static constexpr uint32_t k_LinearSearchNum = 4;    // 񕪒Tɐ؂ւ܂łɏɒׂL[t[
+
+public:
+
+    VMDMotionSampler();
+
+    // @brief [ṼgbNf̃{[ԍɑΉt
+    // @param table     [VĩNX蒷邱Ɓj
+    // @param pmd       Ήt郂f
+    // @param unmatched fɖ{[isvȂ nullptrj
+    void Bind(const VMDMotionTable& table, const PMDData& pmd, std::vector<std::string>* unmatched = nullptr);
+
+    uint32_t TrackNum() const;                  // {[i{[ԍňj
+    uint32_t BoundTrackNum() const;             // L[t[̂gbN
+    bool HasTrack(uint32_t bone_idx) const;
+
+    // @brief wt[̑ÕL[t[߂
+    // @param frame_no t[ԍ
+    // @param out      ʁiBoundTrackNum ̗̈Bframe_no ȑOɃL[t[gbN͏܂Ȃj
+    // @retval 񂾐
+    uint32_t Sample(uint32_t frame_no, VMDMotionTable::MotionInterpolater* out);
+
+    // @brief J[\擪ɖ߂
+    void Reset();
+
+private:
+
+    static constexpr uint32_t k_NoKey = 0xFFFFFFFF;
+
+    struct Track
+    {
+        const std::vector<MotionKeyFrame>* KeyFrames;  // L[t[ikE[V{[ nullptrj
+        const uint32_t*                    FrameNos;   // k̃t[ԍ
+        uint32_t                           KeyNum;     // L[t[i[V{[ 0j
+        uint32_t                           CompressedTrack;  // k̃gbNԍ
+        uint32_t                           Cursor;     // frame_no ȑOōŌ̃L[t[i k_NoKeyj
+        uint32_t                           DecodedCursor;    // kɓWJς݂̃L[t[i k_NoKeyj
+    };
+
+    static uint32_t KeyFrameNo(const Track& track, uint32_t key_idx);
+    static uint32_t Seek(const Track& track, uint32_t frame_no);
+
+    const CompressedMotion* m_Compressed;       // k[VikĂȂ nullptrj
+    std::vector<MotionKeyFrame> m_Decoded;      // kɓWJL[t[i{[ Begin, End 2j
+    std::vector<Track>    m_Tracks;             // {[ԍ -> gbN
+    std::vector<uint32_t> m_BoundBones;         // L[t[̂{[ԍij
+    uint32_t              m_LastFrameNo;
+};
+
+// IK  ON/OFF AfIKԍ̃rbg̎nɂ
+//
+// IK؂ւf[^̓{[ ON/OFF ̂ŁAǂݍݎɃfIKԍɑΉt
+// ؂ւt[ɁuIKԍ i LȂrbg i vrbgɂĂB
+// t[̓J[\؂ւt[i߂邾ŁÃt[̃rbg񂪓B
+// ؂ւf[^ɖOIK͗LiMMD ƓAO̐؂ւf[^Ō܂jB
+class IKEnableTimeline
+{
+public:
+
+    using Word = uint64_t;
+    static constexpr uint32_t k_WordBits = 64;
+
+    // @brief rbg IKԍ ik_idx L
+    static bool IsEnabled(const Word* bits, uint32_t ik_idx)
+    {
+        return (bits[ik_idx / k_WordBits] >> (ik_idx % k_WordBits)) & 1;
+    }
+
+public:
+
+    IKEnableTimeline();
+
+    // @brief IK؂ւf[^fIKԍɑΉt
+    // @param table [V
+    // @param pmd   Ήt郂f
+    void Bind(const VMDMotionTable& table, const PMDData& pmd);
+
+    // @brief wt[ŗLIK̃rbg
+    // @param frame_no t[ԍ
+    // @retval rbgiIKԍ i ̓[h i / 64 ̃rbg i % 64j
+    const Word* Enabled(uint32_t frame_no);
+
+    // @brief J[\擪ɖ߂
+    void Reset();
+
+private:
+
+    static constexpr uint32_t k_NoKey = 0xFFFFFFFF;
+
+    uint32_t          m_WordNum;            // 1̃rbg̃[h
+    std::vector<Word> m_AllEnabled;         // ؂ւf[^Õt[piSIKLj
+    std::vector<uint32_t> m_FrameNos;       // ؂ւt[ԍij
+    std::vector<Word> m_Bits;               // ؂ւt[̃rbgim_WordNum [hj
+    uint32_t          m_Cursor;             // frame_no ȑOōŌ̐؂ւf[^i k_NoKeyj
+    uint32_t          m_LastFrameNo;
+};
@@ -0,0 +1,566 @@
+#include "VMDStream.hpp"
+#include "PMD.hpp"
+#include "FilePath.hpp"
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    constexpr uint32_t k_TrackNameSize = 16;
+    constexpr uint32_t k_NoRecord = 0xFFFFFFFF;
+
+    // t@C̃{[[V1ǂ
+    void ReadMotionRecord(const uint8_t* record, VMDMotion* out)
+    {
+        std::memcpy(out->BoneName, record, sizeof(out->BoneName));
+        record += sizeof(out->BoneName);
+        std::memcpy(&out->FrameNo, record, sizeof(out->FrameNo));
+        record += sizeof(out->FrameNo);
+        std::memcpy(&out->Location, record, sizeof(out->Location));
+        record += sizeof(out->Location);
+        std::memcpy(&out->Quaternion, record, sizeof(out->Quaternion));
+        record += sizeof(out->Quaternion);
+        std::memcpy(out->Bezier, record, sizeof(out->Bezier));
+    }
+
+    // O15byte傤ǂ̏ꍇI[
+    std::string MotionBoneName(const VMDMotion& motion)
+    {
+        return std::string(motion.BoneName, strnlen(motion.BoneName, sizeof(motion.BoneName)));
+    }
+
+    // gbNE`ÑL[t[͈̔́iבւɃ`N̑ÕL[t[T̂Ɏgj
+    struct TrackChunkStat
+    {
+        uint32_t KeyNum;
+        uint32_t MinFrame;
+        uint32_t MinRecord;
+        uint32_t MaxFrame;
+        uint32_t MaxRecord;
+    };
+}
+
+VMDMotionStream::VMDMotionStream()
+    :
+    m_StreamPath(),
+    m_Pool(nullptr),
+    m_TrackNum(0),
+    m_MaxFrameNo(0),
+    m_TrackNames(),
+    m_Chunks(),
+    m_Easing(),
+    m_TrackBones(),
+    m_BoundTracks(),
+    m_Window(),
+    m_Current(),
+    m_CurrentIdx(0)
+{}
+
+std::filesystem::path VMDMotionStream::StreamPath(const std::filesystem::path& vmd_path)
+{
+    std::filesystem::path stream_path = vmd_path;
+    stream_path.replace_extension(L".vmds");
+    return stream_path;
+}
+
+bool VMDMotionStream::Open(const std::filesystem::path& vmd_path, ThreadPool* pool)
+{
+    const std::filesystem::path stream_path = StreamPath(vmd_path);
+    if (!ReadStreamFile(stream_path, vmd_path)) {
+        if (!BuildStreamFile(vmd_path, stream_path) || !ReadStreamFile(stream_path, vmd_path)) {
+            return false;
+        }
+    }
+
+    m_StreamPath = stream_path;
+    m_Pool = pool;
+    m_Window.clear();
+    m_Current.reset();
+
+    return true;
+}
+
+bool VMDMotionStream::IsOpen() const
+{
+    return !m_Chunks.empty();
+}
+
+bool VMDMotionStream::ReadStreamFile(const std::filesystem::path& stream_path, const std::filesystem::path& vmd_path)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(stream_path, ec) || ec) {
+        return false;
+    }
+    const uint64_t file_size = std::filesystem::file_size(stream_path, ec);
+    if (ec) {
+        return false;
+    }
+
+    std::ifstream ifs(stream_path, std::ios::in | std::ios::binary);
+    if (!ifs) {
+        return false;
+    }
+
+    VMDStreamHeader header{};
+    if (!ifs.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.Magic, k_Magic, sizeof(k_Magic)) != 0 || header.Version != k_Version) {
+        return false;
+    }
+    if (header.ChunkFrameNum != k_ChunkFrameNum || header.ChunkNum == 0 || header.CurveNum == 0) {
+        return false;
+    }
+
+    uint64_t size = 0;
+    int64_t write_time = 0;
+    if (!GetFileStamp(vmd_path, &size, &write_time) || size != header.SourceSize || write_time != header.SourceWriteTime) {
+        return false;
+    }
+
+    // gbN
+    std::vector<char> names(static_cast<size_t>(header.TrackNum) * k_TrackNameSize);
+    ifs.seekg(static_cast<std::streamoff>(header.TrackNameOffset), std::ios::beg);
+    if (!ifs.read(names.data(), names.size())) {
+        return false;
+    }
+
+    // ԋȐ͋Ȑԍɕł̂ŁAɓo^ΓԍɂȂ
+    std::vector<std::array<uint8_t, 4>> curves(header.CurveNum);
+    ifs.seekg(static_cast<std::streamoff>(header.CurveOffset), std::ios::beg);
+    if (!ifs.read(reinterpret_cast<char*>(curves.data()), curves.size() * sizeof(curves[0]))) {
+        return false;
+    }
+    BezierEasingTable easing;
+    for (uint32_t i = 0; i < header.CurveNum; ++i) {
+        if (easing.Register(curves[i][0], curves[i][1], curves[i][2], curves[i][3]) != i) {
+            return false;
+        }
+    }
+
+    std::vector<VMDStreamChunk> chunks(header.ChunkNum);
+    ifs.seekg(static_cast<std::streamoff>(header.ChunkTableOffset), std::ios::beg);
+    if (!ifs.read(reinterpret_cast<char*>(chunks.data()), chunks.size() * sizeof(VMDStreamChunk))) {
+        return false;
+    }
+    for (const auto& chunk : chunks) {
+        const uint64_t chunk_size = static_cast<uint64_t>(chunk.KeyNum) * sizeof(VMDStreamKey);
+        if (chunk.Offset > file_size || chunk_size > file_size - chunk.Offset) {
+            return false;
+        }
+    }
+
+    m_TrackNum = header.TrackNum;
+    m_MaxFrameNo = header.MaxFrameNo;
+    m_TrackNames.resize(header.TrackNum);
+    for (uint32_t i = 0; i < header.TrackNum; ++i) {
+        const char* name = names.data() + static_cast<size_t>(i) * k_TrackNameSize;
+        m_TrackNames[i].assign(name, strnlen(name, k_TrackNameSize));
+    }
+    m_Easing = std::move(easing);
+    m_Chunks = std::move(chunks);
+
+    return true;
+}
+
+bool VMDMotionStream::BuildStreamFile(const std::filesystem::path& vmd_path, const std::filesystem::path& stream_path)
+{
+    // VMD̓}bvēǂނȂ̂ŁAבւɂ郁̓gbN x `Nxōς
+    MappedFile vmd;
+    if (!vmd.Open(vmd_path)) {
+        return false;
+    }
+    MappedFileReader reader(vmd.Data(), vmd.Size());
+    uint32_t motion_num = 0;
+    if (!reader.Skip(k_VMDHeaderSize) || !reader.Read(&motion_num)) {
+        return false;
+    }
+    const uint8_t* records = reader.Bytes(static_cast<uint64_t>(motion_num) * k_VMDMotionRecordSize);
+    if (!records || motion_num == 0) {
+        return false;
+    }
+    auto read_record = [records](uint32_t idx, VMDMotion* out) {
+        ReadMotionRecord(records + static_cast<size_t>(idx) * k_VMDMotionRecordSize, out);
+    };
+
+    // 1: gbNEԋȐEőt[ԍW߂
+    std::unordered_map<std::string, uint16_t> track_index;
+    std::vector<std::string> track_names;
+    BezierEasingTable easing;
+    std::vector<std::array<uint8_t, 4>> curves = { { 20, 20, 107, 107 } };     // Ȑԍ 0 ͒
+    uint32_t max_frame_no = 0;
+    VMDMotion motion;
+    for (uint32_t i = 0; i < motion_num; ++i) {
+        read_record(i, &motion);
+        std::string name = MotionBoneName(motion);
+        if (track_index.find(name) == track_index.end()) {
+            if (track_names.size() >= 0xFFFF) {
+                return false;
+            }
+            track_index.emplace(name, static_cast<uint16_t>(track_names.size()));
+            track_names.push_back(name);
+        }
+        for (uint32_t c = 0; c < BezierEasingTable::k_ChannelNum; ++c) {
+            const uint8_t* p = motion.Bezier;
+            const uint32_t curve = easing.Register(p[c], p[4 + c], p[8 + c], p[12 + c]);
+            if (curve == curves.size()) {
+                curves.push_back({ p[c], p[4 + c], p[8 + c], p[12 + c] });
+            }
+        }
+        max_frame_no = std::max(max_frame_no, motion.FrameNo);
+    }
+    if (curves.size() > 0xFFFF) {
+        return false;
+    }
+
+    const uint32_t track_num = static_cast<uint32_t>(track_names.size());
+    const uint32_t chunk_num = max_frame_no / k_ChunkFrameNum + 1;
+
+    // 2: gbNE`ÑL[t[ƍŏEŌ̃L[t[𒲂ׂ
+    std::vector<TrackChunkStat> stats(static_cast<size_t>(track_num) * chunk_num, TrackChunkStat{ 0, 0, k_NoRecord, 0, k_NoRecord });
+    for (uint32_t i = 0; i < motion_num; ++i) {
+        read_record(i, &motion);
+        const uint32_t track = track_index[MotionBoneName(motion)];
+        TrackChunkStat& stat = stats[static_cast<size_t>(track) * chunk_num + motion.FrameNo / k_ChunkFrameNum];
+        if (stat.KeyNum == 0 || motion.FrameNo < stat.MinFrame) {
+            stat.MinFrame = motion.FrameNo;
+            stat.MinRecord = i;
+        }
+        // t[̃L[t[ꍇ͌̂̂g
+        if (stat.KeyNum == 0 || motion.FrameNo >= stat.MaxFrame) {
+            stat.MaxFrame = motion.FrameNo;
+            stat.MaxRecord = i;
+        }
+        ++stat.KeyNum;
+    }
+
+    // `N̑ÕL[t[iR[hԍj߂
+    std::vector<uint32_t> prologues(stats.size(), k_NoRecord);
+    std::vector<uint32_t> epilogues(stats.size(), k_NoRecord);
+    for (uint32_t t = 0; t < track_num; ++t) {
+        const size_t base = static_cast<size_t>(t) * chunk_num;
+        uint32_t last = k_NoRecord;
+        for (uint32_t c = 0; c < chunk_num; ++c) {
+            prologues[base + c] = last;
+            if (stats[base + c].KeyNum > 0) {
+                last = stats[base + c].MaxRecord;
+            }
+        }
+        uint32_t first = k_NoRecord;
+        for (uint32_t c = chunk_num; c > 0; --c) {
+            epilogues[base + c - 1] = first;
+            if (stats[base + c - 1].KeyNum > 0) {
+                first = stats[base + c - 1].MinRecord;
+            }
+        }
+    }
+
+    // t@C̔zu߂
+    VMDStreamHeader header{};
+    std::memcpy(header.Magic, k_Magic, sizeof(k_Magic));
+    header.Version = k_Version;
+    if (!GetFileStamp(vmd_path, &header.SourceSize, &header.SourceWriteTime)) {
+        return false;
+    }
+    header.ChunkFrameNum = k_ChunkFrameNum;
+    header.ChunkNum = chunk_num;
+    header.TrackNum = track_num;
+    header.CurveNum = static_cast<uint32_t>(curves.size());
+    header.MaxFrameNo = max_frame_no;
+    header.TrackNameOffset = sizeof(VMDStreamHeader);
+    header.CurveOffset = header.TrackNameOffset + static_cast<uint64_t>(track_num) * k_TrackNameSize;
+    header.ChunkTableOffset = header.CurveOffset + curves.size() * sizeof(curves[0]);
+
+    std::vector<VMDStreamChunk> chunks(chunk_num, VMDStreamChunk{ 0, 0, 0 });
+    uint64_t offset = header.ChunkTableOffset + static_cast<uint64_t>(chunk_num) * sizeof(VMDStreamChunk);
+    for (uint32_t c = 0; c < chunk_num; ++c) {
+        uint32_t key_num = 0;
+        for (uint32_t t = 0; t < track_num; ++t) {
+            const size_t idx = static_cast<size_t>(t) * chunk_num + c;
+            key_num += stats[idx].KeyNum;
+            key_num += prologues[idx] != k_NoRecord ? 1 : 0;
+            key_num += epilogues[idx] != k_NoRecord ? 1 : 0;
+        }
+        chunks[c].Offset = offset;
+        chunks[c].KeyNum = key_num;
+        offset += static_cast<uint64_t>(key_num) * sizeof(VMDStreamKey);
+    }
+
+    std::vector<char> names(static_cast<size_t>(track_num) * k_TrackNameSize, 0);
+    for (uint32_t t = 0; t < track_num; ++t) {
+        std::memcpy(names.data() + static_cast<size_t>(t) * k_TrackNameSize, track_names[t].data(), track_names[t].size());
+    }
+
+    // ݓr̃t@Cǂ܂Ȃ悤Aꎞt@CɏĂu
+    std::filesystem::path tmp_path = stream_path;
+    tmp_path += L"." + std::to_wstring(std::hash<std::thread::id>()(std::this_thread::get_id())) + L".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(names.data(), names.size());
+        ofs.write(reinterpret_cast<const char*>(curves.data()), curves.size() * sizeof(curves[0]));
+        ofs.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(VMDStreamChunk));
+
+        // 3: L[t[`N̗̈ɏށi`Nɏ߂Ă܂Ƃ߂ďj
+        std::vector<std::vector<VMDStreamKey>> buffers(chunk_num);
+        std::vector<uint32_t> written(chunk_num, 0);
+        auto flush = [&](uint32_t c) {
+            auto& buffer = buffers[c];
+            if (buffer.empty()) {
+                return;
+            }
+            ofs.seekp(static_cast<std::streamoff>(chunks[c].Offset + static_cast<uint64_t>(written[c]) * sizeof(VMDStreamKey)), std::ios::beg);
+            ofs.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(VMDStreamKey));
+            written[c] += static_cast<uint32_t>(buffer.size());
+            buffer.clear();
+        };
+        auto push = [&](uint32_t c, uint32_t record_idx) {
+            read_record(record_idx, &motion);
+            VMDStreamKey key{};
+            key.Track = track_index[MotionBoneName(motion)];
+            for (uint32_t ch = 0; ch < BezierEasingTable::k_ChannelNum; ++ch) {
+                const uint8_t* p = motion.Bezier;
+                key.Curves[ch] = static_cast<uint16_t>(easing.Register(p[ch], p[4 + ch], p[8 + ch], p[12 + ch]));
+            }
+            key.FrameNo = motion.FrameNo;
+            key.Offset = motion.Location;
+            key.Quaternion = motion.Quaternion;
+            buffers[c].push_back(key);
+            if (buffers[c].size() >= k_WriteBufferKeyNum) {
+                flush(c);
+            }
+        };
+
+        for (uint32_t i = 0; i < motion_num; ++i) {
+            std::memcpy(&motion.FrameNo, records + static_cast<size_t>(i) * k_VMDMotionRecordSize + sizeof(motion.BoneName), sizeof(motion.FrameNo));
+            push(motion.FrameNo / k_ChunkFrameNum, i);
+        }
+        for (uint32_t t = 0; t < track_num; ++t) {
+            for (uint32_t c = 0; c < chunk_num; ++c) {
+                const size_t idx = static_cast<size_t>(t) * chunk_num + c;
+                if (prologues[idx] != k_NoRecord) {
+                    push(c, prologues[idx]);
+                }
+                if (epilogues[idx] != k_NoRecord) {
+                    push(c, epilogues[idx]);
+                }
+            }
+        }
+        for (uint32_t c = 0; c < chunk_num; ++c) {
+            flush(c);
+        }
+        if (!ofs) {
+            return false;
+        }
+    }
+
+    // 4: `NɃgbNEt[ɕבւit[͌̏Ԃ̂܂܁j
+    {
+        std::fstream fs(tmp_path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!fs) {
+            return false;
+        }
+        std::vector<VMDStreamKey> keys;
+        for (const auto& chunk : chunks) {
+            keys.resize(chunk.KeyNum);
+            fs.seekg(static_cast<std::streamoff>(chunk.Offset), std::ios::beg);
+            fs.read(reinterpret_cast<char*>(keys.data()), keys.size() * sizeof(VMDStreamKey));
+            std::stable_sort(keys.begin(), keys.end(), [](const VMDStreamKey& a, const VMDStreamKey& b) {
+                return a.Track != b.Track ? a.Track < b.Track : a.FrameNo < b.FrameNo;
+            });
+            fs.seekp(static_cast<std::streamoff>(chunk.Offset), std::ios::beg);
+            fs.write(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(VMDStreamKey));
+        }
+        if (!fs) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, stream_path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+VMDMotionStream::ChunkPtr VMDMotionStream::LoadChunk(const std::filesystem::path& stream_path, VMDStreamChunk chunk, uint32_t track_num)
+{
+    auto result = std::make_shared<Chunk>();
+    result->TrackBegin.assign(track_num + 1, 0);
+
+    std::vector<VMDStreamKey> keys(chunk.KeyNum);
+    std::ifstream ifs(stream_path, std::ios::in | std::ios::binary);
+    ifs.seekg(static_cast<std::streamoff>(chunk.Offset), std::ios::beg);
+    if (!ifs || !ifs.read(reinterpret_cast<char*>(keys.data()), keys.size() * sizeof(VMDStreamKey))) {
+        return result;
+    }
+
+    // L[t[̓gbNɕł̂ŁAgbN̐擪ʒu͐邾ŋ܂
+    result->Keys.reserve(keys.size());
+    for (const auto& key : keys) {
+        if (key.Track >= track_num) {
+            result->Keys.clear();
+            std::fill(result->TrackBegin.begin(), result->TrackBegin.end(), 0);
+            return result;
+        }
+        const uint32_t curves[BezierEasingTable::k_ChannelNum] = { key.Curves[0], key.Curves[1], key.Curves[2], key.Curves[3] };
+        result->Keys.emplace_back(key.FrameNo, key.Quaternion, key.Offset, curves);
+        ++result->TrackBegin[key.Track + 1];
+    }
+    for (uint32_t t = 0; t < track_num; ++t) {
+        result->TrackBegin[t + 1] += result->TrackBegin[t];
+    }
+
+    return result;
+}
+
+void VMDMotionStream::Bind(const PMDData& pmd, std::vector<std::string>* unmatched)
+{
+    m_TrackBones.assign(m_TrackNum, BoneTree::k_InvalidBoneIdx);
+    m_BoundTracks.clear();
+    if (unmatched) {
+        unmatched->clear();
+    }
+
+    for (uint32_t t = 0; t < m_TrackNum; ++t) {
+        const uint16_t bone_idx = pmd.FindBoneIndex(m_TrackNames[t]);
+        if (bone_idx == BoneTree::k_InvalidBoneIdx) {
+            if (unmatched) {
+                unmatched->push_back(m_TrackNames[t]);
+            }
+            continue;
+        }
+        m_TrackBones[t] = bone_idx;
+        m_BoundTracks.push_back(t);
+    }
+
+    std::sort(m_BoundTracks.begin(), m_BoundTracks.end(), [this](uint32_t a, uint32_t b) {
+        return m_TrackBones[a] < m_TrackBones[b];
+    });
+    if (unmatched) {
+        std::sort(unmatched->begin(), unmatched->end());
+    }
+}
+
+uint32_t VMDMotionStream::BoundTrackNum() const
+{
+    return static_cast<uint32_t>(m_BoundTracks.size());
+}
+
+uint32_t VMDMotionStream::Sample(uint32_t frame_no, VMDMotionTable::MotionInterpolater* out)
+{
+    if (!IsOpen()) {
+        return 0;
+    }
+
+    const uint32_t chunk_idx = std::min(frame_no / k_ChunkFrameNum, static_cast<uint32_t>(m_Chunks.size()) - 1);
+    if (!m_Current || chunk_idx != m_CurrentIdx) {
+        UpdateWindow(chunk_idx);
+        m_Current = AcquireChunk(chunk_idx);
+        m_CurrentIdx = chunk_idx;
+    }
+    if (!m_Current) {
+        return 0;
+    }
+
+    // `ÑgbÑL[t[͐SxȂ̂ŁA񕪒T
+    const Chunk& chunk = *m_Current;
+    uint32_t out_num = 0;
+    for (uint32_t track : m_BoundTracks) {
+        const auto begin = chunk.Keys.begin() + chunk.TrackBegin[track];
+        const auto end = chunk.Keys.begin() + chunk.TrackBegin[track + 1];
+        const auto next = std::upper_bound(begin, end, frame_no, [](uint32_t frame, const MotionKeyFrame& key) {
+            return frame < key.FrameNo;
+        });
+        if (next == begin) {
+            continue;
+        }
+
+        VMDMotionTable::MotionInterpolater& result = out[out_num++];
+        result.BoneIdx = m_TrackBones[track];
+        result.Begin = &*(next - 1);
+        result.End = next != end ? &*next : result.Begin;
+    }
+
+    return out_num;
+}
+
+VMDMotionStream::ChunkPtr VMDMotionStream::AcquireChunk(uint32_t chunk_idx)
+{
+    auto itr = std::find_if(m_Window.begin(), m_Window.end(), [chunk_idx](const Slot& slot) {
+        return slot.ChunkIdx == chunk_idx;
+    });
+    if (itr == m_Window.end()) {
+        m_Window.push_back(Slot{ chunk_idx, std::future<ChunkPtr>(), LoadChunk(m_StreamPath, m_Chunks[chunk_idx], m_TrackNum) });
+        return m_Window.back().Loaded;
+    }
+
+    // ǂ݂ԂɍĂȂ΁AœǂݍݏÎ҂
+    if (itr->Loading.valid()) {
+        itr->Loaded = itr->Loading.get();
+    }
+    return itr->Loaded;
+}
+
+void VMDMotionStream::UpdateWindow(uint32_t chunk_idx)
+{
+    const uint32_t chunk_num = static_cast<uint32_t>(m_Chunks.size());
+    std::vector<uint32_t> wanted;
+    for (uint32_t i = 0; i <= k_PrefetchChunkNum && i < chunk_num; ++i) {
+        wanted.push_back((chunk_idx + i) % chunk_num);
+    }
+
+    // ͈͊OɂȂ`N͔jiǂݍݒ͓̂̂ǂݍݏI_ŉj
+    m_Window.erase(
+        std::remove_if(m_Window.begin(), m_Window.end(), [&wanted](const Slot& slot) {
+            return std::find(wanted.begin(), wanted.end(), slot.ChunkIdx) == wanted.end();
+        }),
+        m_Window.end()
+    );
+
+    if (!m_Pool) {
+        return;
+    }
+    for (uint32_t idx : wanted) {
+        auto itr = std::find_if(m_Window.begin(), m_Window.end(), [idx](const Slot& slot) {
+            return slot.ChunkIdx == idx;
+        });
+        if (itr != m_Window.end()) {
+            continue;
+        }
+        // ǂݍ݃^XN͂̃NXQƂȂ̂ŁArŔjĂ薳
+        auto loading = m_Pool->Submit([path = m_StreamPath, chunk = m_Chunks[idx], track_num = m_TrackNum]() {
+            return LoadChunk(path, chunk, track_num);
+        });
+        m_Window.push_back(Slot{ idx, std::move(loading), nullptr });
+    }
+}
+
+const BezierEasingTable& VMDMotionStream::GetEasing() const
+{
+    return m_Easing;
+}
+
+uint32_t VMDMotionStream::MaxKeyFrameNo() const
+{
+    return m_MaxFrameNo;
+}
+
+uint32_t VMDMotionStream::ResidentChunkNum() const
+{
+    return static_cast<uint32_t>(m_Window.size());
+}
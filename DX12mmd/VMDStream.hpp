@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <filesystem>
+#include <DirectXMath.h>
+
+#include "VMD.hpp"
+
+class ThreadPool;
+
+// .vmds t@CiVMD̃{[[Vt[͈͖̃`Nɕבւ́j̃tH[}bg
+//
+// [VMDStreamHeader][gbN][ԋȐ][`N\][`ÑL[t[]
+// `ÑL[t[̓gbNEt[ɕłB
+// e`Nɂ́AgbNɃ`NO̍Ō̃L[t[ƌ̍ŏ̃L[t[Ă̂ŁA
+// 1`Nł̃t[͈͂ԂłB
+struct VMDStreamHeader
+{
+    char     Magic[4];                  // "VMDS"
+    uint32_t Version;                   // tH[}bgo[W
+    uint64_t SourceSize;                // VMDt@C̃TCY
+    int64_t  SourceWriteTime;           // VMDt@C̍XV
+    uint32_t ChunkFrameNum;             // 1`Ñt[
+    uint32_t ChunkNum;                  // `N
+    uint32_t TrackNum;                  // gbNi{[j
+    uint32_t CurveNum;                  // ԋȐ
+    uint32_t MaxFrameNo;                // őL[t[ԍ
+    uint32_t Reserved;
+    uint64_t TrackNameOffset;           // gbNichar[16] * TrackNumj
+    uint64_t CurveOffset;               // ԋȐ̐_ix1, y1, x2, y2  uint8_t[4] * CurveNumBȐԍj
+    uint64_t ChunkTableOffset;          // VMDStreamChunk * ChunkNum
+};
+
+struct VMDStreamChunk
+{
+    uint64_t Offset;                    // t@C擪̃ItZbg
+    uint32_t KeyNum;                    // L[t[iÕ`N玝Ă̂܂ށj
+    uint32_t Reserved;
+};
+
+struct VMDStreamKey
+{
+    uint16_t Track;                     // gbNԍ
+    uint16_t Curves[BezierEasingTable::k_ChannelNum];  // ԋȐԍiX, Y, Z, ]j
+    uint16_t Reserved;
+    uint32_t FrameNo;
+    DirectX::XMFLOAT3 Offset;
+    DirectX::XMFLOAT4 Quaternion;
+};
+
+// [Ṽ{[[VAĐʒu̎̃`NǂݍōĐNX
+//
+//  VMD 1Ȃ߂ă`Nɕבւ .vmds iȍ~͌t@Cς܂Ŏg񂷁jA
+// Đ͍Đʒũ`NƁA̐ k_PrefetchChunkNum ̃`NB
+// ̃`N̓Xbhv[Őǂ݂Aʂ߂`N͔ĵŁA
+// gp̓[V̒ɂ炸قڈɂȂB
+// [vĐɔāAŌ̃`N̐͐擪̃`Nǂ݂B
+// \EJȂǂ͏̂ VMDMotionTable őSǂݍށi{[[V͓ǂ܂ȂjB
+class VMDMotionStream
+{
+public:
+
+    static constexpr char     k_Magic[4] = { 'V', 'M', 'D', 'S' };
+    static constexpr uint32_t k_Version = 1;
+    static constexpr uint32_t k_ChunkFrameNum = 300;        // 1`Ñt[i30fps 10bj
+    static constexpr uint32_t k_PrefetchChunkNum = 2;       // Đʒuɓǂł`N
+    static constexpr uint32_t k_WriteBufferKeyNum = 256;    // בւɃ`Nɂ߂Ă珑ރL[t[
+
+public:
+
+    VMDMotionStream();
+    VMDMotionStream(const VMDMotionStream&) = delete;
+    VMDMotionStream& operator=(const VMDMotionStream&) = delete;
+
+    // @brief VMDt@CɑΉ .vmds t@C̃pXԂ
+    static std::filesystem::path StreamPath(const std::filesystem::path& vmd_path);
+
+    // @brief Xg[~OĐ̏i.vmds Â΍j
+    // @param vmd_path VMDt@CpX
+    // @param pool     ǂ݂ɎgXbhv[inullptr ȂKvɂȂƂɓǂݍށj
+    bool Open(const std::filesystem::path& vmd_path, ThreadPool* pool);
+    bool IsOpen() const;
+
+    // @brief gbNf̃{[ԍɑΉt
+    // @param pmd       Ήt郂f
+    // @param unmatched fɖ{[isvȂ nullptrj
+    void Bind(const PMDData& pmd, std::vector<std::string>* unmatched = nullptr);
+    uint32_t BoundTrackNum() const;
+
+    // @brief wt[̑ÕL[t[߂iKvȂ`Nǂݍ݁Aǂ݂o^j
+    // @param frame_no t[ԍ
+    // @param out      ʁiBoundTrackNum ̗̈B Sample ĂԂ܂ŗLj
+    // @retval 񂾐
+    uint32_t Sample(uint32_t frame_no, VMDMotionTable::MotionInterpolater* out);
+
+    const BezierEasingTable& GetEasing() const;
+    uint32_t MaxKeyFrameNo() const;
+    uint32_t ResidentChunkNum() const;      // ǂݍݍς݁Eǂݍݒ̃`N
+
+private:
+
+    // ǂݍ񂾃`N
+    struct Chunk
+    {
+        std::vector<MotionKeyFrame> Keys;       // gbNEt[
+        std::vector<uint32_t>       TrackBegin; // gbN Keys ̐擪iTrackNum + 1 j
+    };
+    using ChunkPtr = std::shared_ptr<const Chunk>;
+
+    struct Slot
+    {
+        uint32_t              ChunkIdx;
+        std::future<ChunkPtr> Loading;          // ǂݍݒiǂݍݍς݂Ȃ疳j
+        ChunkPtr              Loaded;
+    };
+
+    static bool BuildStreamFile(const std::filesystem::path& vmd_path, const std::filesystem::path& stream_path);
+    bool ReadStreamFile(const std::filesystem::path& stream_path, const std::filesystem::path& vmd_path);
+    static ChunkPtr LoadChunk(const std::filesystem::path& stream_path, VMDStreamChunk chunk, uint32_t track_num);
+
+    ChunkPtr AcquireChunk(uint32_t chunk_idx);
+    void UpdateWindow(uint32_t chunk_idx);
+
+    std::filesystem::path       m_StreamPath;
+    ThreadPool*                 m_Pool;
+    uint32_t                    m_TrackNum;
+    uint32_t                    m_MaxFrameNo;
+    std::vector<std::string>    m_TrackNames;
+    std::vector<VMDStreamChunk> m_Chunks;
+    BezierEasingTable           m_Easing;
+
+    std::vector<uint16_t>       m_TrackBones;       // gbÑ{[ԍiΉ{[ k_InvalidBoneIdxj
+    std::vector<uint32_t>       m_BoundTracks;      // {[ΉtgbNi{[ԍj
+
+    std::vector<Slot>           m_Window;           // ǂݍݍς݁Eǂݍݒ̃`N
+    ChunkPtr                    m_Current;          // Sample ̌ʂwĂ`N
+    uint32_t                    m_CurrentIdx;
+};
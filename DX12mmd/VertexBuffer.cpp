@@ -3,6 +3,7 @@
 #include "VertexBuffer.hpp"
 #include "AppManager.hpp"
 #include "PMD.hpp"
+#include "CompactVertex.hpp"
 
 namespace
 {
@@ -71,6 +72,61 @@ namespace
         },
 #endif
     };
+
+    // k_iPMDCompactVertexj
+    D3D12_INPUT_ELEMENT_DESC s_PMDCompactVertexLayout[] =
+    {
+        // W
+        {
+            "POSITION",
+            0,
+            DXGI_FORMAT_R32G32B32_FLOAT,
+            0,
+            D3D12_APPEND_ALIGNED_ELEMENT,
+            D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+            0
+        },
+        // @iʑ̃}bsOj
+        {
+            "NORMAL",
+            0,
+            DXGI_FORMAT_R16G16_SNORM,
+            0,
+            D3D12_APPEND_ALIGNED_ELEMENT,
+            D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+            0
+        },
+        // uviUV͈͂ŐKj
+        {
+            "TEXCOORD",
+            0,
+            DXGI_FORMAT_R16G16_UNORM,
+            0,
+            D3D12_APPEND_ALIGNED_ELEMENT,
+            D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+            0
+        },
+        // {[ԍ
+        {
+            "BONE_NO",
+            0,
+            DXGI_FORMAT_R8G8_UINT,
+            0,
+            D3D12_APPEND_ALIGNED_ELEMENT,
+            D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+            0
+        },
+        // d
+        {
+            "WEIGHT",
+            0,
+            DXGI_FORMAT_R8_UINT,
+            0,
+            D3D12_APPEND_ALIGNED_ELEMENT,
+            D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+            0
+        },
+    };
 }
 
 VertexBufferBase::VertexBufferBase()
@@ -119,6 +175,27 @@ bool VertexBufferBase::CreateVertexBuffer(const uint8_t* ptr, size_t size, size_
     return true;
 }
 
+bool VertexBufferBase::UpdateVertexBuffer(const uint8_t* ptr, size_t offset, size_t size)
+{
+    if (m_VertBuff == nullptr || offset + size > m_VbView.SizeInBytes) {
+        return false;
+    }
+
+    // CPU͓ǂ܂Ȃ̂œǂݍݔ͈͂͋Aݔ͈͕͂ύX`
+    D3D12_RANGE read_range = { 0, 0 };
+    uint8_t* vertmap = nullptr;
+    auto result = m_VertBuff->Map(0, &read_range, reinterpret_cast<void**>(&vertmap));
+    if (result != S_OK) {
+        return false;
+    }
+
+    std::copy_n(ptr, size, vertmap + offset);
+    D3D12_RANGE written_range = { offset, offset + size };
+    m_VertBuff->Unmap(0, &written_range);
+
+    return true;
+}
+
 D3D12_VERTEX_BUFFER_VIEW VertexBufferBase::GetVertexBufferView() const
 {
     return m_VbView;
@@ -127,32 +204,105 @@ D3D12_VERTEX_BUFFER_VIEW VertexBufferBase::GetVertexBufferView() const
 
 VertexBufferPMD::VertexBufferPMD()
     :
-    m_VertexNum(0)
+    m_VertexNum(0),
+    m_Format(Format::k_Full),
+    m_UVRange(0.0f, 0.0f, 1.0f, 1.0f),
+    m_CompactVertices(),
+    m_VertexData(nullptr),
+    m_StrideByte(0)
 {}
 
 VertexBufferPMD::~VertexBufferPMD()
 {}
 
-bool VertexBufferPMD::CreateVertexBuffer(const PMDData& pmd)
+bool VertexBufferPMD::CreateVertexBuffer(const PMDData& pmd, Format format)
 {
     m_VertexNum = pmd.VertexNum();
+
+    // kłȂi{[E덷傫jꍇ͌̃tH[}bgō
+    m_Format = Format::k_Full;
+    m_UVRange = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+    m_CompactVertices.clear();
+    if (format == Format::k_Compact && CompactVertexConverter::Convert(pmd, &m_CompactVertices, &m_UVRange)) {
+        m_Format = Format::k_Compact;
+    }
+    else {
+        m_CompactVertices.clear();
+        m_UVRange = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+    }
+
+    if (m_Format == Format::k_Compact) {
+        m_VertexData = m_CompactVertices.data();
+        m_StrideByte = sizeof(PMDCompactVertex);
+    }
+    else {
+        m_VertexData = pmd.GetVertexData();
+        m_StrideByte = pmd.VertexStrideByte();
+    }
+
     return VertexBufferBase::CreateVertexBuffer(
-        pmd.GetVertexData(),
-        pmd.VertexBuffSize(),
-        pmd.VertexStrideByte()
+        m_VertexData,
+        static_cast<size_t>(m_VertexNum) * m_StrideByte,
+        m_StrideByte
     );
 }
 
-const D3D12_INPUT_ELEMENT_DESC* VertexBufferPMD::GetVertexLayout() const
+const D3D12_INPUT_ELEMENT_DESC* VertexBufferPMD::FormatVertexLayout(Format format)
 {
+    if (format == Format::k_Compact) {
+        return &s_PMDCompactVertexLayout[0];
+    }
     return &s_PMDVertexLayout[0];
 }
 
-int VertexBufferPMD::VertexLayoutLength() const
+int VertexBufferPMD::FormatVertexLayoutLength(Format format)
 {
+    if (format == Format::k_Compact) {
+        return sizeof(s_PMDCompactVertexLayout) / sizeof(s_PMDCompactVertexLayout[0]);
+    }
     return sizeof(s_PMDVertexLayout) / sizeof(s_PMDVertexLayout[0]);
 }
 
+LPCSTR VertexBufferPMD::FormatVertexShaderEntry(Format format)
+{
+    return format == Format::k_Compact ? "CompactVS" : "BasicVS";
+}
+
+const D3D12_INPUT_ELEMENT_DESC* VertexBufferPMD::GetVertexLayout() const
+{
+    return FormatVertexLayout(m_Format);
+}
+
+int VertexBufferPMD::VertexLayoutLength() const
+{
+    return FormatVertexLayoutLength(m_Format);
+}
+
+VertexBufferPMD::Format VertexBufferPMD::GetFormat() const
+{
+    return m_Format;
+}
+
+LPCSTR VertexBufferPMD::VertexShaderEntry() const
+{
+    return FormatVertexShaderEntry(m_Format);
+}
+
+const XMFLOAT4& VertexBufferPMD::UVRange() const
+{
+    return m_UVRange;
+}
+
+const uint8_t* VertexBufferPMD::GetVertexData() const
+{
+    return m_VertexData;
+}
+
+uint32_t VertexBufferPMD::VertexStrideByte() const
+{
+    return m_StrideByte;
+}
+
 uint32_t VertexBufferPMD::VertexNum() const
 {
     return m_VertexNum;
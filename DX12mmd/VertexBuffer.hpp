@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <d3d12.h>
 #include <DirectXMath.h>
 
@@ -18,6 +19,7 @@ public:
     virtual ~IVertexBuffer() {}
     
     virtual bool CreateVertexBuffer(const uint8_t* ptr, size_t size, size_t stride_size) = 0;
+    virtual bool UpdateVertexBuffer(const uint8_t* ptr, size_t offset, size_t size) = 0;
     virtual D3D12_VERTEX_BUFFER_VIEW GetVertexBufferView() const = 0;
     virtual const D3D12_INPUT_ELEMENT_DESC* GetVertexLayout() const = 0;
     virtual int VertexLayoutLength() const = 0;
@@ -35,6 +37,11 @@ public:
     VertexBufferBase& operator=(VertexBufferBase&) = delete;
     
     virtual bool CreateVertexBuffer(const uint8_t* ptr, size_t size, size_t stride_size);
+    // @brief _obt@̈ꕔiGPUgpłȂƁj
+    // @param ptr    ރf[^
+    // @param offset ݐ̃oCgItZbg
+    // @param size   ރoCg
+    virtual bool UpdateVertexBuffer(const uint8_t* ptr, size_t offset, size_t size);
     virtual D3D12_VERTEX_BUFFER_VIEW GetVertexBufferView() const;
     virtual const D3D12_INPUT_ELEMENT_DESC* GetVertexLayout() const = 0;
     virtual int VertexLayoutLength() const = 0;
@@ -52,20 +59,46 @@ class VertexBufferPMD : public VertexBufferBase
 {
 public:
 
+    enum class Format
+    {
+        k_Full = 0,         // PMDVertexi40bytej
+        k_Compact,          // PMDCompactVertexi24bytej
+    };
+    static constexpr uint32_t k_FormatNum = 2;
+
+    // tH[}bg̓̓CAEgƒ_VF[_[̃Gg|CgipCvC̓tH[}bgɍj
+    static const D3D12_INPUT_ELEMENT_DESC* FormatVertexLayout(Format format);
+    static int FormatVertexLayoutLength(Format format);
+    static LPCSTR FormatVertexShaderEntry(Format format);
+
     VertexBufferPMD();
     virtual ~VertexBufferPMD();
     VertexBufferPMD(VertexBufferPMD&) = delete;
     VertexBufferPMD& operator=(VertexBufferPMD&) = delete;
 
-    bool CreateVertexBuffer(const PMDData& pmd);
+    // @brief _obt@쐬
+    // @param format _tH[}bgBk_Compact ɕϊłȂf k_Full ō쐬
+    bool CreateVertexBuffer(const PMDData& pmd, Format format = Format::k_Compact);
     virtual const D3D12_INPUT_ELEMENT_DESC* GetVertexLayout() const;
     virtual int VertexLayoutLength() const;
     
     virtual uint32_t VertexNum() const;
 
+    Format GetFormat() const;
+    LPCSTR VertexShaderEntry() const;           // tH[}bgɑΉ钸_VF[_[̃Gg|Cg
+    const XMFLOAT4& UVRange() const;            // UV̕pp[^ixy: ŏl, zw: j
+    const uint8_t* GetVertexData() const;       // GPUɓ]_f[^iCPǓf[^j
+    uint32_t VertexStrideByte() const;
+
 private:
 
     uint32_t m_VertexNum;
+    Format   m_Format;
+    XMFLOAT4 m_UVRange;
+    std::vector<uint8_t> m_CompactVertices;     // k_f[^
+    const uint8_t* m_VertexData;                // _f[^iPMDData ܂ m_CompactVertices wj
+    uint32_t m_StrideByte;
 };
 
-using VertexBufferPtr = std::shared_ptr<VertexBufferBase>;
\ No newline at end of file
+using VertexBufferPtr = std::shared_ptr<VertexBufferBase>;
+using VertexBufferPMDPtr = std::shared_ptr<VertexBufferPMD>;
\ No newline at end of file
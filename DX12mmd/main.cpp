@@ -1,5 +1,7 @@
 #include <Windows.h>
 #include <tchar.h>
+#include <cstdlib>
+#include <cstring>
 #include <DirectXMath.h>
 #include <DirectXTex.h>
 
@@ -33,6 +35,7 @@ using namespace std;
 // static functions
 //
 static LRESULT WindowProcedure(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
+static uint32_t BenchmarkActorNumFromCommandLine();
 
 void DebugOutputFormatString(const char* format, ...)
 {
@@ -88,7 +91,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 #ifdef _DEBUG
     GraphicEngine::EnableDebugLayer();
 #endif
-    if (!GraphicEngine::Initialize(hwnd)) {
+    if (!GraphicEngine::Initialize(hwnd, BenchmarkActorNumFromCommandLine())) {
         return 1;
     }
     GraphicEngine::Instance().SetViewPort();
@@ -129,3 +132,15 @@ static LRESULT WindowProcedure(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam
     return DefWindowProc(hwnd, msg, wparam, lparam);
 }
 
+// @brief R}hC "--benchmark <AN^[>" ǂ
+// @retval AN^[iw肪 0j
+static uint32_t BenchmarkActorNumFromCommandLine()
+{
+    // main  WinMain ̂ǂłg悤ACRT R}hCg
+    for (int i = 1; i + 1 < __argc; ++i) {
+        if (std::strcmp(__argv[i], "--benchmark") == 0) {
+            return static_cast<uint32_t>(std::strtoul(__argv[i + 1], nullptr, 10));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "TestFramework.hpp"
+#include "BezierEasing.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // {x̓񕪖@ x(t) = x ċ߂ yirp̊lj
+    double ReferenceY(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, double x)
+    {
+        const double px1 = x1 / 127.0, py1 = y1 / 127.0;
+        const double px2 = x2 / 127.0, py2 = y2 / 127.0;
+        const double cx = 3.0 * px1;
+        const double bx = 3.0 * (px2 - px1) - cx;
+        const double ax = 1.0 - cx - bx;
+        const double cy = 3.0 * py1;
+        const double by = 3.0 * (py2 - py1) - cy;
+        const double ay = 1.0 - cy - by;
+
+        double lo = 0.0;
+        double hi = 1.0;
+        for (int i = 0; i < 100; ++i) {
+            const double t = (lo + hi) * 0.5;
+            if (((ax * t + bx) * t + cx) * t < x) {
+                lo = t;
+            }
+            else {
+                hi = t;
+            }
+        }
+        const double t = (lo + hi) * 0.5;
+        return ((ay * t + by) * t + cy) * t;
+    }
+
+    // BezierEasingTable ̃Rgɏ덷̏
+    constexpr double k_Tolerance = 2e-5;
+
+    // [̋߂ix(t) ̌Xق 0 ɂȂ₷j𑽂߂Ɋ܂߂]ʒu
+    constexpr float k_Xs[] = {
+        0.0001f, 0.001f, 0.003f, 0.01f, 0.05f, 0.1f, 0.25f, 0.5f, 0.75f, 0.9f, 0.95f, 0.99f, 0.997f, 0.999f, 0.9999f
+    };
+}
+
+TEST(BezierEasing_MatchesBisectionOverControlPointGrid)
+{
+    constexpr uint32_t k_Step = 21;     // 0, 21, ..., 126  7 iK
+    double max_error = 0.0;
+    for (uint32_t x1 = 0; x1 < 128; x1 += k_Step) {
+        for (uint32_t y1 = 0; y1 < 128; y1 += k_Step) {
+            for (uint32_t x2 = 0; x2 < 128; x2 += k_Step) {
+                for (uint32_t y2 = 0; y2 < 128; y2 += k_Step) {
+                    BezierEasingTable table;
+                    const uint32_t curve = table.Register(x1, y1, x2, y2);
+                    const uint32_t curves[BezierEasingTable::k_ChannelNum] = { curve, curve, curve, curve };
+                    for (float x : k_Xs) {
+                        const double expected = ReferenceY(x1, y1, x2, y2, x);
+                        const double error = std::fabs(table.Evaluate(curve, x) - expected);
+                        const double error4 = std::fabs(DirectX::XMVectorGetW(table.Evaluate4(curves, x)) - expected);
+                        max_error = std::max(max_error, std::max(error, error4));
+                    }
+                }
+            }
+        }
+    }
+    CHECK(max_error <= k_Tolerance);
+}
+
+TEST(BezierEasing_ConvergesWhereSlopeIsFlat)
+{
+    // x1 = 0  t = 0 t߂ x(t) قڕɂȂAԓ̐`Ԃ̏l傫Ȑ
+    BezierEasingTable table;
+    const uint32_t curve = table.Register(0, 112, 124, 24);
+    CHECK_NEAR(table.Evaluate(curve, 0.001f), ReferenceY(0, 112, 124, 24, 0.001), 1e-6);
+
+    const uint32_t curves[BezierEasingTable::k_ChannelNum] = { BezierEasingTable::k_LinearCurve, curve, curve, BezierEasingTable::k_LinearCurve };
+    const DirectX::XMVECTOR y = table.Evaluate4(curves, 0.001f);
+    CHECK_NEAR(DirectX::XMVectorGetY(y), ReferenceY(0, 112, 124, 24, 0.001), 1e-6);
+    CHECK_NEAR(DirectX::XMVectorGetX(y), 0.001, 1e-6);
+}
+
+TEST(BezierEasing_EndpointsAreExact)
+{
+    BezierEasingTable table;
+    const uint32_t curve = table.Register(127, 0, 0, 127);
+    CHECK(table.Evaluate(curve, 0.0f) == 0.0f);
+    CHECK(table.Evaluate(curve, 1.0f) == 1.0f);
+}
+
+TEST(BezierEasing_SharesIdenticalCurves)
+{
+    BezierEasingTable table;
+    const uint32_t a = table.Register(10, 20, 30, 40);
+    const uint32_t b = table.Register(10, 20, 30, 40);
+    CHECK(a == b);
+    CHECK(table.Register(64, 64, 100, 100) == BezierEasingTable::k_LinearCurve);
+}
@@ -0,0 +1,115 @@
+#include "TestFramework.hpp"
+#include "TestModel.hpp"
+#include "IKSolver.hpp"
+#include "PoseBlend.hpp"
+#include "SkeletonPose.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    // iЂt2{[{ܐjƁAƊ֌WȂ4{[ CCD `F[f
+    //  0 Z^[
+    //  1  - 2 Ђ - 3  - 4 ܐ   5 IK - 6 ܐIK
+    //  7 - 8 - 9 - 10 CCD `F[         11 CCD ^[Qbg
+    std::filesystem::path WriteIKRigPMD()
+    {
+        TestModel model = CreateGridModel(2);
+        model.Bones.push_back(MakeTestBone("leg", 0, 0.0f, 10.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("Ђ", 1, 0.0f, 5.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("ankle", 2, 0.0f, 0.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("toe", 3, 0.0f, 0.0f, -1.0f));
+        model.Bones.push_back(MakeTestBone("legIK", 0, 0.0f, 0.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("toeIK", 5, 0.0f, 0.0f, -1.0f));
+        model.Bones.push_back(MakeTestBone("chain0", 0xFFFF, 10.0f, 0.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("chain1", 7, 11.0f, 0.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("chain2", 8, 12.0f, 0.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("chain3", 9, 13.0f, 0.0f, 0.0f));
+        model.Bones.push_back(MakeTestBone("chainIK", 0xFFFF, 13.0f, 0.0f, 0.0f));
+
+        model.IKs.push_back(PMDIK{ 5, 3, 40, 0.5f, { 2, 1 } });
+        model.IKs.push_back(PMDIK{ 6, 4, 40, 0.5f, { 3 } });
+        model.IKs.push_back(PMDIK{ 11, 10, 50, 0.05f, { 9, 8, 7 } });
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "DX12mmdTest_ikrig.pmd";
+        WriteTestPMD(path, model);
+        return path;
+    }
+
+    // t[Ƀ^[Qbgƃ`F[̓r̉]𓮂
+    void AnimateRig(uint32_t frame_no, LocalPose* pose)
+    {
+        pose->Translations[5] = XMFLOAT3(0.0f, 2.0f - 0.01f * (frame_no % 30), -1.0f);
+        pose->Translations[11] = XMFLOAT3(-1.0f + 0.01f * (frame_no % 50), 1.5f, 0.5f);
+        XMStoreFloat4(&pose->Rotations[8], XMQuaternionRotationAxis(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), 0.01f * frame_no));
+    }
+}
+
+TEST(IKSolver_GroupsIndependentChainsIntoWaves)
+{
+    PMDData pmd;
+    CHECK(pmd.Open(WriteIKRigPMD(), false, false));
+
+    IKSolver solver;
+    solver.Bind(pmd);
+    CHECK(solver.IKNum() == 3);
+    // ܐIK͑IKǂނ̂Ō̒iACCD `F[͑IKƓi
+    CHECK(solver.WaveNum() == 2);
+}
+
+TEST(IKSolver_ParallelWavesMatchSerialSolve)
+{
+    PMDData pmd;
+    CHECK(pmd.Open(WriteIKRigPMD(), false, false));
+    const uint32_t bone_num = pmd.BoneNum();
+
+    ThreadPool pool(3);
+    IKSolver parallel_solver;
+    parallel_solver.Bind(pmd);
+    parallel_solver.SetThreadPool(&pool);
+    IKSolver serial_solver;
+    serial_solver.Bind(pmd);
+
+    SkeletonPose parallel_pose;
+    parallel_pose.Bind(pmd.GetSkeleton());
+    SkeletonPose serial_pose;
+    serial_pose.Bind(pmd.GetSkeleton());
+
+    const IKEnableTimeline::Word all = ~IKEnableTimeline::Word(0);
+    parallel_solver.SetEnabled(&all);
+    serial_solver.SetEnabled(&all);
+
+    LocalPose local;
+    local.Resize(bone_num);
+    local.Reset();
+
+    std::vector<XMMATRIX> parallel_matrices(bone_num, XMMatrixIdentity());
+    std::vector<XMMATRIX> serial_matrices(bone_num, XMMatrixIdentity());
+    uint32_t mismatch_num = 0;
+    for (uint32_t frame_no = 0; frame_no < 200; ++frame_no) {
+        AnimateRig(frame_no, &local);
+
+        parallel_pose.SetSource(local);
+        parallel_pose.UpdateWorld();
+        parallel_solver.Solve(&parallel_pose);
+        parallel_pose.WriteMatrices(parallel_matrices.data(), bone_num);
+
+        serial_pose.SetSource(local);
+        serial_pose.UpdateWorld();
+        serial_solver.Solve(&serial_pose);
+        serial_pose.WriteMatrices(serial_matrices.data(), bone_num);
+
+        // ĩWu݂͌Ɋ֌WȂ̂ŁAԂςĂʂ̓rbgPʂœɂȂ
+        if (std::memcmp(parallel_matrices.data(), serial_matrices.data(), sizeof(XMMATRIX) * bone_num) != 0) {
+            ++mismatch_num;
+        }
+    }
+    CHECK(mismatch_num == 0);
+
+    // ۂɉĂ邱Ɓi񂪑IKɓ͂j
+    CHECK(parallel_solver.GetStats()[0].Solved);
+    CHECK(parallel_solver.GetStats()[0].Error < 0.01f);
+}
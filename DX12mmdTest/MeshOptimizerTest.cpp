@@ -0,0 +1,34 @@
+#include "TestFramework.hpp"
+#include "TestModel.hpp"
+
+namespace
+{
+    const std::filesystem::path k_TestDir = std::filesystem::temp_directory_path() / "DX12mmdTest_meshoptimizer";
+}
+
+TEST(MeshOptimizer_DoesNotWorsenACMR)
+{
+    std::filesystem::create_directories(k_TestDir);
+    const std::filesystem::path pmd_path = k_TestDir / "grid.pmd";
+    CHECK(WriteTestPMD(pmd_path, CreateGridModel(12)));
+
+    PMDData pmd;
+    CHECK(pmd.Open(pmd_path, false, true));
+    const MeshOptimizeStats& stats = pmd.GetMeshOptimizeStats();
+    CHECK(stats.AcmrBefore > 0.0f);
+    CHECK(stats.AcmrAfter > 0.0f);
+    CHECK(stats.AcmrAfter <= stats.AcmrBefore);
+
+    // בւ̃CfbNX瑪蒼ĂlɂȂ
+    CHECK_NEAR(MeshOptimizer::CalcACMR(
+        reinterpret_cast<const uint16_t*>(pmd.GetIndexData()), pmd.IndexNum(), pmd.VertexNum()
+    ), stats.AcmrAfter, 1.0e-6f);
+
+    // בւȂ 0 ̂܂
+    PMDData raw;
+    CHECK(raw.Open(pmd_path, false, false));
+    CHECK(raw.GetMeshOptimizeStats().AcmrBefore == 0.0f);
+
+    std::error_code ec;
+    std::filesystem::remove_all(k_TestDir, ec);
+}
@@ -0,0 +1,149 @@
+#include "TestFramework.hpp"
+#include "TestModel.hpp"
+#include "PMDCache.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    // LOD x̎Op`ɂĂ
+    constexpr uint16_t k_GridNum = 12;
+
+    std::filesystem::path WriteGridPMD(const std::filesystem::path& dir)
+    {
+        std::filesystem::create_directories(dir);
+        const std::filesystem::path path = dir / "grid.pmd";
+        WriteTestPMD(path, CreateGridModel(k_GridNum));
+        return path;
+    }
+
+    PMDCacheHeader ReadCacheHeader(const std::filesystem::path& cache_path)
+    {
+        PMDCacheHeader header{};
+        std::ifstream ifs(cache_path, std::ios::in | std::ios::binary);
+        ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        return header;
+    }
+
+    // LbV̎wʒu uint32_t  add 𑫂ď߂iLbVꂽꍇj
+    void AddToCacheValue(const std::filesystem::path& cache_path, uint64_t offset, uint32_t add)
+    {
+        std::fstream fs(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t value = 0;
+        fs.seekg(offset);
+        fs.read(reinterpret_cast<char*>(&value), sizeof(value));
+        value += add;
+        fs.seekp(offset);
+        fs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // PMD ǂݍŃLbV蒼
+    bool RebuildCache(const std::filesystem::path& pmd_path)
+    {
+        std::error_code ec;
+        std::filesystem::remove(PMDCache::CachePath(pmd_path), ec);
+        PMDData pmd;
+        return pmd.Open(pmd_path, true, false) && std::filesystem::exists(PMDCache::CachePath(pmd_path));
+    }
+
+    const std::filesystem::path k_TestDir = std::filesystem::temp_directory_path() / "DX12mmdTest_pmdcache";
+
+    // eXg̏IɍƃtH_
+    // iǂݍ񂾃fLbV}bv܂܂ƏȂ̂ŁAeXg̍ŏɒučŌɔjj
+    struct TestDirGuard
+    {
+        ~TestDirGuard()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(k_TestDir, ec);
+        }
+    };
+}
+
+TEST(PMDCache_RoundTripsModel)
+{
+    TestDirGuard guard;
+    const std::filesystem::path pmd_path = WriteGridPMD(k_TestDir);
+    CHECK(RebuildCache(pmd_path));
+
+    PMDData source;
+    CHECK(source.Open(pmd_path, false, false));
+    PMDData cached;
+    CHECK(PMDCache::Load(PMDCache::CachePath(pmd_path), pmd_path, false, &cached));
+
+    CHECK(cached.VertexNum() == source.VertexNum());
+    CHECK(cached.IndexNum() == source.IndexNum());
+    CHECK(std::memcmp(cached.GetIndexData(), source.GetIndexData(), source.IndexBuffSize()) == 0);
+    CHECK(cached.MaterialNum() == source.MaterialNum());
+    CHECK(cached.LodNum() == source.LodNum());
+    CHECK(source.LodNum() > 0);
+    CHECK(cached.GetTexturePaths()[0].TexPath == source.GetTexturePaths()[0].TexPath);
+    CHECK(cached.GetTexturePaths()[1].TexPath.empty());
+
+    // œK̗LႤLbV͎gȂ
+    PMDData optimized;
+    CHECK(!PMDCache::Load(PMDCache::CachePath(pmd_path), pmd_path, true, &optimized));
+}
+
+TEST(PMDCache_RefreshesStampWhenOnlyWriteTimeChanged)
+{
+    TestDirGuard guard;
+    const std::filesystem::path pmd_path = WriteGridPMD(k_TestDir);
+    const std::filesystem::path cache_path = PMDCache::CachePath(pmd_path);
+    CHECK(RebuildCache(pmd_path));
+
+    // g͂̂܂܂ōXVi߂
+    std::filesystem::last_write_time(pmd_path, std::filesystem::last_write_time(pmd_path) + std::chrono::hours(1));
+    uint64_t size = 0;
+    int64_t write_time = 0;
+    CHECK(GetFileStamp(pmd_path, &size, &write_time));
+    CHECK(ReadCacheHeader(cache_path).SourceWriteTime != write_time);
+
+    // nbVv̂ŎgA񂩂nbVvZȂčςނ悤
+    PMDData pmd;
+    CHECK(PMDCache::Load(cache_path, pmd_path, false, &pmd));
+    CHECK(ReadCacheHeader(cache_path).SourceWriteTime == write_time);
+}
+
+TEST(PMDCache_RejectsChangedSource)
+{
+    TestDirGuard guard;
+    const std::filesystem::path pmd_path = WriteGridPMD(k_TestDir);
+    const std::filesystem::path cache_path = PMDCache::CachePath(pmd_path);
+    CHECK(RebuildCache(pmd_path));
+
+    // TCY͓܂ܒgif̃RgjςAXVς
+    {
+        std::fstream fs(pmd_path, std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(3 + offsetof(PMDHeader, Comment));
+        fs.write("changed", 7);
+    }
+    std::filesystem::last_write_time(pmd_path, std::filesystem::last_write_time(pmd_path) + std::chrono::hours(2));
+
+    PMDData pmd;
+    CHECK(!PMDCache::Load(cache_path, pmd_path, false, &pmd));
+}
+
+TEST(PMDCache_RejectsMaterialIndexCountMismatch)
+{
+    TestDirGuard guard;
+    const std::filesystem::path pmd_path = WriteGridPMD(k_TestDir);
+    const std::filesystem::path cache_path = PMDCache::CachePath(pmd_path);
+
+    // }eÃCfbNX̍v IndexNum ƍȂ
+    CHECK(RebuildCache(pmd_path));
+    const PMDCacheHeader header = ReadCacheHeader(cache_path);
+    AddToCacheValue(cache_path, header.Sections[PMDCacheHeader::k_RawMaterials].Offset + offsetof(PMDMaterial, IndicesNum), 3);
+    PMDData pmd;
+    CHECK(!PMDCache::Load(cache_path, pmd_path, false, &pmd));
+
+    // LOD ̃}eÃCfbNX̍v LOD ̃CfbNXƍȂ
+    CHECK(RebuildCache(pmd_path));
+    const PMDCacheHeader lod_header = ReadCacheHeader(cache_path);
+    CHECK(lod_header.LodNum > 0);
+    AddToCacheValue(cache_path, lod_header.Sections[PMDCacheHeader::k_LodMaterialIndexNums].Offset, 3);
+    PMDData lod_pmd;
+    CHECK(!PMDCache::Load(cache_path, pmd_path, false, &lod_pmd));
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// DX12mmd  CPU ̏m߂邽߂̍ŏ̃eXg̎dg
+//
+// TEST(O) Œ`֐͋Nɓo^ATestMain ܂Ƃ߂ĎsB
+// CHECK ñ}N͎sĂ֐𔲂Asꏊo͂đB
+class TestRegistry
+{
+public:
+
+    using TestFunc = void (*)();
+
+    static TestRegistry& Instance()
+    {
+        static TestRegistry registry;
+        return registry;
+    }
+
+    void Add(const char* name, TestFunc func)
+    {
+        m_Tests.push_back(TestEntry{ name, func });
+    }
+
+    void Fail(const char* file, int line, const char* expr)
+    {
+        std::printf("  %s(%d): %s\n", file, line, expr);
+        ++m_FailNum;
+    }
+
+    // @brief o^eXgSĎs
+    // @retval seXg̐
+    int RunAll()
+    {
+        int failed_test_num = 0;
+        for (const auto& test : m_Tests) {
+            const int fail_num = m_FailNum;
+            test.Func();
+            const bool passed = fail_num == m_FailNum;
+            std::printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", test.Name);
+            if (!passed) {
+                ++failed_test_num;
+            }
+        }
+        std::printf("%d / %d tests passed\n", static_cast<int>(m_Tests.size()) - failed_test_num, static_cast<int>(m_Tests.size()));
+        return failed_test_num;
+    }
+
+private:
+
+    struct TestEntry
+    {
+        const char* Name;
+        TestFunc    Func;
+    };
+
+    TestRegistry() : m_Tests(), m_FailNum(0) {}
+
+    std::vector<TestEntry> m_Tests;
+    int                    m_FailNum;
+};
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, TestRegistry::TestFunc func)
+    {
+        TestRegistry::Instance().Add(name, func);
+    }
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistrar name##_registrar(#name, name); \
+    static void name()
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            TestRegistry::Instance().Fail(__FILE__, __LINE__, #expr); \
+        } \
+    } while (false)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        if (!(std::fabs(static_cast<double>(actual) - static_cast<double>(expected)) <= (tolerance))) { \
+            TestRegistry::Instance().Fail(__FILE__, __LINE__, #actual " == " #expected " +- " #tolerance); \
+        } \
+    } while (false)
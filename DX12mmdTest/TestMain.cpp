@@ -0,0 +1,7 @@
+#include "TestFramework.hpp"
+
+int main()
+{
+    // seXg 0 ȊOŏIirhCxg CI 猋ʂ𔻒ł悤Ɂj
+    return TestRegistry::Instance().RunAll() == 0 ? 0 : 1;
+}
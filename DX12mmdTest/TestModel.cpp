@@ -0,0 +1,101 @@
+#include "TestModel.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    template <typename T>
+    void WriteValue(std::ofstream& ofs, const T& value)
+    {
+        ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+}
+
+PMDBone MakeTestBone(const char* name, uint16_t parent, float x, float y, float z)
+{
+    PMDBone bone{};
+    std::strncpy(bone.BoneName, name, sizeof(bone.BoneName));
+    bone.ParentBoneNo = parent;
+    bone.Pos = DirectX::XMFLOAT3(x, y, z);
+    return bone;
+}
+
+TestModel CreateGridModel(uint16_t grid_num)
+{
+    TestModel model;
+    for (uint16_t y = 0; y <= grid_num; ++y) {
+        for (uint16_t x = 0; x <= grid_num; ++x) {
+            PMDVertex vertex{};
+            vertex.Pos = DirectX::XMFLOAT3(static_cast<float>(x), static_cast<float>(y), 0.0f);
+            vertex.Normal = DirectX::XMFLOAT3(0.0f, 0.0f, -1.0f);
+            vertex.UV = DirectX::XMFLOAT2(static_cast<float>(x) / grid_num, static_cast<float>(y) / grid_num);
+            vertex.BoneWeight = 100;
+            model.Vertices.push_back(vertex);
+        }
+    }
+
+    const uint16_t row = grid_num + 1;
+    for (uint16_t y = 0; y < grid_num; ++y) {
+        for (uint16_t x = 0; x < grid_num; ++x) {
+            const uint16_t v = y * row + x;
+            const uint16_t quad[6] = { v, uint16_t(v + 1), uint16_t(v + row), uint16_t(v + 1), uint16_t(v + row + 1), uint16_t(v + row) };
+            model.Indices.insert(model.Indices.end(), quad, quad + 6);
+        }
+    }
+
+    // 㔼Ɖŕʂ̃}eAɂ
+    for (uint32_t i = 0; i < 2; ++i) {
+        PMDMaterial material{};
+        material.Diffuse = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+        material.Alpha = 1.0f;
+        material.IndicesNum = static_cast<unsigned int>(model.Indices.size() / 2);
+        std::strcpy(material.TexFilePath, i == 0 ? "tex.png" : "");
+        model.Materials.push_back(material);
+    }
+
+    model.Bones.push_back(MakeTestBone("center", 0xFFFF, 0.0f, 0.0f, 0.0f));
+    return model;
+}
+
+bool WriteTestPMD(const std::filesystem::path& path, const TestModel& model)
+{
+    std::ofstream ofs(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        return false;
+    }
+
+    ofs.write("Pmd", 3);
+    PMDHeader header{};
+    header.Version = 1.0f;
+    std::strcpy(header.ModelName, "test");
+    WriteValue(ofs, header);
+
+    // t@C̒_͖̋lߕ 38byte
+    WriteValue(ofs, static_cast<uint32_t>(model.Vertices.size()));
+    for (const auto& vertex : model.Vertices) {
+        ofs.write(reinterpret_cast<const char*>(&vertex), PMDVertex::k_PMDVertexSize);
+    }
+
+    WriteValue(ofs, static_cast<uint32_t>(model.Indices.size()));
+    ofs.write(reinterpret_cast<const char*>(model.Indices.data()), model.Indices.size() * sizeof(uint16_t));
+
+    WriteValue(ofs, static_cast<uint32_t>(model.Materials.size()));
+    ofs.write(reinterpret_cast<const char*>(model.Materials.data()), model.Materials.size() * sizeof(PMDMaterial));
+
+    WriteValue(ofs, static_cast<uint16_t>(model.Bones.size()));
+    ofs.write(reinterpret_cast<const char*>(model.Bones.data()), model.Bones.size() * sizeof(PMDBone));
+
+    WriteValue(ofs, static_cast<uint16_t>(model.IKs.size()));
+    for (const auto& ik : model.IKs) {
+        WriteValue(ofs, ik.BoneIdx);
+        WriteValue(ofs, ik.TargetIdx);
+        WriteValue(ofs, static_cast<uint8_t>(ik.NodeIdxes.size()));
+        WriteValue(ofs, ik.Iterations);
+        WriteValue(ofs, ik.Limit);
+        ofs.write(reinterpret_cast<const char*>(ik.NodeIdxes.data()), ik.NodeIdxes.size() * sizeof(uint16_t));
+    }
+
+    WriteValue(ofs, uint16_t(0));   // XL
+    return static_cast<bool>(ofs);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "PMD.hpp"
+
+// eXgpɑgݗĂPMDfiXL͎Ȃj
+struct TestModel
+{
+    std::vector<PMDVertex>   Vertices;
+    std::vector<uint16_t>    Indices;
+    std::vector<PMDMaterial> Materials;
+    std::vector<PMDBone>     Bones;
+    std::vector<PMDIK>       IKs;
+};
+
+// @brief {[
+// @param parent e{[ԍi PMDBone  0xFFFFj
+PMDBone MakeTestBone(const char* name, uint16_t parent, float x, float y, float z);
+
+// @brief iq̕ʁigrid_num x grid_num ̎lp`j2̃}eAɕf
+//        ŏ̃}eAeNX` "tex.png" 
+TestModel CreateGridModel(uint16_t grid_num);
+
+// @brief PMDt@CƂďo
+bool WriteTestPMD(const std::filesystem::path& path, const TestModel& model);
@@ -0,0 +1,86 @@
+#include "TestFramework.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace
+{
+    // ԍ̎s
+    struct RunCounter
+    {
+        explicit RunCounter(uint32_t num) : Counts(num) {}
+
+        bool AllRunOnce() const
+        {
+            for (const auto& count : Counts) {
+                if (count.load() != 1) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::vector<std::atomic<uint32_t>> Counts;
+    };
+}
+
+TEST(ThreadPool_ParallelForRunsEachIndexOnce)
+{
+    ThreadPool pool(3);
+    for (uint32_t num : { 0u, 1u, 2u, 3u, 4u, 17u, 1000u }) {
+        RunCounter counter(num);
+        pool.ParallelFor(num, [&counter](uint32_t i) { counter.Counts[i].fetch_add(1); });
+        CHECK(counter.AllRunOnce());
+    }
+}
+
+TEST(ThreadPool_NestedParallelForCompletes)
+{
+    // [J[葽Õ^XNꂼ ParallelFor ĂłAĂяoXbhŝŎ~܂Ȃ
+    constexpr uint32_t k_OuterNum = 8;
+    constexpr uint32_t k_InnerNum = 64;
+    ThreadPool pool(2);
+    RunCounter counter(k_OuterNum * k_InnerNum);
+    pool.ParallelFor(k_OuterNum, [&pool, &counter](uint32_t outer) {
+        pool.ParallelFor(k_InnerNum, [&counter, outer](uint32_t inner) {
+            counter.Counts[outer * k_InnerNum + inner].fetch_add(1);
+        });
+    });
+    CHECK(counter.AllRunOnce());
+}
+
+TEST(ThreadPool_ParallelForCompletesWhileWorkersAreBusy)
+{
+    // [J[S̃^XNŎ~܂ĂĂAĂяoXbhŏI
+    ThreadPool pool(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<std::future<void>> blockers;
+    for (uint32_t i = 0; i < pool.ThreadNum(); ++i) {
+        blockers.push_back(pool.Submit([released]() { released.wait(); }));
+    }
+
+    RunCounter counter(100);
+    pool.ParallelFor(100, [&counter](uint32_t i) { counter.Counts[i].fetch_add(1); });
+    CHECK(counter.AllRunOnce());
+
+    release.set_value();
+    for (auto& blocker : blockers) {
+        blocker.wait();
+    }
+}
+
+TEST(ThreadPool_SubmitReturnsResults)
+{
+    ThreadPool pool(3);
+    std::vector<std::future<uint32_t>> results;
+    for (uint32_t i = 0; i < 100; ++i) {
+        results.push_back(pool.Submit([i]() { return i * i; }));
+    }
+    bool all_match = true;
+    for (uint32_t i = 0; i < 100; ++i) {
+        all_match &= (results[i].get() == i * i);
+    }
+    CHECK(all_match);
+}
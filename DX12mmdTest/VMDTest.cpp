@@ -0,0 +1,86 @@
+#include "TestFramework.hpp"
+#include "VMD.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    struct IKSwitchRecord
+    {
+        uint32_t    FrameNo;
+        std::string BoneName;
+        bool        Enable;
+    };
+
+    template <typename T>
+    void WriteValue(std::ofstream& ofs, const T& value)
+    {
+        ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // {[[VE\EJEƖEZtVhEŁAIK؂ւf[^VMDo
+    std::filesystem::path WriteIKSwitchVMD(const char* name, const std::vector<IKSwitchRecord>& records)
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::ofstream ofs(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        char header[k_VMDHeaderSize]{};
+        std::strcpy(header, "Vocaloid Motion Data 0002");
+        ofs.write(header, sizeof(header));
+        for (int i = 0; i < 5; ++i) {
+            WriteValue(ofs, uint32_t(0));   // {[[VE\EJEƖEZtVhE̐
+        }
+
+        WriteValue(ofs, static_cast<uint32_t>(records.size()));
+        for (const auto& record : records) {
+            WriteValue(ofs, record.FrameNo);
+            WriteValue(ofs, uint8_t(1));    // \
+            WriteValue(ofs, uint32_t(1));   // IK
+            char bone_name[20]{};
+            std::strncpy(bone_name, record.BoneName.c_str(), sizeof(bone_name) - 1);
+            ofs.write(bone_name, sizeof(bone_name));
+            WriteValue(ofs, uint8_t(record.Enable ? 1 : 0));
+        }
+        return path;
+    }
+}
+
+TEST(VMD_IKSwitchesOnTheSameFrameKeepFileOrder)
+{
+    // \[gŕבւNx̌At[̍~Et[𕡐ׂ
+    // {[Ƀt@C̏ԂĂAt[̒ł̏ԂۂĂ邩
+    std::vector<IKSwitchRecord> records;
+    for (uint32_t i = 0; i < 64; ++i) {
+        records.push_back(IKSwitchRecord{ (63 - i) / 4 * 10, "IK" + std::to_string(i), (i % 2) == 0 });
+    }
+    const std::filesystem::path path = WriteIKSwitchVMD("DX12mmdTest_ik_switch.vmd", records);
+
+    VMDMotionTable table;
+    CHECK(table.Open(path));
+    const auto& list = table.GetIKSwitchList();
+    CHECK(list.size() == records.size());
+
+    auto order = [](const VMDIKEnable& ike) {
+        return std::stoi(ike.IkEnableTable.begin()->first.substr(2));
+    };
+    for (size_t i = 1; i < list.size(); ++i) {
+        CHECK(list[i - 1].FrameNo <= list[i].FrameNo);
+        if (list[i - 1].FrameNo == list[i].FrameNo) {
+            CHECK(order(list[i - 1]) < order(list[i]));
+        }
+    }
+
+    // t[ɕꍇ́At@CŌ̐؂ւf[^g
+    const VMDIKEnable* ike = table.GetIKEnable(10);
+    CHECK(ike != nullptr);
+    if (ike) {
+        CHECK(ike->FrameNo == 10);
+        CHECK(order(*ike) == 59);
+    }
+    CHECK(table.GetIKEnable(0) != nullptr);
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}